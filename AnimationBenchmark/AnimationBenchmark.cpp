@@ -0,0 +1,544 @@
+/*
+    AnimationBenchmark.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    Dependencies :
+        GraphicsDemo - animation core( Animation, Animator, Skeleton, PoseBlend, JobSystem ) built with GD_HEADLESS
+
+    Headless micro benchmark of the animation system on synthetic rigs.
+     - Generates skeletons of random bone trees and clips of smooth random motion, so runs don't need FBX files.
+     - Measures each stage of Animator::Update() alone in ns/bone:
+        sample      - Animation::FindKeyFrames + 2 x Animation::DecodePose
+        interpolate - PoseBlend::InterpolateToMatrices
+        blend       - PoseBlend::Blend of two poses, as a crossfade layer of BlendTree
+        propagate   - Skeleton::ComputeGlobalTransforms
+        palette     - Skeleton::ComputePalette
+     - Measures whole Animator::Update() of many instances spread over JobSystem threads in ns/bone.
+     - Writes results as JSON, to stdout or to --out file.
+     - Checks AngleBetween() on rotations of known angles first, and fails with exit code 1 if it measures them wrong.
+       Clips are checked the same way: every keyframe of a compressed clip must be within the error bounds of the raw clip.
+     - --keep-redundant-keys compresses clips without key reduction, to compare key counts and sampling cost against it.
+
+    usage:
+        AnimationBenchmark [--bones 30,60,120,250] [--lengths 1,10,60] [--instances 1,10,100,1000,10000]
+                           [--threads 1,2,4] [--scale-bones 60] [--scale-length 10] [--keep-redundant-keys] [--quick]
+                           [--out result.json]
+*/
+#include "Common.h"
+#include "Animation.h"
+#include "Animator.h"
+#include "AnimationLod.h"
+#include "JobSystem.h"
+#include "KeyFrame.h"
+#include "Pose.h"
+#include "PoseBlend.h"
+#include "Quantization.h"
+#include "Skeleton.h"
+
+#include <random>
+
+namespace
+{
+    // Version of JSON layout. Increase when fields change meaning.
+    const int SchemaVersion = 1;
+
+    // Frames per second of synthetic clips, as clips exported from Mixamo
+    const float ClipFrameRate = 30.0f;
+
+    // Frame time Animator::Update() is called with
+    const float FrameTime = 1.0f / 60.0f;
+
+    // Animators per JobSystem range, as Scene::Update()
+    const int InstancesPerJob = 8;
+
+    // Keeps optimizer from dropping benchmark loops.
+    volatile float s_sink;
+
+    struct Options
+    {
+        std::vector<int> boneCounts = { 30, 60, 120, 250 };
+        std::vector<float> clipLengths = { 1.0f, 10.0f, 60.0f };
+        std::vector<int> instanceCounts = { 1, 10, 100, 1000, 10000 };
+        std::vector<int> threadCounts;
+        // Rig the instance/thread sweep runs on. 10000 instances of the largest rig would take gigabytes.
+        int scaleBoneCount = 60;
+        float scaleClipLength = 10.0f;
+        bool removeRedundantKeys = true;
+        // Minimum time each measurement runs
+        double minimumSeconds = 0.2;
+        std::string outFilename;
+    };
+
+    struct Result
+    {
+        std::string stage;
+        int boneCount;
+        float clipLength;
+        int instanceCount;
+        int threadCount;
+        long long iterations;
+        double nsPerBone;
+    };
+
+    typedef std::chrono::high_resolution_clock BenchmarkClock;
+
+    double ToNanoseconds(BenchmarkClock::duration duration)
+    {
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+    }
+
+    // Runs 'function(iterations)' with doubling iteration count until a run takes at least 'minimumSeconds'.
+    // Returns nanoseconds per iteration of the last run.
+    double Measure(const std::function<void(long long)>& function, double minimumSeconds, long long& iterations)
+    {
+        iterations = 1;
+        for (;;)
+        {
+            const auto Begin = BenchmarkClock::now();
+            function(iterations);
+            const double Nanoseconds = ToNanoseconds(BenchmarkClock::now() - Begin);
+            if (Nanoseconds >= minimumSeconds * 1e9 || iterations >= (1ll << 40))
+                return Nanoseconds / iterations;
+            iterations *= 2;
+        }
+    }
+
+    // Rotations of known angles must measure as those angles; compression error bounds are checked with AngleBetween().
+    bool CheckAngleBetween()
+    {
+        const glm::vec3 Axis = glm::normalize(glm::vec3(0.3f, -0.5f, 0.8f));
+        const glm::quat From = glm::angleAxis(0.7f, glm::normalize(glm::vec3(1.0f, 2.0f, -1.0f)));
+        const float Angles[] = { 0.0f, 1e-4f, 0.001f, 0.3f, 1.5f, 3.0f };
+        for (float angle : Angles)
+        {
+            const glm::quat To = glm::angleAxis(angle, Axis) * From;
+            // Negated quaternion is the same rotation.
+            const float Measured[] = { AngleBetween(From, To), AngleBetween(From, -To) };
+            for (float measured : Measured)
+            {
+                if (std::abs(measured - angle) > 1e-3f * angle + 1e-5f)
+                {
+                    std::cerr << "AnimationBenchmark : AngleBetween of " << angle << " rad rotation is " << measured << " rad" << std::endl;
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Random bone tree. Parent of each bone is one of the few bones before it, so the tree has long limbs
+    // and branches like a character rig rather than a flat fan.
+    std::shared_ptr<Skeleton> CreateSkeleton(int boneCount, std::mt19937& random)
+    {
+        std::uniform_int_distribution<int> parentBack(1, 6);
+        std::uniform_real_distribution<float> offset(-0.2f, 0.2f);
+        std::uniform_real_distribution<float> angle(-0.5f, 0.5f);
+
+        std::shared_ptr<Skeleton> pSkeleton(new Skeleton);
+        std::vector<glm::mat4> globalTransforms(boneCount);
+        for (int i = 0; i < boneCount; ++i)
+        {
+            const int ParentIndex = i == 0 ? Skeleton::DUMMY_PARENT_NODE_INDEX : std::max(0, i - parentBack(random));
+            const glm::mat4 Local = glm::translate(glm::vec3(offset(random), 0.1f + std::abs(offset(random)), offset(random)))
+                * glm::toMat4(glm::quat(glm::vec3(angle(random), angle(random), angle(random))));
+            globalTransforms[i] = ParentIndex != Skeleton::DUMMY_PARENT_NODE_INDEX ? globalTransforms[ParentIndex] * Local : Local;
+
+            Bone bone;
+            bone.SetName("Bone" + std::to_string(i));
+            bone.SetParent(ParentIndex);
+            // Mesh sits at the origin; link transform is the bone in bind pose.
+            bone.SetTransform(glm::identity<glm::mat4>());
+            bone.SetLinkTransform(globalTransforms[i]);
+            pSkeleton->AddBone(bone);
+        }
+        return pSkeleton;
+    }
+
+    // Clip of 'length' seconds where every bone swings around its own axis at its own rate. Not compressed.
+    std::shared_ptr<Animation> CreateClip(const Skeleton& skeleton, float length, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> rate(0.2f, 2.0f);
+
+        const int BoneCount = skeleton.GetBoneCount();
+        std::vector<glm::vec3> axes(BoneCount);
+        std::vector<float> rates(BoneCount);
+        std::vector<float> phases(BoneCount);
+        for (int i = 0; i < BoneCount; ++i)
+        {
+            axes[i] = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.0f, 0.0f, 1e-3f));
+            rates[i] = rate(random);
+            phases[i] = unit(random) * glm::pi<float>();
+        }
+
+        std::shared_ptr<Animation> pAnimation(new Animation("Synthetic" + std::to_string(BoneCount) + "_" + std::to_string(length)));
+        const int FrameCount = static_cast<int>(length * ClipFrameRate) + 1;
+        for (int k = 0; k < FrameCount; ++k)
+        {
+            const float Time = k / ClipFrameRate;
+            KeyFrame keyFrame;
+            keyFrame.GetPose().Resize(BoneCount);
+            keyFrame.SetTimestamp(Time);
+            for (int i = 0; i < BoneCount; ++i)
+            {
+                const Bone& bone = skeleton.GetBoneByIndex(i);
+                const int ParentIndex = bone.GetParent();
+                const glm::mat4 Local = ParentIndex != Skeleton::DUMMY_PARENT_NODE_INDEX
+                    ? skeleton.GetBoneByIndex(ParentIndex).GetInvLinkTransform() * bone.GetLinkTransform()
+                    : bone.GetLinkTransform();
+                const float Swing = std::sin(Time * rates[i] * glm::two_pi<float>() + phases[i]);
+
+                BoneTransform transform;
+                transform.position = glm::vec3(Local[3]) * (1.0f + 0.05f * Swing);
+                transform.rotation = glm::quat_cast(Local) * glm::angleAxis(0.6f * Swing, axes[i]);
+                keyFrame.SetBoneTransform(i, transform);
+            }
+            pAnimation->AddKeyFrame(keyFrame);
+        }
+        pAnimation->SetLength(length);
+        pAnimation->SetBoneNames(skeleton);
+        return pAnimation;
+    }
+
+    // Copy of 'raw' compressed with default settings, as clips loaded by the app, unless options turn key reduction off.
+    // Every keyframe of the copy is checked against 'raw' to be within the error bounds; nullptr if one isn't.
+    std::shared_ptr<Animation> CompressClip(Animation& raw, const Options& options)
+    {
+        Animation::CompressionSettings settings;
+        settings.removeRedundantKeys = options.removeRedundantKeys;
+        std::shared_ptr<Animation> pAnimation(new Animation);
+        raw.CopyTo(*pAnimation);
+        pAnimation->Compress(settings);
+
+        const int BoneCount = raw.GetBoneCount();
+        Pose rawPose(BoneCount);
+        Pose pose(BoneCount);
+        float rotationError = 0.0f;
+        float translationError = 0.0f;
+        for (int k = 0; k < raw.GetKeyFrameCount(); ++k)
+        {
+            raw.DecodePose(k, rawPose);
+            pAnimation->DecodePose(k, pose);
+            for (int i = 0; i < BoneCount; ++i)
+            {
+                rotationError = std::max(rotationError, AngleBetween(rawPose.GetRotations()[i], pose.GetRotations()[i]));
+                translationError = std::max(translationError, glm::distance(rawPose.GetTranslations()[i], pose.GetTranslations()[i]));
+            }
+        }
+
+        std::cerr << "compress : " << raw.GetTrackKeyCount() << " -> " << pAnimation->GetTrackKeyCount() << " keys, max error "
+            << rotationError << " rad, " << translationError << std::endl;
+        if (rotationError > settings.maxRotationError || translationError > settings.maxTranslationError)
+        {
+            std::cerr << "AnimationBenchmark : " << raw.GetName() << " compressed beyond error bounds "
+                << settings.maxRotationError << " rad, " << settings.maxTranslationError << std::endl;
+            return nullptr;
+        }
+        return pAnimation;
+    }
+
+    // Measures stages of Animator::Update() alone, one rig and clip at a time on the calling thread.
+    void MeasureStages(const Skeleton& skeleton, const Animation& animation, const Options& options, std::vector<Result>& results)
+    {
+        const int BoneCount = skeleton.GetBoneCount();
+        Pose prev(BoneCount);
+        Pose next(BoneCount);
+        std::vector<glm::mat4> local(BoneCount);
+        std::vector<glm::mat4> global(BoneCount);
+        std::vector<glm::mat4> palette(BoneCount);
+        Pose blended(BoneCount);
+
+        // Playback position carries over between runs so sampling walks the whole clip, cursor and all.
+        float time = 0.0f;
+        int cursor = 0;
+        int prevIndex = 0;
+        int nextIndex = 0;
+        float t = 0.0f;
+        auto Sample = [&](long long iterations)
+        {
+            float sink = 0.0f;
+            for (long long n = 0; n < iterations; ++n)
+            {
+                animation.FindKeyFrames(time, prevIndex, nextIndex, t, &cursor);
+                animation.DecodePose(prevIndex, prev);
+                animation.DecodePose(nextIndex, next);
+                sink += prev.GetRotations()[n % BoneCount].w + next.GetTranslations()[n % BoneCount].x;
+                time += FrameTime;
+                if (time > animation.GetLength())
+                {
+                    time = 0.0f;
+                }
+            }
+            s_sink = sink;
+        };
+        auto Interpolate = [&](long long iterations)
+        {
+            for (long long n = 0; n < iterations; ++n)
+            {
+                PoseBlend::InterpolateToMatrices(prev, next, t, PoseBlend::RM_SLERP, local.data());
+            }
+            s_sink = local[BoneCount - 1][3][0];
+        };
+        auto BlendPoses = [&](long long iterations)
+        {
+            for (long long n = 0; n < iterations; ++n)
+            {
+                PoseBlend::Blend(prev, next, t, PoseBlend::RM_SLERP, blended);
+            }
+            s_sink = blended.GetRotations()[BoneCount - 1].w;
+        };
+        auto Propagate = [&](long long iterations)
+        {
+            for (long long n = 0; n < iterations; ++n)
+            {
+                skeleton.ComputeGlobalTransforms(local.data(), global.data());
+            }
+            s_sink = global[BoneCount - 1][3][0];
+        };
+        auto BuildPalette = [&](long long iterations)
+        {
+            for (long long n = 0; n < iterations; ++n)
+            {
+                skeleton.ComputePalette(global.data(), palette.data());
+            }
+            s_sink = palette[BoneCount - 1][3][0];
+        };
+
+        const std::pair<const char*, std::function<void(long long)>> Stages[] =
+        {
+            { "sample", Sample },
+            { "interpolate", Interpolate },
+            { "blend", BlendPoses },
+            { "propagate", Propagate },
+            { "palette", BuildPalette },
+        };
+        for (const auto& stage : Stages)
+        {
+            Result result = { stage.first, BoneCount, animation.GetLength(), 1, 1, 0, 0.0 };
+            result.nsPerBone = Measure(stage.second, options.minimumSeconds, result.iterations) / BoneCount;
+            results.push_back(result);
+        }
+    }
+
+    // Measures Animator::Update() of 'instanceCount' animators playing 'pAnimation' at staggered times,
+    // updated in parallel as Scene::Update() does.
+    void MeasureUpdate(const Skeleton& skeleton, std::shared_ptr<Animation> pAnimation, int instanceCount, int threadCount,
+        const Options& options, std::vector<Result>& results)
+    {
+        std::vector<Animator> animators(instanceCount);
+        for (int i = 0; i < instanceCount; ++i)
+        {
+            animators[i].SetCurrentAnimation(pAnimation);
+            animators[i].SetAnimationTime(pAnimation->GetLength() * i / instanceCount);
+        }
+
+        JobSystem* pJobSystem = JobSystem::Instance();
+        pJobSystem->SetWorkerCount(threadCount - 1);
+        auto UpdateAll = [&](long long frames)
+        {
+            for (long long frame = 0; frame < frames; ++frame)
+            {
+                pJobSystem->ParallelFor(instanceCount, InstancesPerJob, [&](int begin, int end)
+                {
+                    for (int i = begin; i < end; ++i)
+                    {
+                        animators[i].Update(&skeleton, FrameTime);
+                    }
+                });
+            }
+        };
+        // First update sizes buffers of every animator; it is not what is being measured.
+        UpdateAll(1);
+
+        Result result = { "update", skeleton.GetBoneCount(), pAnimation->GetLength(), instanceCount, threadCount, 0, 0.0 };
+        result.nsPerBone = Measure(UpdateAll, options.minimumSeconds, result.iterations)
+            / (static_cast<double>(instanceCount) * skeleton.GetBoneCount());
+        results.push_back(result);
+    }
+
+    template <typename T>
+    bool ParseList(const char* text, std::vector<T>& out)
+    {
+        out.clear();
+        std::istringstream iss(text);
+        std::string token;
+        while (std::getline(iss, token, ','))
+        {
+            std::istringstream tokenStream(token);
+            T value;
+            if (!(tokenStream >> value) || value <= T(0))
+                return false;
+            out.push_back(value);
+        }
+        return !out.empty();
+    }
+
+    void PrintUsage()
+    {
+        std::cerr << "usage: AnimationBenchmark [--bones 30,60,120,250] [--lengths 1,10,60] [--instances 1,10,100,1000,10000]" << std::endl
+            << "                          [--threads 1,2,4] [--scale-bones 60] [--scale-length 10] [--keep-redundant-keys] [--quick]" << std::endl
+            << "                          [--out result.json]" << std::endl;
+    }
+
+    bool ParseOptions(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string Arg = argv[i];
+            const char* pValue = i + 1 < argc ? argv[i + 1] : nullptr;
+            bool ok = true;
+            if (Arg == "--quick")
+            {
+                options.minimumSeconds = 0.02;
+                continue;
+            }
+            else if (Arg == "--keep-redundant-keys")
+            {
+                options.removeRedundantKeys = false;
+                continue;
+            }
+            else if (!pValue)
+            {
+                ok = false;
+            }
+            else if (Arg == "--bones")
+            {
+                ok = ParseList(pValue, options.boneCounts);
+            }
+            else if (Arg == "--lengths")
+            {
+                ok = ParseList(pValue, options.clipLengths);
+            }
+            else if (Arg == "--instances")
+            {
+                ok = ParseList(pValue, options.instanceCounts);
+            }
+            else if (Arg == "--threads")
+            {
+                ok = ParseList(pValue, options.threadCounts);
+            }
+            else if (Arg == "--scale-bones")
+            {
+                ok = (std::istringstream(pValue) >> options.scaleBoneCount) && options.scaleBoneCount > 0;
+            }
+            else if (Arg == "--scale-length")
+            {
+                ok = (std::istringstream(pValue) >> options.scaleClipLength) && options.scaleClipLength > 0.0f;
+            }
+            else if (Arg == "--out")
+            {
+                options.outFilename = pValue;
+            }
+            else
+            {
+                ok = false;
+            }
+
+            if (!ok)
+            {
+                std::cerr << "AnimationBenchmark : bad argument " << Arg << std::endl;
+                return false;
+            }
+            ++i;
+        }
+
+        // 1, 2, 4, ... up to every hardware thread
+        if (options.threadCounts.empty())
+        {
+            const int HardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+            for (int threadCount = 1; threadCount < HardwareThreads; threadCount *= 2)
+            {
+                options.threadCounts.push_back(threadCount);
+            }
+            options.threadCounts.push_back(HardwareThreads);
+        }
+        return true;
+    }
+
+    void WriteJson(std::ostream& os, const Options& options, const std::vector<Result>& results)
+    {
+        os << "{" << std::endl
+            << "  \"schema\": " << SchemaVersion << "," << std::endl
+            << "  \"simd\": " << (PoseBlend::IsSimdEnabled() ? "true" : "false") << "," << std::endl
+            << "  \"hardwareThreads\": " << std::thread::hardware_concurrency() << "," << std::endl
+            << "  \"minimumSeconds\": " << options.minimumSeconds << "," << std::endl
+            << "  \"results\": [" << std::endl;
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const Result& result = results[i];
+            os << "    { \"stage\": \"" << result.stage << "\""
+                << ", \"bones\": " << result.boneCount
+                << ", \"clipLength\": " << result.clipLength
+                << ", \"instances\": " << result.instanceCount
+                << ", \"threads\": " << result.threadCount
+                << ", \"iterations\": " << result.iterations
+                << ", \"nsPerBone\": " << std::fixed << std::setprecision(3) << result.nsPerBone << std::defaultfloat
+                << " }" << (i + 1 < results.size() ? "," : "") << std::endl;
+        }
+        os << "  ]" << std::endl
+            << "}" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    if (!CheckAngleBetween())
+        return 1;
+
+    // Singletons are created here, before worker threads can race to create them.
+    AnimationLod::Instance();
+    JobSystem::Instance();
+
+    // Fixed seed, so every run measures the same rigs.
+    std::mt19937 random(1992);
+    std::vector<Result> results;
+    for (int boneCount : options.boneCounts)
+    {
+        const std::shared_ptr<Skeleton> pSkeleton = CreateSkeleton(boneCount, random);
+        for (float clipLength : options.clipLengths)
+        {
+            std::cerr << "stages : " << boneCount << " bones, " << clipLength << " s" << std::endl;
+            const std::shared_ptr<Animation> pClip = CompressClip(*CreateClip(*pSkeleton, clipLength, random), options);
+            if (!pClip)
+                return 1;
+            MeasureStages(*pSkeleton, *pClip, options, results);
+        }
+    }
+
+    const std::shared_ptr<Skeleton> pScaleSkeleton = CreateSkeleton(options.scaleBoneCount, random);
+    const std::shared_ptr<Animation> pScaleClip = CompressClip(*CreateClip(*pScaleSkeleton, options.scaleClipLength, random), options);
+    if (!pScaleClip)
+        return 1;
+    for (int instanceCount : options.instanceCounts)
+    {
+        for (int threadCount : options.threadCounts)
+        {
+            std::cerr << "update : " << instanceCount << " instances, " << threadCount << " threads" << std::endl;
+            MeasureUpdate(*pScaleSkeleton, pScaleClip, instanceCount, threadCount, options, results);
+        }
+    }
+    JobSystem::Instance()->Free();
+
+    if (options.outFilename.empty())
+    {
+        WriteJson(std::cout, options, results);
+        return 0;
+    }
+
+    std::ofstream ofs(options.outFilename);
+    WriteJson(ofs, options, results);
+    if (!ofs)
+    {
+        std::cerr << "AnimationBenchmark : can't write " << options.outFilename << std::endl;
+        return 1;
+    }
+    return 0;
+}
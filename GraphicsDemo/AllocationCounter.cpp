@@ -0,0 +1,50 @@
+/*
+    AllocationCounter.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    AllocationCounter class implementation.
+    Replacement of global operator new/delete for debug build.
+*/
+#include "Common.h"
+#include "AllocationCounter.h"
+
+namespace
+{
+    // Per thread so counting doesn't need synchronization and other threads don't disturb the measurement.
+    thread_local std::uint64_t s_threadAllocationCount = 0;
+}
+
+#ifdef GD_COUNT_ALLOCATIONS
+// Array, nothrow and sized forms forward to these by default.
+void* operator new(std::size_t size)
+{
+    ++s_threadAllocationCount;
+    void* p = std::malloc(size > 0 ? size : 1);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+#endif
+
+AllocationCounter::AllocationCounter()
+    : m_origin(s_threadAllocationCount)
+{
+}
+
+std::uint64_t AllocationCounter::GetCount() const
+{
+    return s_threadAllocationCount - m_origin;
+}
+
+std::uint64_t AllocationCounter::GetThreadTotal()
+{
+    return s_threadAllocationCount;
+}
@@ -0,0 +1,41 @@
+/*
+    AllocationCounter.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    References :
+        https://en.cppreference.com/w/cpp/memory/new/operator_new
+
+    AllocationCounter class definition.
+*/
+#ifndef ALLOCATION_COUNTER_H_
+#define ALLOCATION_COUNTER_H_
+
+//
+// class AllocationCounter
+//
+// Counts heap allocations made by the calling thread during lifetime of the object.
+// Allocations are counted by replaced global operator new, which is compiled in only when
+// GD_COUNT_ALLOCATIONS is defined( debug build ). Otherwise GetCount() always returns 0.
+//
+// usage:
+//  AllocationCounter counter;
+//  animator.Update(object);
+//  assert(counter.GetCount() == 0);
+//
+class AllocationCounter
+{
+public:
+    AllocationCounter();
+
+    // Number of allocations made by this thread since construction.
+    std::uint64_t GetCount() const;
+
+    // Number of allocations made by this thread since it started.
+    static std::uint64_t GetThreadTotal();
+
+private:
+    std::uint64_t m_origin;
+};
+
+#endif
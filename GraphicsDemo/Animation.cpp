@@ -14,9 +14,99 @@
 #include "Common.h"
 #include "Animation.h"
 #include "Serialization.h"
+#include "Quantization.h"
+#include "Skeleton.h"
+
+namespace
+{
+    // KeyFrame indices in m_keyIndices are 16 bits.
+    const int MaximumIndexedKeyFrameCount = 0x10000;
+
+    // Written before the name by animations that write tracks field by field. Name length is never negative,
+    // so streams that hold tracks as raw structs are still read.
+    const int TrackFieldsTag = -1;
+
+    // Largest error of keys strictly between 'first' and 'last' when they are interpolated from 'decoded[first]' and 'decoded[last]'.
+    template <typename Value, typename ErrorFunction, typename InterpolateFunction>
+    float CalcSegmentError(const std::vector<Value>& source, const std::vector<Value>& decoded, const std::vector<float>& timeStamps,
+        int first, int last, ErrorFunction error, InterpolateFunction interpolate)
+    {
+        const float Duration = timeStamps[last] - timeStamps[first];
+        float maxError = 0.0f;
+        for (int i = first + 1; i < last; ++i)
+        {
+            const float t = Duration > 0.0f ? (timeStamps[i] - timeStamps[first]) / Duration : 0.0f;
+            maxError = std::max(maxError, error(source[i], interpolate(decoded[first], decoded[last], t)));
+        }
+        return maxError;
+    }
+
+    // Picks keys of a track to keep, greedily extending each segment while every key inside it
+    // is reproduced within 'maxError'. First and last keys are always kept.
+    // 'source' is the original track and 'decoded' what stored keys decode to.
+    // Returns the largest error over all keys, including error of the kept keys themselves.
+    template <typename Value, typename ErrorFunction, typename InterpolateFunction>
+    float ReduceKeys(const std::vector<Value>& source, const std::vector<Value>& decoded, const std::vector<float>& timeStamps,
+        float maxError, ErrorFunction error, InterpolateFunction interpolate, std::vector<int>& keys)
+    {
+        const int KeyCount = static_cast<int>(source.size());
+        float maxFoundError = 0.0f;
+        for (int i = 0; i < KeyCount; ++i)
+        {
+            maxFoundError = std::max(maxFoundError, error(source[i], decoded[i]));
+        }
+
+        keys.clear();
+        keys.push_back(0);
+        int first = 0;
+        while (first < KeyCount - 1)
+        {
+            int last = first + 1;
+            while (last + 1 < KeyCount && CalcSegmentError(source, decoded, timeStamps, first, last + 1, error, interpolate) <= maxError)
+            {
+                ++last;
+            }
+            maxFoundError = std::max(maxFoundError, CalcSegmentError(source, decoded, timeStamps, first, last, error, interpolate));
+            keys.push_back(last);
+            first = last;
+        }
+        return maxFoundError;
+    }
+
+    float RotationError(const glm::quat& a, const glm::quat& b)
+    {
+        return AngleBetween(a, b);
+    }
+
+    glm::quat InterpolateRotation(const glm::quat& a, const glm::quat& b, float t)
+    {
+        return glm::slerp(a, b, t);
+    }
+
+    float TranslationError(const glm::vec3& a, const glm::vec3& b)
+    {
+        return glm::distance(a, b);
+    }
+
+    glm::vec3 InterpolateTranslation(const glm::vec3& a, const glm::vec3& b, float t)
+    {
+        return glm::lerp(a, b, t);
+    }
+}
+
+Animation::CompressionSettings::CompressionSettings()
+    : maxRotationError(0.001f)
+    , maxTranslationError(0.01f)
+    , removeRedundantKeys(true)
+{
+}
 
 Animation::Animation(const std::string & name)
     : m_name(name)
+    , m_length(0.0f)
+    , m_maxRotationError(0.0f)
+    , m_maxTranslationError(0.0f)
+    , m_boneNames()
 {
 }
 
@@ -32,35 +122,171 @@ void Animation::SetName(const std::string& name)
 
 void Animation::AddKeyFrame(KeyFrame keyFrame)
 {
-    m_keyFrames.push_back(keyFrame);
+    assert(!IsCompressed());
+    assert(m_keyFrames.empty() || m_keyFrames.front().GetPose().GetBoneCount() == keyFrame.GetPose().GetBoneCount());
+
+    const float TimeStamp = keyFrame.GetTimeStamp();
+    const std::vector<float>::iterator Position = std::upper_bound(m_timeStamps.begin(), m_timeStamps.end(), TimeStamp);
+    const std::ptrdiff_t Index = Position - m_timeStamps.begin();
+    m_timeStamps.insert(Position, TimeStamp);
+    m_keyFrames.insert(m_keyFrames.begin() + Index, keyFrame);
+}
+
+int Animation::GetKeyFrameCount() const
+{
+    return static_cast<int>(m_timeStamps.size());
 }
 
-KeyFrame * Animation::GetKeyFrameBefore(float timeStamp)
+float Animation::GetKeyFrameTimeStamp(int index) const
 {
-    if (timeStamp > m_length)
-        return &m_keyFrames.back();
+    return m_timeStamps[index];
+}
 
-    for (std::vector<KeyFrame>::reverse_iterator iter = m_keyFrames.rbegin(); iter != m_keyFrames.rend(); ++iter)
+void Animation::FindKeyFrames(float timeStamp, int& prevIndex, int& nextIndex, float& t, int* pCursor) const
+{
+    assert(!m_timeStamps.empty());
+
+    const int KeyFrameCount = GetKeyFrameCount();
+    prevIndex = FindKeyFrameIndex(timeStamp, pCursor ? *pCursor : 0);
+    nextIndex = std::min(prevIndex + 1, KeyFrameCount - 1);
+
+    if (pCursor)
     {
-        if (iter->GetTimeStamp() < timeStamp)
-        {
-            return &*iter;
-        }
+        *pCursor = prevIndex;
     }
 
-    return &m_keyFrames.front();
+    const float PrevTime = m_timeStamps[prevIndex];
+    const float NextTime = m_timeStamps[nextIndex];
+    t = NextTime > PrevTime
+        ? glm::clamp((timeStamp - PrevTime) / (NextTime - PrevTime), 0.0f, 1.0f)
+        : 0.0f;
 }
 
-KeyFrame * Animation::GetKeyFrameAfter(float timeStamp)
+void Animation::DecodePose(int index, Pose& pose) const
 {
-    for (KeyFrame& keyFrame : m_keyFrames)
+    assert(pose.GetBoneCount() == GetBoneCount());
+
+    if (!IsCompressed())
     {
-        if (keyFrame.GetTimeStamp() > timeStamp)
+        // Assignment reuses storage of 'pose'; no allocation.
+        pose = m_keyFrames[index].GetPose();
+        return;
+    }
+
+    glm::vec3* pTranslations = pose.GetTranslations();
+    glm::quat* pRotations = pose.GetRotations();
+    const int BoneCount = GetBoneCount();
+    for (int i = 0; i < BoneCount; ++i)
+    {
+        const Track& track = m_tracks[i];
+        int first;
+        int second;
+        float t;
+
+        FindTrackKeys(track.rotationKeyIndexOffset, track.rotationKeyCount, index, first, second, t);
+        glm::quat rotations[2];
+        for (int k = 0; k < (first == second ? 1 : 2); ++k)
         {
-            return &keyFrame;
+            const uint32_t Key = track.rotationOffset + (k == 0 ? first : second);
+            rotations[k] = track.rotationFormat == TF_QUANTIZED
+                ? DequantizeQuaternion(&m_quantizedRotations[Key * 3])
+                : m_rawRotations[Key];
         }
+        pRotations[i] = first == second ? rotations[0] : InterpolateRotation(rotations[0], rotations[1], t);
+
+        FindTrackKeys(track.translationKeyIndexOffset, track.translationKeyCount, index, first, second, t);
+        glm::vec3 translations[2];
+        for (int k = 0; k < (first == second ? 1 : 2); ++k)
+        {
+            const uint32_t Key = track.translationOffset + (k == 0 ? first : second);
+            if (track.translationFormat == TF_QUANTIZED)
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    translations[k][c] = DequantizeRange(m_quantizedTranslations[Key * 3 + c], track.translationMinimum[c], track.translationExtent[c]);
+                }
+            }
+            else
+            {
+                translations[k] = m_rawTranslations[Key];
+            }
+        }
+        pTranslations[i] = first == second ? translations[0] : InterpolateTranslation(translations[0], translations[1], t);
     }
-    return &m_keyFrames.back();
+}
+
+void Animation::Compress(const CompressionSettings& settings)
+{
+    assert(!IsCompressed());
+    if (m_keyFrames.empty())
+        return;
+
+    m_maxRotationError = 0.0f;
+    m_maxTranslationError = 0.0f;
+
+    // Tracks that keep every KeyFrame have no key indices, so longer clips don't remove keys.
+    CompressionSettings trackSettings = settings;
+    if (GetKeyFrameCount() > MaximumIndexedKeyFrameCount && trackSettings.removeRedundantKeys)
+    {
+        std::cout << "Animation::Compress() : '" << m_name << "' has " << GetKeyFrameCount() << " keyframes, more than "
+            << MaximumIndexedKeyFrameCount << " key indices can address. Keys are not removed." << std::endl;
+        trackSettings.removeRedundantKeys = false;
+    }
+
+    const int BoneCount = GetBoneCount();
+    m_tracks.resize(BoneCount);
+    for (int i = 0; i < BoneCount; ++i)
+    {
+        CompressRotationTrack(i, trackSettings, m_tracks[i]);
+        CompressTranslationTrack(i, trackSettings, m_tracks[i]);
+    }
+
+    std::vector<KeyFrame>().swap(m_keyFrames);
+}
+
+bool Animation::IsCompressed() const
+{
+    return !m_tracks.empty();
+}
+
+int Animation::GetPoseDataSize() const
+{
+    if (!IsCompressed())
+    {
+        return GetKeyFrameCount() * GetBoneCount() * static_cast<int>(sizeof(glm::vec3) + sizeof(glm::quat));
+    }
+
+    return static_cast<int>(m_tracks.size() * sizeof(Track)
+        + m_rawRotations.size() * sizeof(glm::quat)
+        + m_quantizedRotations.size() * sizeof(uint16_t)
+        + m_rawTranslations.size() * sizeof(glm::vec3)
+        + m_quantizedTranslations.size() * sizeof(uint16_t)
+        + m_keyIndices.size() * sizeof(uint16_t));
+}
+
+int Animation::GetTrackKeyCount() const
+{
+    if (!IsCompressed())
+    {
+        return GetKeyFrameCount() * GetBoneCount() * 2;
+    }
+
+    int keyCount = 0;
+    for (const Track& track : m_tracks)
+    {
+        keyCount += track.rotationKeyCount + track.translationKeyCount;
+    }
+    return keyCount;
+}
+
+float Animation::GetMaxRotationError() const
+{
+    return m_maxRotationError;
+}
+
+float Animation::GetMaxTranslationError() const
+{
+    return m_maxTranslationError;
 }
 
 void Animation::SetLength(float length)
@@ -68,39 +294,391 @@ void Animation::SetLength(float length)
     m_length = length;
 }
 
-float Animation::GetLength()
+float Animation::GetLength() const
 {
     return m_length;
 }
 
+int Animation::GetBoneCount() const
+{
+    if (IsCompressed())
+        return static_cast<int>(m_tracks.size());
+    return m_keyFrames.empty() ? 0 : m_keyFrames.front().GetPose().GetBoneCount();
+}
+
 void Animation::Serialize(std::ostream& os) const
 {
-    Serialization::Write(os, m_name);
-    int keyFrameCount = static_cast<int>(m_keyFrames.size());
-    Serialization::Write(os, keyFrameCount);
-    for (int i = 0; i < keyFrameCount; ++i)
+    if (!IsCompressed() && !m_keyFrames.empty())
     {
-        m_keyFrames[i].Serialize(os);
+        Animation compressed;
+        CopyTo(compressed);
+        compressed.Compress(CompressionSettings());
+        compressed.Serialize(os);
+        return;
     }
+
+    Serialization::Write(os, TrackFieldsTag);
+    Serialization::Write(os, m_name);
     Serialization::Write(os, m_length);
+    Serialization::WriteVector(os, m_timeStamps);
+    const int TrackCount = static_cast<int>(m_tracks.size());
+    Serialization::Write(os, TrackCount);
+    for (const Track& track : m_tracks)
+    {
+        Serialization::Write(os, track.rotationFormat);
+        Serialization::Write(os, track.translationFormat);
+        Serialization::Write(os, track.rotationOffset);
+        Serialization::Write(os, track.translationOffset);
+        Serialization::Write(os, track.rotationKeyCount);
+        Serialization::Write(os, track.translationKeyCount);
+        Serialization::Write(os, track.rotationKeyIndexOffset);
+        Serialization::Write(os, track.translationKeyIndexOffset);
+        Serialization::Write(os, track.translationMinimum);
+        Serialization::Write(os, track.translationExtent);
+    }
+    Serialization::WriteVector(os, m_rawRotations);
+    Serialization::WriteVector(os, m_quantizedRotations);
+    Serialization::WriteVector(os, m_rawTranslations);
+    Serialization::WriteVector(os, m_quantizedTranslations);
+    Serialization::WriteVector(os, m_keyIndices);
+    Serialization::Write(os, m_maxRotationError);
+    Serialization::Write(os, m_maxTranslationError);
+
+    // Name table of the clip. Ids are only valid within a run, so names are written.
+    const int BoneNameCount = static_cast<int>(m_boneNames.size());
+    Serialization::Write(os, BoneNameCount);
+    for (NameId id : m_boneNames)
+    {
+        Serialization::Write(os, NameTable::Instance()->GetString(id));
+    }
 }
 
 void Animation::Deserialize(std::istream& is)
 {
-    Serialization::Read(is, m_name);
-    int keyFrameCount;
-    Serialization::Read(is, keyFrameCount);
-    m_keyFrames.resize(keyFrameCount);
-    for (int i = 0; i < keyFrameCount; ++i)
+    m_keyFrames.clear();
+    int nameLength = 0;
+    Serialization::Read(is, nameLength);
+    const bool TrackFields = nameLength == TrackFieldsTag;
+    if (TrackFields)
+    {
+        Serialization::Read(is, m_name);
+    }
+    else
     {
-        m_keyFrames[i].Deserialize(is);
+        std::vector<char> name(std::max(nameLength, 0));
+        is.read(name.data(), name.size());
+        m_name.assign(name.begin(), name.end());
     }
     Serialization::Read(is, m_length);
+    Serialization::ReadVector(is, m_timeStamps);
+    if (TrackFields)
+    {
+        int trackCount = 0;
+        Serialization::Read(is, trackCount);
+        m_tracks.resize(std::max(trackCount, 0));
+        for (Track& track : m_tracks)
+        {
+            Serialization::Read(is, track.rotationFormat);
+            Serialization::Read(is, track.translationFormat);
+            Serialization::Read(is, track.rotationOffset);
+            Serialization::Read(is, track.translationOffset);
+            Serialization::Read(is, track.rotationKeyCount);
+            Serialization::Read(is, track.translationKeyCount);
+            Serialization::Read(is, track.rotationKeyIndexOffset);
+            Serialization::Read(is, track.translationKeyIndexOffset);
+            Serialization::Read(is, track.translationMinimum);
+            Serialization::Read(is, track.translationExtent);
+        }
+    }
+    else
+    {
+        // Older streams hold tracks as raw structs, padding included.
+        Serialization::ReadVector(is, m_tracks);
+    }
+    Serialization::ReadVector(is, m_rawRotations);
+    Serialization::ReadVector(is, m_quantizedRotations);
+    Serialization::ReadVector(is, m_rawTranslations);
+    Serialization::ReadVector(is, m_quantizedTranslations);
+    Serialization::ReadVector(is, m_keyIndices);
+    Serialization::Read(is, m_maxRotationError);
+    Serialization::Read(is, m_maxTranslationError);
+
+    int boneNameCount = 0;
+    Serialization::Read(is, boneNameCount);
+    m_boneNames.resize(boneNameCount);
+    std::string name;
+    for (NameId& id : m_boneNames)
+    {
+        Serialization::Read(is, name);
+        id = NameTable::Instance()->Intern(name);
+    }
 }
 
-void Animation::CopyTo(Animation& dest)
+void Animation::CopyTo(Animation& dest) const
 {
     dest.m_name = m_name;
     dest.m_keyFrames = m_keyFrames;
+    dest.m_timeStamps = m_timeStamps;
     dest.m_length = m_length;
+    dest.m_tracks = m_tracks;
+    dest.m_rawRotations = m_rawRotations;
+    dest.m_quantizedRotations = m_quantizedRotations;
+    dest.m_rawTranslations = m_rawTranslations;
+    dest.m_quantizedTranslations = m_quantizedTranslations;
+    dest.m_keyIndices = m_keyIndices;
+    dest.m_maxRotationError = m_maxRotationError;
+    dest.m_maxTranslationError = m_maxTranslationError;
+    dest.m_boneNames = m_boneNames;
+}
+
+void Animation::SetBoneNames(const Skeleton& skeleton)
+{
+    m_boneNames.resize(skeleton.GetBoneCount());
+    for (int i = 0; i < skeleton.GetBoneCount(); ++i)
+    {
+        m_boneNames[i] = skeleton.GetBoneByIndex(i).GetNameId();
+    }
+}
+
+NameId Animation::GetBoneNameId(int index) const
+{
+    return index < static_cast<int>(m_boneNames.size()) ? m_boneNames[index] : NameTable::INVALID_NAME_ID;
+}
+
+bool Animation::IsBoundTo(const Skeleton& skeleton) const
+{
+    if (GetBoneCount() != skeleton.GetBoneCount())
+        return false;
+
+    for (int i = 0; i < static_cast<int>(m_boneNames.size()); ++i)
+    {
+        if (m_boneNames[i] != skeleton.GetBoneByIndex(i).GetNameId())
+            return false;
+    }
+    return true;
+}
+
+int Animation::FindKeyFrameIndex(float timeStamp, int cursor) const
+{
+    const int KeyFrameCount = static_cast<int>(m_timeStamps.size());
+
+    // Try the cursor and the one after it first. Covers forward playback.
+    if (cursor >= 0 && cursor < KeyFrameCount && m_timeStamps[cursor] <= timeStamp)
+    {
+        for (int i = cursor; i < std::min(cursor + 2, KeyFrameCount); ++i)
+        {
+            if (i + 1 == KeyFrameCount || timeStamp < m_timeStamps[i + 1])
+                return i;
+        }
+    }
+
+    // Looped back or jumped. Binary search.
+    const std::vector<float>::const_iterator Position = std::upper_bound(m_timeStamps.begin(), m_timeStamps.end(), timeStamp);
+    return std::max(static_cast<int>(Position - m_timeStamps.begin()) - 1, 0);
+}
+
+void Animation::FindTrackKeys(uint32_t keyIndexOffset, uint32_t keyCount, int index, int& first, int& second, float& t) const
+{
+    t = 0.0f;
+    if (keyCount == 1)
+    {
+        first = second = 0;
+        return;
+    }
+    if (keyCount == m_timeStamps.size())
+    {
+        first = second = index;
+        return;
+    }
+
+    // Last key is always on the last KeyFrame, so there is a key after or on 'index'.
+    const uint16_t* pBegin = &m_keyIndices[keyIndexOffset];
+    const uint16_t* pEnd = pBegin + keyCount;
+    second = static_cast<int>(std::lower_bound(pBegin, pEnd, static_cast<uint16_t>(index)) - pBegin);
+    if (pBegin[second] == index)
+    {
+        first = second;
+        return;
+    }
+
+    first = second - 1;
+    const float FirstTime = m_timeStamps[pBegin[first]];
+    const float SecondTime = m_timeStamps[pBegin[second]];
+    t = SecondTime > FirstTime ? (m_timeStamps[index] - FirstTime) / (SecondTime - FirstTime) : 0.0f;
+}
+
+void Animation::StoreKeyIndices(const std::vector<int>& keys, uint32_t& keyIndexOffset, uint32_t& keyCount)
+{
+    keyCount = static_cast<uint32_t>(keys.size());
+    keyIndexOffset = static_cast<uint32_t>(m_keyIndices.size());
+    if (keyCount == 1 || keyCount == m_timeStamps.size())
+        return;
+
+    for (int key : keys)
+    {
+        m_keyIndices.push_back(static_cast<uint16_t>(key));
+    }
+}
+
+void Animation::CompressRotationTrack(int boneIndex, const CompressionSettings& settings, Track& track)
+{
+    const int KeyFrameCount = GetKeyFrameCount();
+    std::vector<glm::quat> source(KeyFrameCount);
+    for (int k = 0; k < KeyFrameCount; ++k)
+    {
+        source[k] = m_keyFrames[k].GetPose().GetRotations()[boneIndex];
+    }
+
+    float constantError = 0.0f;
+    for (int k = 1; k < KeyFrameCount; ++k)
+    {
+        constantError = std::max(constantError, RotationError(source[0], source[k]));
+    }
+    if (constantError <= settings.maxRotationError)
+    {
+        track.rotationFormat = TF_CONSTANT;
+        track.rotationOffset = static_cast<uint32_t>(m_rawRotations.size());
+        StoreKeyIndices(std::vector<int>(1, 0), track.rotationKeyIndexOffset, track.rotationKeyCount);
+        m_rawRotations.push_back(source[0]);
+        m_maxRotationError = std::max(m_maxRotationError, constantError);
+        return;
+    }
+
+    std::vector<uint16_t> quantized(KeyFrameCount * 3);
+    std::vector<glm::quat> decoded(KeyFrameCount);
+    float quantizedError = 0.0f;
+    for (int k = 0; k < KeyFrameCount; ++k)
+    {
+        QuantizeQuaternion(source[k], &quantized[k * 3]);
+        decoded[k] = DequantizeQuaternion(&quantized[k * 3]);
+        quantizedError = std::max(quantizedError, RotationError(source[k], decoded[k]));
+    }
+
+    // Error bound is tighter than quantization step
+    track.rotationFormat = quantizedError <= settings.maxRotationError ? TF_QUANTIZED : TF_RAW;
+    if (track.rotationFormat == TF_RAW)
+    {
+        decoded = source;
+    }
+
+    std::vector<int> keys;
+    float error;
+    if (settings.removeRedundantKeys)
+    {
+        error = ReduceKeys(source, decoded, m_timeStamps, settings.maxRotationError, RotationError, InterpolateRotation, keys);
+    }
+    else
+    {
+        for (int k = 0; k < KeyFrameCount; ++k)
+        {
+            keys.push_back(k);
+        }
+        error = track.rotationFormat == TF_QUANTIZED ? quantizedError : 0.0f;
+    }
+    StoreKeyIndices(keys, track.rotationKeyIndexOffset, track.rotationKeyCount);
+    m_maxRotationError = std::max(m_maxRotationError, error);
+
+    if (track.rotationFormat == TF_QUANTIZED)
+    {
+        track.rotationOffset = static_cast<uint32_t>(m_quantizedRotations.size() / 3);
+        for (int key : keys)
+        {
+            m_quantizedRotations.insert(m_quantizedRotations.end(), &quantized[key * 3], &quantized[key * 3] + 3);
+        }
+    }
+    else
+    {
+        track.rotationOffset = static_cast<uint32_t>(m_rawRotations.size());
+        for (int key : keys)
+        {
+            m_rawRotations.push_back(source[key]);
+        }
+    }
+}
+
+void Animation::CompressTranslationTrack(int boneIndex, const CompressionSettings& settings, Track& track)
+{
+    const int KeyFrameCount = GetKeyFrameCount();
+    std::vector<glm::vec3> source(KeyFrameCount);
+    for (int k = 0; k < KeyFrameCount; ++k)
+    {
+        source[k] = m_keyFrames[k].GetPose().GetTranslations()[boneIndex];
+    }
+
+    glm::vec3 minimum = source[0];
+    glm::vec3 maximum = source[0];
+    float constantError = 0.0f;
+    for (int k = 1; k < KeyFrameCount; ++k)
+    {
+        minimum = glm::min(minimum, source[k]);
+        maximum = glm::max(maximum, source[k]);
+        constantError = std::max(constantError, TranslationError(source[0], source[k]));
+    }
+
+    track.translationMinimum = minimum;
+    track.translationExtent = maximum - minimum;
+
+    if (constantError <= settings.maxTranslationError)
+    {
+        track.translationFormat = TF_CONSTANT;
+        track.translationOffset = static_cast<uint32_t>(m_rawTranslations.size());
+        StoreKeyIndices(std::vector<int>(1, 0), track.translationKeyIndexOffset, track.translationKeyCount);
+        m_rawTranslations.push_back(source[0]);
+        m_maxTranslationError = std::max(m_maxTranslationError, constantError);
+        return;
+    }
+
+    std::vector<uint16_t> quantized(KeyFrameCount * 3);
+    std::vector<glm::vec3> decoded(KeyFrameCount);
+    float quantizedError = 0.0f;
+    for (int k = 0; k < KeyFrameCount; ++k)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            quantized[k * 3 + c] = QuantizeRange(source[k][c], minimum[c], track.translationExtent[c]);
+            decoded[k][c] = DequantizeRange(quantized[k * 3 + c], minimum[c], track.translationExtent[c]);
+        }
+        quantizedError = std::max(quantizedError, TranslationError(source[k], decoded[k]));
+    }
+
+    // Range of the track is too wide for 16 bits within the error bound
+    track.translationFormat = quantizedError <= settings.maxTranslationError ? TF_QUANTIZED : TF_RAW;
+    if (track.translationFormat == TF_RAW)
+    {
+        decoded = source;
+    }
+
+    std::vector<int> keys;
+    float error;
+    if (settings.removeRedundantKeys)
+    {
+        error = ReduceKeys(source, decoded, m_timeStamps, settings.maxTranslationError, TranslationError, InterpolateTranslation, keys);
+    }
+    else
+    {
+        for (int k = 0; k < KeyFrameCount; ++k)
+        {
+            keys.push_back(k);
+        }
+        error = track.translationFormat == TF_QUANTIZED ? quantizedError : 0.0f;
+    }
+    StoreKeyIndices(keys, track.translationKeyIndexOffset, track.translationKeyCount);
+    m_maxTranslationError = std::max(m_maxTranslationError, error);
+
+    if (track.translationFormat == TF_QUANTIZED)
+    {
+        track.translationOffset = static_cast<uint32_t>(m_quantizedTranslations.size() / 3);
+        for (int key : keys)
+        {
+            m_quantizedTranslations.insert(m_quantizedTranslations.end(), &quantized[key * 3], &quantized[key * 3] + 3);
+        }
+    }
+    else
+    {
+        track.translationOffset = static_cast<uint32_t>(m_rawTranslations.size());
+        for (int key : keys)
+        {
+            m_rawTranslations.push_back(source[key]);
+        }
+    }
 }
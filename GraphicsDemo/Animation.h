@@ -9,62 +9,194 @@
     Dependencies :
         glm - vector, matrix representation
 
-    BoneTransform struct definition.
-    KeyFrame, Animation class definition.
+    Animation class definition.
 */
 #ifndef ANIMATION_H_
 #define ANIMATION_H_
 
 #include "KeyFrame.h"
+#include "NameTable.h"
+
+class Skeleton;
 
 //
 // class Animation
 //
 // class 'Animation' represents a single shot of animation.
 // Animation is represented by multiple instances of 'KeyFrame' over timeline.
-// Internally class 'Animation' stores array of 'KeyFrame' in time ascending order.
-// Each 'KeyFrame' has timestamp set. To get time stamp of a KeyFrame, call KeyFarme::GetTimeStamp()
+// Pose of every KeyFrame is indexed by bone index of the Skeleton the animation was loaded with.
+//
+// KeyFrames are added in full precision, then Compress() converts them into per bone tracks:
+//  - rotation keys are stored in 48 bits( smallest three )
+//  - translation keys are stored in 16 bits per component, quantized within range of the track
+//  - a track that doesn't move beyond the error bound is collapsed to a single key
+//  - a track that can't be quantized within the error bound is kept in full precision
+//  - keys that interpolation between their neighbours reproduces within the error bound are removed,
+//    so each track keeps its own subset of the KeyFrame timeline
+// Poses are read with DecodePose() in either state. Serialize() always writes compressed form.
+//
+// Animation remembers name of the bone each pose index stands for( SetBoneNames() ). The names are written once
+// per clip, not per key, and let IsBoundTo() check a clip against a skeleton by comparing interned ids.
+//
+// usage:
+//  animation.AddKeyFrame(keyFrame); // for every keyframe
+//  animation.Compress(Animation::CompressionSettings());
+//  ...
+//  animation.FindKeyFrames(time, prevIndex, nextIndex, t, &cursor);
+//  animation.DecodePose(prevIndex, prevPose);
 //
 class Animation
 {
 public:
+    struct CompressionSettings
+    {
+        CompressionSettings();
+
+        // Maximum angle in radians decoded rotation may differ from the source
+        float maxRotationError;
+        // Maximum distance decoded translation may differ from the source
+        float maxTranslationError;
+        // Removes keys of each track that are reproduced by interpolating kept keys. Ignored for clips of more than
+        // 65536 KeyFrames, whose KeyFrame indices don't fit in 16 bits.
+        bool removeRedundantKeys;
+    };
+
     Animation(const std::string& name = "");
 
     const std::string& GetName();
 
     void SetName(const std::string& name);
 
-    // Adds a keyframe.
-    // Todo : sort insert
+    // Adds a keyframe. KeyFrames are kept sorted by timestamp regardless of the order they are added in.
+    // A keyframe with the same timestamp as an existing one is placed after it.
+    // Animation must not be compressed yet.
     void AddKeyFrame(KeyFrame keyFrame);
 
-    // Gets the keyframe placed before the given 'timeStamp'
-    // If the 'timeStamp' went out of boundary of Animation length, it just returns the first or the last frame.
-    KeyFrame* GetKeyFrameBefore(float timeStamp);
+    int GetKeyFrameCount() const;
+
+    float GetKeyFrameTimeStamp(int index) const;
+
+    // Finds indices of the pair of KeyFrames surrounding 'timeStamp' and interpolation factor 't' between them.
+    // If the 'timeStamp' went out of boundary of Animation length, both are the first or the last frame.
+    //
+    // 'pCursor' optionally points to 'prevIndex' found by the last call, and is updated on return.
+    // During normal playback the answer is the same or the next KeyFrame of the cursor,
+    // so those are tested before falling back to binary search over timestamps.
+    void FindKeyFrames(float timeStamp, int& prevIndex, int& nextIndex, float& t, int* pCursor = nullptr) const;
+
+    // Writes pose of 'index'th KeyFrame to 'pose'. 'pose' must be sized to GetBoneCount().
+    void DecodePose(int index, Pose& pose) const;
+
+    // Converts added KeyFrames into compressed tracks. KeyFrames in full precision are released.
+    void Compress(const CompressionSettings& settings);
+
+    bool IsCompressed() const;
 
-    // Gets the keyframe placed after the given 'timeStamp'
-    // If the 'timeStamp' went out of boundary of Animation length, it just returns the first or the last frame.
-    KeyFrame* GetKeyFrameAfter(float timeStamp);
+    // Bytes taken by pose data. Full precision size if not compressed.
+    int GetPoseDataSize() const;
+
+    // Number of rotation and translation keys stored over all bones. KeyFrame count * bone count * 2 if not compressed.
+    int GetTrackKeyCount() const;
+
+    // Largest error found by Compress() in radians / distance.
+    float GetMaxRotationError() const;
+
+    float GetMaxTranslationError() const;
 
     // Sets length of the animation in seconds
     void SetLength(float length);
 
     // Gets length of the animation in seconds
-    float GetLength();
+    float GetLength() const;
+
+    // Gets number of bones each KeyFrame has pose for.
+    // Equals to bone count of the Skeleton the animation is bound to.
+    int GetBoneCount() const;
+
+    // Records names of bones of 'skeleton' as names of pose indices
+    void SetBoneNames(const Skeleton& skeleton);
+
+    // Name of bone pose index 'index' stands for. NameTable::INVALID_NAME_ID if names are not set.
+    NameId GetBoneNameId(int index) const;
+
+    // Returns true if pose index of every bone of 'skeleton' is its bone index.
+    // An animation without bone names is only checked for bone count.
+    bool IsBoundTo(const Skeleton& skeleton) const;
 
     void Serialize(std::ostream& os) const;
 
     void Deserialize(std::istream& is);
 
-    void CopyTo(Animation& dest);
+    void CopyTo(Animation& dest) const;
 
 private:
+    enum TrackFormat : uint8_t
+    {
+        // Single key in full precision for the whole animation
+        TF_CONSTANT,
+        // Keys in quantized form
+        TF_QUANTIZED,
+        // Keys in full precision
+        TF_RAW,
+    };
+
+    // Compressed keys of a bone. Offsets are in keys of the array selected by format.
+    // A track with fewer keys than KeyFrames lists the KeyFrame index of each key in m_keyIndices from its key index offset.
+    struct Track
+    {
+        TrackFormat rotationFormat;
+        TrackFormat translationFormat;
+        uint32_t rotationOffset;
+        uint32_t translationOffset;
+        uint32_t rotationKeyCount;
+        uint32_t translationKeyCount;
+        uint32_t rotationKeyIndexOffset;
+        uint32_t translationKeyIndexOffset;
+        // Quantization range of translation keys
+        glm::vec3 translationMinimum;
+        glm::vec3 translationExtent;
+    };
+
     // Name of the animation
     std::string m_name;
-    // All list of keyframes
+    // All list of keyframes in time ascending order. Empty once compressed.
     std::vector<KeyFrame> m_keyFrames;
+    // Timestamp of each keyframe, kept apart so that searching does not touch pose data
+    std::vector<float> m_timeStamps;
     // Entire length of the animation
     float m_length;
+
+    // Compressed form, indexed by bone index
+    std::vector<Track> m_tracks;
+    // Constant and full precision rotation keys
+    std::vector<glm::quat> m_rawRotations;
+    // Quantized rotation keys, 3 per key
+    std::vector<uint16_t> m_quantizedRotations;
+    // Constant and full precision translation keys
+    std::vector<glm::vec3> m_rawTranslations;
+    // Quantized translation keys, 3 per key
+    std::vector<uint16_t> m_quantizedTranslations;
+    // KeyFrame index of each key of tracks that had keys removed
+    std::vector<uint16_t> m_keyIndices;
+    float m_maxRotationError;
+    float m_maxTranslationError;
+
+    // Bone name per pose index. Empty if not set.
+    std::vector<NameId> m_boneNames;
+
+    // Gets index of the last KeyFrame whose timestamp is not greater than 'timeStamp'. Returns 0 if there is none.
+    int FindKeyFrameIndex(float timeStamp, int cursor) const;
+
+    // Finds keys 'first', 'second' of a track that surround 'index'th KeyFrame, and interpolation factor 't' between them.
+    // 'first' and 'second' are the same if the track has a key on the KeyFrame.
+    void FindTrackKeys(uint32_t keyIndexOffset, uint32_t keyCount, int index, int& first, int& second, float& t) const;
+
+    // Appends KeyFrame indices of 'keys' to m_keyIndices unless the track kept every KeyFrame.
+    void StoreKeyIndices(const std::vector<int>& keys, uint32_t& keyIndexOffset, uint32_t& keyCount);
+
+    void CompressRotationTrack(int boneIndex, const CompressionSettings& settings, Track& track);
+
+    void CompressTranslationTrack(int boneIndex, const CompressionSettings& settings, Track& track);
 };
 
 #endif
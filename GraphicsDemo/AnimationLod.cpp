@@ -0,0 +1,197 @@
+/*
+    AnimationLod.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    AnimationLod class implementation.
+*/
+#include "Common.h"
+#include "AnimationLod.h"
+#include "Skeleton.h"
+#ifndef GD_HEADLESS
+#include "Object.h"
+#include "PerspectiveCamera.h"
+#endif
+
+namespace
+{
+    // Every bone is sampled
+    const int AllBones = INT_MAX;
+
+    const AnimationLod::Tier DefaultTiers[] = {
+        { 0.25f, 1, AllBones },
+        { 0.08f, 2, 8 },
+        { 0.0f, 4, 6 },
+    };
+}
+
+AnimationLod::AnimationLod()
+    : m_enabled(false)
+    , m_tiers(std::begin(DefaultTiers), std::end(DefaultTiers))
+    , m_frameBudget(0.0f)
+    , m_frame(0)
+    , m_frameStart()
+    , m_hasViewer(false)
+    , m_viewerPosition()
+    , m_projectionScale(1.0f)
+{
+}
+
+void AnimationLod::SetEnabled(bool enabled)
+{
+    m_enabled = enabled;
+}
+
+bool AnimationLod::IsEnabled() const
+{
+    return m_enabled;
+}
+
+void AnimationLod::SetTiers(const std::vector<Tier>& tiers)
+{
+    assert(!tiers.empty());
+    m_tiers = tiers;
+}
+
+const std::vector<AnimationLod::Tier>& AnimationLod::GetTiers() const
+{
+    return m_tiers;
+}
+
+void AnimationLod::SetFrameBudget(float milliseconds)
+{
+    m_frameBudget = milliseconds;
+}
+
+float AnimationLod::GetFrameBudget() const
+{
+    return m_frameBudget;
+}
+
+#ifndef GD_HEADLESS
+void AnimationLod::SetViewer(PerspectiveCamera& camera)
+{
+    m_hasViewer = true;
+    m_viewerPosition = camera.GetPosition();
+    m_projectionScale = camera.ProjectionMatrix()[1][1];
+
+    // Rows of view projection matrix combined give clip planes
+    const glm::mat4 ViewProjection = camera.ProjectionMatrix() * camera.EyeMatrix();
+    const glm::vec4 Row0(ViewProjection[0][0], ViewProjection[1][0], ViewProjection[2][0], ViewProjection[3][0]);
+    const glm::vec4 Row1(ViewProjection[0][1], ViewProjection[1][1], ViewProjection[2][1], ViewProjection[3][1]);
+    const glm::vec4 Row2(ViewProjection[0][2], ViewProjection[1][2], ViewProjection[2][2], ViewProjection[3][2]);
+    const glm::vec4 Row3(ViewProjection[0][3], ViewProjection[1][3], ViewProjection[2][3], ViewProjection[3][3]);
+    m_frustumPlanes[0] = Row3 + Row0;
+    m_frustumPlanes[1] = Row3 - Row0;
+    m_frustumPlanes[2] = Row3 + Row1;
+    m_frustumPlanes[3] = Row3 - Row1;
+    m_frustumPlanes[4] = Row3 + Row2;
+    m_frustumPlanes[5] = Row3 - Row2;
+    for (glm::vec4& plane : m_frustumPlanes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
+
+void AnimationLod::Schedule(const std::vector<std::shared_ptr<Object>>& objects, std::vector<int>& order)
+{
+    ++m_frame;
+    m_frameStart = std::chrono::high_resolution_clock::now();
+
+    const int ObjectCount = static_cast<int>(objects.size());
+    order.resize(ObjectCount);
+    for (int i = 0; i < ObjectCount; ++i)
+    {
+        order[i] = i;
+    }
+
+    m_objectTiers.resize(ObjectCount);
+    m_tierObjectCounts.assign(m_tiers.size() + 1, 0);
+    for (int i = 0; i < ObjectCount; ++i)
+    {
+        Object& object = *objects[i];
+        std::shared_ptr<Animator> pAnimator = object.GetAnimator();
+        if (!pAnimator)
+        {
+            m_objectTiers[i] = 0;
+            continue;
+        }
+
+        if (!m_enabled || !m_hasViewer)
+        {
+            m_objectTiers[i] = 0;
+            pAnimator->SetLod(1, AllBones, 0);
+            continue;
+        }
+
+        const int TierIndex = FindTier(object);
+        m_objectTiers[i] = TierIndex;
+        ++m_tierObjectCounts[TierIndex];
+        if (TierIndex < static_cast<int>(m_tiers.size()))
+        {
+            const Tier& tier = m_tiers[TierIndex];
+            // Objects next to each other in the scene update on different frames
+            pAnimator->SetLod(tier.updateInterval, tier.maxBoneDepth, tier.updateInterval > 0 ? i % tier.updateInterval : 0);
+        }
+        else
+        {
+            pAnimator->SetLod(0, AllBones, 0);
+        }
+    }
+
+    if (m_enabled)
+    {
+        std::stable_sort(order.begin(), order.end(), [this](int lhs, int rhs)
+        {
+            return m_objectTiers[lhs] < m_objectTiers[rhs];
+        });
+    }
+}
+
+#endif
+
+bool AnimationLod::IsOverBudget() const
+{
+    if (!m_enabled || m_frameBudget <= 0.0f)
+        return false;
+
+    const std::chrono::duration<float, std::milli> Elapsed = std::chrono::high_resolution_clock::now() - m_frameStart;
+    return Elapsed.count() > m_frameBudget;
+}
+
+unsigned int AnimationLod::GetFrame() const
+{
+    return m_frame;
+}
+
+int AnimationLod::GetTierObjectCount(int tierIndex) const
+{
+    return tierIndex < static_cast<int>(m_tierObjectCounts.size()) ? m_tierObjectCounts[tierIndex] : 0;
+}
+
+#ifndef GD_HEADLESS
+int AnimationLod::FindTier(Object& object) const
+{
+    const int CulledTier = static_cast<int>(m_tiers.size());
+
+    std::shared_ptr<const Skeleton> pSkeleton = object.GetSkeleton();
+    const glm::vec3& Scale = object.GetScale();
+    const float Radius = (pSkeleton ? pSkeleton->GetBindPoseRadius() : 0.0f) * std::max(Scale.x, std::max(Scale.y, Scale.z));
+    const glm::vec3 Center(object.GetTransformMatrix()[3]);
+
+    for (const glm::vec4& plane : m_frustumPlanes)
+    {
+        if (glm::dot(glm::vec3(plane), Center) + plane.w < -Radius)
+            return CulledTier;
+    }
+
+    const float Distance = std::max(glm::distance(m_viewerPosition, Center), glm::epsilon<float>());
+    const float ScreenSize = Radius * m_projectionScale / Distance;
+    for (int i = 0; i < CulledTier; ++i)
+    {
+        if (ScreenSize >= m_tiers[i].minScreenSize)
+            return i;
+    }
+    return CulledTier - 1;
+}
+#endif
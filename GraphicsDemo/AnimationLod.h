@@ -0,0 +1,110 @@
+/*
+    AnimationLod.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    References :
+        http://www.cs.otago.ac.nz/postgrads/alexis/planeExtraction.pdf
+
+    Dependencies :
+        glm - vector, matrix representation
+
+    AnimationLod class definition.
+*/
+#ifndef ANIMATION_LOD_H_
+#define ANIMATION_LOD_H_
+
+#include "Singleton.h"
+
+class Object;
+class PerspectiveCamera;
+
+//
+// class AnimationLod
+//
+// Picks how often and how much of the skeleton each Animator samples, from how large the object appears to the viewer.
+// Screen size is diameter of the bounding sphere of the skeleton in bind pose, in fraction of viewport height.
+// Each tier has an update interval and a bone mask( maximum bone depth ). Animators of the same tier update on
+// different frames so that the cost is spread over frames. Objects outside the view frustum keep their pose.
+// Playback time keeps going regardless, so animation is in time when the object is sampled again.
+//
+// With frame budget set, animators stop sampling once the budget is used up in the frame, and sample on the
+// next frame instead, whether or not that frame has budget left. Objects are updated in tier order, so closer objects
+// are served first.
+//
+// usage:
+//  AnimationLod::Instance()->SetEnabled(true);
+//  ...
+//  AnimationLod::Instance()->SetViewer(camera); // every frame before Scene::Update()
+//  scene.Update(); // calls Schedule()
+//
+class AnimationLod : public Singleton<AnimationLod>
+{
+public:
+    struct Tier
+    {
+        // Smallest screen size an object must have to use the tier
+        float minScreenSize;
+        // Pose is sampled every 'updateInterval'th frame. 0 keeps the pose.
+        int updateInterval;
+        // Bones deeper than this in the hierarchy keep their last sampled local transform.
+        int maxBoneDepth;
+    };
+
+    // Starts disabled with default tiers.
+    AnimationLod();
+
+    void SetEnabled(bool enabled);
+
+    bool IsEnabled() const;
+
+    // Sets tiers in descending order of minScreenSize. Objects smaller than every tier use the last one.
+    void SetTiers(const std::vector<Tier>& tiers);
+
+    const std::vector<Tier>& GetTiers() const;
+
+    // Sets milliseconds animators may spend on sampling in a frame. 0 for no limit.
+    void SetFrameBudget(float milliseconds);
+
+    float GetFrameBudget() const;
+
+    // Takes view of 'camera' for the following Schedule() calls.
+    void SetViewer(PerspectiveCamera& camera);
+
+    // Sets LOD of animator of every object in 'objects' and writes order the objects should be updated in to 'order'.
+    // Starts frame budget. Call once a frame, before updating objects.
+    void Schedule(const std::vector<std::shared_ptr<Object>>& objects, std::vector<int>& order);
+
+    // Returns true if frame budget ran out. Thread safe.
+    bool IsOverBudget() const;
+
+    // Number of Schedule() calls so far
+    unsigned int GetFrame() const;
+
+    // Number of objects put in 'tierIndex'th tier by the last Schedule(). GetTiers().size() for objects outside view.
+    int GetTierObjectCount(int tierIndex) const;
+
+private:
+    bool m_enabled;
+    std::vector<Tier> m_tiers;
+    float m_frameBudget;
+    unsigned int m_frame;
+    std::chrono::high_resolution_clock::time_point m_frameStart;
+
+    // Viewer
+    bool m_hasViewer;
+    glm::vec3 m_viewerPosition;
+    // Element [1][1] of projection matrix; 1 / tan(fovy / 2)
+    float m_projectionScale;
+    // View frustum planes in world space, normalized. Inside is positive.
+    glm::vec4 m_frustumPlanes[6];
+
+    // Tier index per object of the last Schedule()
+    std::vector<int> m_objectTiers;
+    std::vector<int> m_tierObjectCounts;
+
+    // Tier index for 'object', or m_tiers.size() if it is outside view.
+    int FindTier(Object& object) const;
+};
+
+#endif
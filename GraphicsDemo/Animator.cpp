@@ -9,14 +9,110 @@
 */
 #include "Common.h"
 #include "Animator.h"
+#ifndef GD_HEADLESS
 #include "Object.h"
+#endif
 #include "Skeleton.h"
 #include "Animation.h"
 #include "Serialization.h"
+#include "AllocationCounter.h"
+#include "PoseCache.h"
+#include "AnimationLod.h"
+#include "BakedAnimation.h"
+#include "ClipLibrary.h"
+#include "BlendTree.h"
+
+namespace
+{
+    // Written first by animators that write where their animation comes from. Older streams start with the embedded
+    // animation, whose first value is its name length or Animation's own negative tag, never this.
+    const int AnimationSourceTag = -2;
+
+    // Wraps 'time' into [0, 'length')
+    float WrapTime(double time, double length)
+    {
+        if (length <= 0.0)
+            return 0.0f;
+
+        double wrapped = std::fmod(time, length);
+        if (wrapped < 0.0)
+        {
+            wrapped += length;
+        }
+        return static_cast<float>(wrapped);
+    }
+
+    // Makes 'prev' / 'next' hold KeyFrame 'prevIndex' / 'nextIndex' of 'animation', given that they hold
+    // 'decodedPrev' / 'decodedNext'( -1 if nothing ). A KeyFrame is decoded only when playback moves onto it.
+    void DecodeKeyFrames(const Animation& animation, int prevIndex, int nextIndex, Pose& prev, Pose& next, int& decodedPrev, int& decodedNext)
+    {
+        // Moved on to the next pair of KeyFrames; old next is new prev.
+        if (prevIndex == decodedNext && prevIndex != decodedPrev)
+        {
+            std::swap(prev, next);
+            std::swap(decodedPrev, decodedNext);
+        }
+
+        if (prevIndex != decodedPrev)
+        {
+            animation.DecodePose(prevIndex, prev);
+            decodedPrev = prevIndex;
+        }
+
+        if (nextIndex != decodedNext)
+        {
+            animation.DecodePose(nextIndex, next);
+            decodedNext = nextIndex;
+        }
+    }
+
+    // Tree CrossfadeTo() plays: slot 0 fading to slot 1 by parameter 0. Shared by every Animator.
+    std::shared_ptr<const BlendTree> GetCrossfadeTree()
+    {
+        static const std::shared_ptr<const BlendTree> Tree = []()
+        {
+            std::shared_ptr<BlendTree> pTree(new BlendTree);
+            pTree->Compile(pTree->AddCrossfade(pTree->AddClip(0), pTree->AddClip(1), 0));
+            return pTree;
+        }();
+        return Tree;
+    }
+}
 
 Animator::Animator()
     : m_currentAnimation()
     , m_animationTime(0.f)
+    , m_playbackRate(1.0f)
+    , m_fixedTimeStep(0.0f)
+    , m_timeAccumulator(0.0f)
+    , m_fixedStepOrigin(0.0f)
+    , m_fixedStepCount(0)
+    , m_keyFrameCursor(0)
+    , m_rotationMode(PoseBlend::RM_SLERP)
+    , m_poseCacheEnabled(false)
+    , m_updateInterval(1)
+    , m_maxBoneDepth(INT_MAX)
+    , m_lodPhase(0)
+    , m_posePending(false)
+    , m_pBakedAnimation()
+    , m_bakedFrameBlend(false)
+    , m_bakedFrames()
+    , m_bakedFrameT(0.0f)
+    , m_paletteRequired(false)
+    , m_pBlendTree()
+    , m_clipSlots()
+    , m_blendParameters()
+    , m_posePool()
+    , m_crossfadeDuration(0.0f)
+    , m_crossfadeElapsed(0.0f)
+    , m_maskedBones()
+    , m_maskedBoneDepth(-1)
+    , m_prevPose()
+    , m_nextPose()
+    , m_prevPoseIndex(-1)
+    , m_nextPoseIndex(-1)
+    , m_boneCount(0)
+    , m_paletteVersion(0)
 {
 }
 
@@ -28,36 +124,351 @@ std::shared_ptr<Animation> Animator::GetCurrentAnimation()
 void Animator::SetCurrentAnimation(std::shared_ptr<Animation> pAnimation)
 {
     m_currentAnimation = pAnimation;
+    m_pBakedAnimation.reset();
+    m_pBlendTree.reset();
+    m_clipSlots.clear();
+    m_blendParameters.clear();
+    m_crossfadeDuration = 0.0f;
+    m_keyFrameCursor = 0;
+    InvalidatePoses();
 }
 
-void Animator::Update(Object& object)
+void Animator::CrossfadeTo(std::shared_ptr<Animation> pAnimation, float duration)
 {
-    if (m_currentAnimation == nullptr)
+    // A tree set by SetBlendTree() has no single animation to fade from.
+    std::shared_ptr<Animation> pFrom = m_currentAnimation;
+    const float FromTime = m_animationTime;
+    const bool Fade = duration > 0.0f && pFrom && pAnimation
+        && pFrom->GetBoneCount() == pAnimation->GetBoneCount() && (!m_pBlendTree || IsCrossfading());
+
+    SetCurrentAnimation(pAnimation);
+    SetAnimationTime(0.0f);
+    if (!Fade)
         return;
 
-    std::map<std::string, glm::mat4> currentPose = CalcCurrentAnimationPose();
-    std::shared_ptr<Skeleton> pSkeleton = object.GetSkeleton();
-    if (pSkeleton)
+    SetBlendTree(GetCrossfadeTree());
+    SetClip(0, pFrom, FromTime);
+    SetClip(1, pAnimation, 0.0f);
+    m_crossfadeDuration = duration;
+}
+
+bool Animator::IsCrossfading() const
+{
+    return m_crossfadeDuration > 0.0f;
+}
+
+void Animator::SetBlendTree(std::shared_ptr<const BlendTree> pTree)
+{
+    assert(!pTree || pTree->IsCompiled());
+    const ClipSlot Unbound = { nullptr, 0.0f, 0, -1, -1 };
+    m_pBlendTree = pTree;
+    m_pBakedAnimation.reset();
+    m_clipSlots.assign(pTree ? pTree->GetSlotCount() : 0, Unbound);
+    m_blendParameters.assign(pTree ? pTree->GetParameterCount() : 0, 0.0f);
+    m_crossfadeDuration = 0.0f;
+    m_crossfadeElapsed = 0.0f;
+    ResetBlendTreeBuffers();
+}
+
+std::shared_ptr<const BlendTree> Animator::GetBlendTree() const
+{
+    return m_pBlendTree;
+}
+
+void Animator::SetClip(int slot, std::shared_ptr<Animation> pAnimation, float time)
+{
+    assert(m_pBlendTree && 0 <= slot && slot < static_cast<int>(m_clipSlots.size()));
+    ClipSlot& clip = m_clipSlots[slot];
+    clip.pAnimation = pAnimation;
+    clip.time = pAnimation ? WrapTime(time, pAnimation->GetLength()) : 0.0f;
+    clip.keyFrameCursor = 0;
+    clip.prevPoseIndex = -1;
+    clip.nextPoseIndex = -1;
+    DecodeReferencePose(slot);
+}
+
+void Animator::SetBlendParameter(int index, float value)
+{
+    assert(0 <= index && index < static_cast<int>(m_blendParameters.size()));
+    m_blendParameters[index] = value;
+}
+
+float Animator::GetBlendParameter(int index) const
+{
+    assert(0 <= index && index < static_cast<int>(m_blendParameters.size()));
+    return m_blendParameters[index];
+}
+
+PoseBlend::RotationMode Animator::GetRotationMode()
+{
+    return m_rotationMode;
+}
+
+void Animator::SetRotationMode(PoseBlend::RotationMode mode)
+{
+    m_rotationMode = mode;
+}
+
+void Animator::SetAnimationTime(float time)
+{
+    m_animationTime = WrapAnimationTime(time);
+    ResetFixedStep();
+}
+
+float Animator::GetAnimationTime()
+{
+    return m_animationTime;
+}
+
+void Animator::SetPlaybackRate(float rate)
+{
+    m_playbackRate = rate;
+}
+
+float Animator::GetPlaybackRate()
+{
+    return m_playbackRate;
+}
+
+void Animator::SetFixedTimeStep(float timeStep)
+{
+    assert(timeStep >= 0.0f);
+    m_fixedTimeStep = timeStep;
+    ResetFixedStep();
+}
+
+float Animator::GetFixedTimeStep()
+{
+    return m_fixedTimeStep;
+}
+
+void Animator::SetPoseCacheEnabled(bool enabled)
+{
+    m_poseCacheEnabled = enabled;
+}
+
+bool Animator::IsPoseCacheEnabled()
+{
+    return m_poseCacheEnabled;
+}
+
+void Animator::SetLod(int updateInterval, int maxBoneDepth, int phase)
+{
+    m_updateInterval = updateInterval;
+    m_maxBoneDepth = maxBoneDepth;
+    m_lodPhase = phase;
+}
+
+void Animator::SetBakedAnimation(std::shared_ptr<const BakedAnimation> pBaked, bool blendFrames)
+{
+    if (pBaked)
+    {
+        SetCurrentAnimation(pBaked->GetSourceAnimation());
+    }
+    m_pBakedAnimation = pBaked;
+    m_bakedFrameBlend = blendFrames;
+    m_bakedFrames[0] = 0;
+    m_bakedFrames[1] = 0;
+    m_bakedFrameT = 0.0f;
+}
+
+std::shared_ptr<const BakedAnimation> Animator::GetBakedAnimation() const
+{
+    return m_pBakedAnimation;
+}
+
+void Animator::GetBakedFrames(int& frame0, int& frame1, float& t) const
+{
+    frame0 = m_bakedFrames[0];
+    frame1 = m_bakedFrames[1];
+    t = m_bakedFrameT;
+}
+
+void Animator::SetPaletteRequired(bool required)
+{
+    m_paletteRequired = required;
+}
+
+void Animator::Sample(const Skeleton& skeleton, float animationTime)
+{
+    assert(m_currentAnimation && m_currentAnimation->GetBoneCount() == skeleton.GetBoneCount());
+    PrepareBuffers(skeleton.GetBoneCount());
+    CalcCurrentAnimationPose(WrapAnimationTime(animationTime), false);
+    ApplyPoseToBones(skeleton);
+}
+
+#ifndef GD_HEADLESS
+void Animator::Update(Object& object, float dt)
+{
+    Update(object.GetSkeleton().get(), dt);
+}
+#endif
+
+void Animator::Update(const Skeleton* pSkeleton, float dt)
+{
+    if (m_pBlendTree ? GetBlendTreeBoneCount() == 0 : m_currentAnimation == nullptr)
+        return;
+
+#ifdef GD_COUNT_ALLOCATIONS
+    const AllocationCounter Counter;
+#endif
+
+    if (m_pBakedAnimation)
+    {
+#ifdef GD_COUNT_ALLOCATIONS
+        const bool BakedResized = PrepareBuffers(m_pBakedAnimation->GetBoneCount());
+#else
+        PrepareBuffers(m_pBakedAnimation->GetBoneCount());
+#endif
+        UpdateBaked();
+        IncreaseAnimationTime(dt);
+#ifdef GD_COUNT_ALLOCATIONS
+        assert(BakedResized || Counter.GetCount() == 0);
+#endif
+        return;
+    }
+
+    const bool Resized = PrepareBuffers(m_pBlendTree ? GetBlendTreeBoneCount() : m_currentAnimation->GetBoneCount());
+
+    // First update after buffers are sized always samples every bone.
+    const AnimationLod* pLod = AnimationLod::Instance();
+    const bool Due = Resized || m_posePending
+        || (m_updateInterval > 0 && (pLod->GetFrame() + m_lodPhase) % m_updateInterval == 0);
+    // Animator skipped for budget before samples regardless, so that it is skipped for one frame at most.
+    if (!Due || (!Resized && !m_posePending && pLod->IsOverBudget()))
+    {
+        // Pose stays as it is; playback time keeps going.
+        m_posePending = Due;
+        IncreaseAnimationTime(dt);
+        return;
+    }
+    m_posePending = false;
+
+#ifdef GD_COUNT_ALLOCATIONS
+    bool cacheMissed = false;
+#endif
+    if (m_pBlendTree)
+    {
+        EvaluateBlendTree();
+        if (pSkeleton)
+        {
+            ApplyPoseToBones(*pSkeleton);
+        }
+    }
+    else if (pSkeleton && m_poseCacheEnabled)
+    {
+        PoseCache* pPoseCache = PoseCache::Instance();
+        const PoseCache::Key Key = pPoseCache->MakeKey(*m_currentAnimation, *pSkeleton, m_rotationMode, m_animationTime);
+        glm::mat4* pPalette = GetGlobalTransforms() + m_boneCount;
+        if (!pPoseCache->Acquire(Key, m_boneCount, pPalette))
+        {
+            CalcCurrentAnimationPose(pPoseCache->GetSampleTime(Key), false);
+            ApplyPoseToBones(*pSkeleton);
+            pPoseCache->Publish(Key, pPalette, m_boneCount);
+#ifdef GD_COUNT_ALLOCATIONS
+            cacheMissed = true;
+#endif
+        }
+        else
+        {
+            ++m_paletteVersion;
+        }
+    }
+    else
     {
-        ApplyPoseToBones(currentPose, pSkeleton);
+        CalcCurrentAnimationPose(m_animationTime, pSkeleton && !Resized && UpdateBoneMask(*pSkeleton));
+        if (pSkeleton)
+        {
+            ApplyPoseToBones(*pSkeleton);
+        }
     }
 
-    IncreaseAnimationTime();
+    IncreaseAnimationTime(dt);
+
+#ifdef GD_COUNT_ALLOCATIONS
+    // Only the update that sizes the buffers or adds a palette to PoseCache may allocate.
+    assert(Resized || cacheMissed || Counter.GetCount() == 0);
+#endif
+}
+
+const glm::mat4* Animator::GetPalette() const
+{
+    return m_boneCount > 0 ? &m_matrices[m_boneCount * 2] : nullptr;
+}
+
+int Animator::GetPaletteSize() const
+{
+    return m_boneCount;
+}
+
+unsigned int Animator::GetPaletteVersion() const
+{
+    return m_paletteVersion;
 }
 
 void Animator::Serialize(std::ostream& os) const
 {
-    m_currentAnimation->Serialize(os);
+    // Clips of the open ClipLibrary are stored by name, so that scenes don't carry copies of library clips.
+    const ClipLibrary* pLibrary = ClipLibrary::Instance();
+    const int ClipIndex = pLibrary->FindClip(m_currentAnimation.get());
+    const AnimationSource Source = ClipIndex >= 0 ? AS_CLIP_LIBRARY : AS_EMBEDDED;
+    Serialization::Write(os, AnimationSourceTag);
+    Serialization::Write(os, Source);
+    if (Source == AS_CLIP_LIBRARY)
+    {
+        Serialization::Write(os, pLibrary->GetFilename());
+        Serialization::Write(os, pLibrary->GetClipName(ClipIndex));
+    }
+    else
+    {
+        m_currentAnimation->Serialize(os);
+    }
 
     Serialization::Write(os, m_animationTime);
 }
 
 void Animator::Deserialize(std::istream& is)
 {
-    m_currentAnimation.reset(new Animation(""));
-    m_currentAnimation->Deserialize(is);
+    int tag = 0;
+    Serialization::Read(is, tag);
+    AnimationSource source = AS_EMBEDDED;
+    if (tag == AnimationSourceTag)
+    {
+        Serialization::Read(is, source);
+    }
+    else
+    {
+        // Older stream; what was read is the start of the embedded animation.
+        is.seekg(-static_cast<std::streamoff>(sizeof(tag)), std::ios_base::cur);
+    }
+    if (source == AS_CLIP_LIBRARY)
+    {
+        std::string filename;
+        std::string clipName;
+        Serialization::Read(is, filename);
+        Serialization::Read(is, clipName);
+
+        ClipLibrary* pLibrary = ClipLibrary::Instance();
+        if (pLibrary->GetFilename() != filename)
+        {
+            pLibrary->Open(filename);
+        }
+        m_currentAnimation = pLibrary->Acquire(pLibrary->FindClip(clipName));
+        if (!m_currentAnimation)
+        {
+            std::cout << "Animator::Deserialize() : clip '" << clipName << "' is not in " << filename << std::endl;
+        }
+    }
+    else
+    {
+        m_currentAnimation.reset(new Animation(""));
+        m_currentAnimation->Deserialize(is);
+    }
 
     Serialization::Read(is, m_animationTime);
+    ResetFixedStep();
+    m_keyFrameCursor = 0;
+    InvalidatePoses();
 }
 
 void Animator::CopyTo(Animator& dest)
@@ -65,63 +476,313 @@ void Animator::CopyTo(Animator& dest)
     dest.m_currentAnimation = m_currentAnimation;
 
     dest.m_animationTime = m_animationTime;
+    dest.m_playbackRate = m_playbackRate;
+    dest.m_fixedTimeStep = m_fixedTimeStep;
+    dest.m_timeAccumulator = m_timeAccumulator;
+    dest.m_fixedStepOrigin = m_fixedStepOrigin;
+    dest.m_fixedStepCount = m_fixedStepCount;
+    dest.m_keyFrameCursor = m_keyFrameCursor;
+    dest.m_rotationMode = m_rotationMode;
+    dest.m_poseCacheEnabled = m_poseCacheEnabled;
+    dest.m_pBakedAnimation = m_pBakedAnimation;
+    dest.m_bakedFrameBlend = m_bakedFrameBlend;
+    dest.m_pBlendTree = m_pBlendTree;
+    dest.m_clipSlots = m_clipSlots;
+    dest.m_blendParameters = m_blendParameters;
+    dest.m_crossfadeDuration = m_crossfadeDuration;
+    dest.m_crossfadeElapsed = m_crossfadeElapsed;
+    dest.ResetBlendTreeBuffers();
+    dest.InvalidatePoses();
 }
 
-void Animator::IncreaseAnimationTime()
+void Animator::IncreaseAnimationTime(float dt)
 {
-    m_animationTime += 0.016f;
-    const float AnimationLength = m_currentAnimation->GetLength();
-    if (m_animationTime > AnimationLength)
+    const float Delta = dt * m_playbackRate;
+    int64_t stepCount = 0;
+    if (m_fixedTimeStep > 0.0f)
     {
-        m_animationTime -= AnimationLength;
+        m_timeAccumulator += Delta;
+        const float Steps = std::floor(m_timeAccumulator / m_fixedTimeStep);
+        m_timeAccumulator -= Steps * m_fixedTimeStep;
+        stepCount = static_cast<int64_t>(Steps);
+        m_fixedStepCount += stepCount;
+        // Computed from step count rather than accumulated, so rounding errors don't build up differently
+        // depending on how many steps each frame took.
+        m_animationTime = WrapAnimationTime(m_fixedStepOrigin + static_cast<double>(m_fixedStepCount) * m_fixedTimeStep);
     }
+    else
+    {
+        m_animationTime = WrapAnimationTime(m_animationTime + Delta);
+    }
+
+    if (m_fixedTimeStep > 0.0f)
+    {
+        // One step at a time, so clip slots and crossfade don't depend on how steps were spread over frames either.
+        for (int64_t i = 0; i < stepCount && m_pBlendTree; ++i)
+        {
+            AdvanceBlendTree(m_fixedTimeStep, m_fixedTimeStep);
+        }
+    }
+    else if (m_pBlendTree)
+    {
+        AdvanceBlendTree(Delta, dt);
+    }
+}
+
+void Animator::UpdateBaked()
+{
+    m_pBakedAnimation->FindFrames(m_animationTime, m_bakedFrames[0], m_bakedFrames[1], m_bakedFrameT);
+    if (!m_bakedFrameBlend)
+    {
+        m_bakedFrames[1] = m_bakedFrames[0];
+        m_bakedFrameT = 0.0f;
+    }
+
+    if (m_paletteRequired || m_pBakedAnimation->GetTexture() == 0)
+    {
+        m_pBakedAnimation->UnpackFrames(m_bakedFrames[0], m_bakedFrames[1], m_bakedFrameT, GetGlobalTransforms() + m_boneCount);
+        ++m_paletteVersion;
+    }
+}
+
+float Animator::WrapAnimationTime(double time)
+{
+    return WrapTime(time, m_currentAnimation ? m_currentAnimation->GetLength() : 0.0);
 }
 
-std::map<std::string, glm::mat4> Animator::CalcCurrentAnimationPose()
+void Animator::ResetFixedStep()
 {
-    KeyFrame* pPrev = m_currentAnimation->GetKeyFrameBefore(m_animationTime);
-    KeyFrame* pNext = m_currentAnimation->GetKeyFrameAfter(m_animationTime);
+    m_timeAccumulator = 0.0f;
+    m_fixedStepOrigin = m_animationTime;
+    m_fixedStepCount = 0;
+}
 
-    float t = (m_animationTime - pPrev->GetTimeStamp()) / (pNext->GetTimeStamp() - pPrev->GetTimeStamp());
-    return InterpolatePoses(*pPrev, *pNext, t);
+glm::mat4* Animator::GetLocalTransforms()
+{
+    return m_matrices.data();
+}
+
+glm::mat4* Animator::GetGlobalTransforms()
+{
+    return m_matrices.data() + m_boneCount;
 }
 
-std::map<std::string, glm::mat4> Animator::InterpolatePoses(KeyFrame & prev, KeyFrame & next, float t)
+bool Animator::PrepareBuffers(int boneCount)
 {
-    std::map<std::string, glm::mat4> currentPose;
+    if (m_boneCount == boneCount)
+        return false;
 
-    // Pose is set of transforms for bone
-    const std::map<std::string, BoneTransform>& NextPose = next.GetPose();
-    for (auto& kv : prev.GetPose())
+    m_boneCount = boneCount;
+    m_matrices.assign(boneCount * 3, glm::identity<glm::mat4>());
+    ++m_paletteVersion;
+    m_maskedBones.reserve(boneCount);
+    m_maskedBoneDepth = -1;
+    m_prevPose.Resize(boneCount);
+    m_nextPose.Resize(boneCount);
+    InvalidatePoses();
+    ResetBlendTreeBuffers();
+    return true;
+}
+
+void Animator::CalcCurrentAnimationPose(float animationTime, bool masked)
+{
+    int prevIndex;
+    int nextIndex;
+    float t;
+    m_currentAnimation->FindKeyFrames(animationTime, prevIndex, nextIndex, t, &m_keyFrameCursor);
+    DecodePoses(prevIndex, nextIndex);
+
+    assert(m_boneCount == m_prevPose.GetBoneCount());
+    if (masked)
+    {
+        PoseBlend::InterpolateSelectedToMatrices(m_prevPose, m_nextPose, t, m_rotationMode,
+            m_maskedBones.data(), static_cast<int>(m_maskedBones.size()), GetLocalTransforms());
+    }
+    else
     {
-        BoneTransform nextTransform = NextPose.at(kv.first);
-        currentPose[kv.first] = BoneTransform::Interpolate(kv.second, nextTransform, t).GetTransformMatrix();
+        PoseBlend::InterpolateToMatrices(m_prevPose, m_nextPose, t, m_rotationMode, GetLocalTransforms());
     }
+}
+
+bool Animator::UpdateBoneMask(const Skeleton& skeleton)
+{
+    assert(skeleton.GetBoneCount() == m_boneCount);
+    if (m_maskedBoneDepth != m_maxBoneDepth)
+    {
+        // Capacity is reserved by PrepareBuffers()
+        m_maskedBones.clear();
+        const int* pBoneDepths = skeleton.GetBoneDepths();
+        for (int i = 0; i < m_boneCount; ++i)
+        {
+            if (pBoneDepths[i] <= m_maxBoneDepth)
+            {
+                m_maskedBones.push_back(i);
+            }
+        }
+        m_maskedBoneDepth = m_maxBoneDepth;
+    }
+    return static_cast<int>(m_maskedBones.size()) < m_boneCount;
+}
+
+void Animator::DecodePoses(int prevIndex, int nextIndex)
+{
+    DecodeKeyFrames(*m_currentAnimation, prevIndex, nextIndex, m_prevPose, m_nextPose, m_prevPoseIndex, m_nextPoseIndex);
+}
+
+int Animator::GetBlendTreeBoneCount() const
+{
+    for (const ClipSlot& clip : m_clipSlots)
+    {
+        if (clip.pAnimation)
+            return clip.pAnimation->GetBoneCount();
+    }
+    return 0;
+}
+
+void Animator::ResetBlendTreeBuffers()
+{
+    if (!m_pBlendTree)
+        return;
+
+    m_posePool.Reset(m_pBlendTree->GetRegisterCount(), m_boneCount);
+    for (int i = 0; i < static_cast<int>(m_clipSlots.size()); ++i)
+    {
+        m_clipSlots[i].prevPoseIndex = -1;
+        m_clipSlots[i].nextPoseIndex = -1;
+        DecodeReferencePose(i);
+    }
+}
+
+void Animator::DecodeReferencePose(int slot)
+{
+    const int Register = m_pBlendTree->GetReferenceRegister(slot);
+    const Animation* pAnimation = m_clipSlots[slot].pAnimation.get();
+    // Otherwise decoded once PrepareBuffers() sizes registers for the clip.
+    if (Register >= 0 && pAnimation && pAnimation->GetBoneCount() == m_posePool.GetBoneCount())
+    {
+        pAnimation->DecodePose(0, m_posePool.Get(Register));
+    }
+}
 
-    return currentPose;
+void Animator::EvaluateBlendTree()
+{
+    assert(GetBlendTreeBoneCount() == m_boneCount && m_posePool.GetBoneCount() == m_boneCount);
+    const std::vector<BlendTree::Instruction>& Instructions = m_pBlendTree->GetInstructions();
+    const int InstructionCount = static_cast<int>(Instructions.size());
+    for (int i = 0; i < InstructionCount; ++i)
+    {
+        const BlendTree::Instruction& instruction = Instructions[i];
+        const float Weight = instruction.parameter >= 0 ? glm::clamp(m_blendParameters[instruction.parameter], 0.0f, 1.0f) : 0.0f;
+        switch (instruction.op)
+        {
+        case BlendTree::OP_SAMPLE:
+            SampleClipSlot(instruction.operand, instruction.source, m_posePool.Get(instruction.target));
+            break;
+
+        case BlendTree::OP_SKIP_IF_ZERO:
+            if (Weight <= 0.0f)
+            {
+                i += instruction.operand;
+            }
+            break;
+
+        case BlendTree::OP_SKIP_IF_ONE:
+            if (Weight >= 1.0f)
+            {
+                i += instruction.operand;
+            }
+            break;
+
+        case BlendTree::OP_CROSSFADE:
+            // Target wasn't evaluated at weight 1
+            if (Weight >= 1.0f)
+            {
+                m_posePool.Swap(instruction.target, instruction.source);
+            }
+            else
+            {
+                Pose& target = m_posePool.Get(instruction.target);
+                PoseBlend::Blend(target, m_posePool.Get(instruction.source), Weight, m_rotationMode, target);
+            }
+            break;
+
+        case BlendTree::OP_ADDITIVE:
+        {
+            Pose& target = m_posePool.Get(instruction.target);
+            PoseBlend::BlendAdditive(target, m_posePool.Get(instruction.source), m_posePool.Get(instruction.operand), Weight, target);
+            break;
+        }
+
+        case BlendTree::OP_MASKED:
+        {
+            const std::vector<float>& Mask = m_pBlendTree->GetMask(instruction.operand);
+            assert(static_cast<int>(Mask.size()) >= m_boneCount);
+            Pose& target = m_posePool.Get(instruction.target);
+            PoseBlend::BlendMasked(target, m_posePool.Get(instruction.source), Mask.data(), Weight, target);
+            break;
+        }
+        }
+    }
+
+    PoseBlend::ToMatrices(m_posePool.Get(m_pBlendTree->GetResultRegister()), GetLocalTransforms());
+}
+
+void Animator::SampleClipSlot(int slot, int source, Pose& target)
+{
+    ClipSlot& clip = m_clipSlots[slot];
+    assert(clip.pAnimation && "clip slot reached by blend tree must be bound");
+    if (!clip.pAnimation)
+        return;
+
+    int prevIndex;
+    int nextIndex;
+    float t;
+    clip.pAnimation->FindKeyFrames(clip.time, prevIndex, nextIndex, t, &clip.keyFrameCursor);
+    Pose& prev = m_posePool.Get(source);
+    Pose& next = m_posePool.Get(source + 1);
+    DecodeKeyFrames(*clip.pAnimation, prevIndex, nextIndex, prev, next, clip.prevPoseIndex, clip.nextPoseIndex);
+    PoseBlend::Blend(prev, next, t, m_rotationMode, target);
 }
 
-void Animator::ApplyPoseToBones(std::map<std::string, glm::mat4>& pose, std::shared_ptr<Skeleton> pSkeleton)
+void Animator::AdvanceBlendTree(float playbackDelta, float crossfadeDelta)
 {
-    // Transform matrix of parent born is used in calculation of descendent nodes.
-    // This map caches transform matrix per Bone
-    std::unordered_map<Bone*, glm::mat4> globalMatrixCache;
-    const int BoneCount = pSkeleton->GetBoneCount();
-    for (int i = 0; i < BoneCount; ++i)
+    for (ClipSlot& clip : m_clipSlots)
     {
-        Bone* pBone = &pSkeleton->GetBoneByIndex(i);
-        // Parent bone index. Root bone has parent id DUMMY_PARENT_NODE_INDEX
-        int parentIndex = pBone->GetParent();
-        assert(parentIndex < i);
-        // Parent bone.
-        Bone* pParent = pBone->GetParent() != Skeleton::DUMMY_PARENT_NODE_INDEX
-            ? &pSkeleton->GetBoneByIndex(parentIndex)
-            : nullptr;
-        // Parent bone transform matrix
-        const glm::mat4 ParentMatrix = pParent ? globalMatrixCache[pParent] : glm::identity<glm::mat4>();
-        const glm::mat4& LocalTransform = pose[pBone->GetName()];
-        const glm::mat4 CurrentTransform = ParentMatrix * LocalTransform;
-        globalMatrixCache[pBone] = CurrentTransform;
-        pBone->SetAnimationTransform(CurrentTransform * pBone->GetInvLinkTransform() * pBone->GetTransform());
+        if (clip.pAnimation)
+        {
+            clip.time = WrapTime(clip.time + playbackDelta, clip.pAnimation->GetLength());
+        }
     }
+
+    if (!IsCrossfading())
+        return;
+
+    // Animation faded to is current animation; it keeps its playback time, fixed time step and all.
+    m_clipSlots[1].time = m_animationTime;
+    m_crossfadeElapsed += crossfadeDelta;
+    m_blendParameters[0] = m_crossfadeElapsed / m_crossfadeDuration;
+    if (m_crossfadeElapsed >= m_crossfadeDuration)
+    {
+        m_pBlendTree.reset();
+        m_clipSlots.clear();
+        m_blendParameters.clear();
+        m_crossfadeDuration = 0.0f;
+        m_crossfadeElapsed = 0.0f;
+    }
+}
+
+void Animator::InvalidatePoses()
+{
+    m_prevPoseIndex = -1;
+    m_nextPoseIndex = -1;
+}
+
+void Animator::ApplyPoseToBones(const Skeleton& skeleton)
+{
+    assert(m_boneCount == skeleton.GetBoneCount());
+
+    glm::mat4* pGlobalTransforms = GetGlobalTransforms();
+    skeleton.ComputeGlobalTransforms(GetLocalTransforms(), pGlobalTransforms);
+    skeleton.ComputePalette(pGlobalTransforms, pGlobalTransforms + m_boneCount);
+    ++m_paletteVersion;
 }
@@ -14,15 +14,21 @@
 #ifndef ANIMATOR_H_
 #define ANIMATOR_H_
 
+#include "PoseBlend.h"
+#include "PosePool.h"
+
 class Object;
 class Skeleton;
 class Bone;
 class Animation;
-class KeyFrame;
+class BakedAnimation;
+class BlendTree;
 
 //
 // Animator class manages internal timer, to read in 'KeyFrame's of 'Animatioin' to interpolate pose at the time.
 // 'Animator' class also propagates bone/joint transform along the skeleton given by 'Object' in Animator::Update() call.
+// Instead of current animation, Animator can play a BlendTree whose clip slots and weights it owns;
+// CrossfadeTo() uses one to switch animations without popping.
 //
 // usage:
 //  std::shared_ptr<Animation> pAnimation(...)/ // Create and Initialize 'Animation'
@@ -31,7 +37,7 @@ class KeyFrame;
 //  
 //  ...
 //
-//  aniamtor.Update(object); // every frame
+//  aniamtor.Update(object, dt); // every frame
 //
 class Animator
 {
@@ -41,11 +47,100 @@ public:
     // Gets current animation that is playing.
     std::shared_ptr<Animation> GetCurrentAnimation();
 
-    // Sets current animation to be played.
+    // Sets current animation to be played. Stops playing baked animation and blend tree.
     void SetCurrentAnimation(std::shared_ptr<Animation> pAnimation);
 
-    // Invoke every frame to play animation.s
-    void Update(Object& object);
+    // Fades from what is playing to 'pAnimation' over 'duration' seconds, then plays 'pAnimation' alone.
+    // 'pAnimation' becomes current animation right away and plays from time 0. A crossfade started during another
+    // fades from the animation the earlier one was fading to. Same as SetCurrentAnimation() if 'duration' is 0.
+    void CrossfadeTo(std::shared_ptr<Animation> pAnimation, float duration);
+
+    bool IsCrossfading() const;
+
+    // Plays 'pTree' instead of current animation. 'pTree' must be compiled. Clips are bound to its slots by SetClip()
+    // and weights are set by SetBlendParameter(); both start unbound / 0. nullptr goes back to current animation.
+    // Every bound clip must have the same bone count. LOD bone mask and PoseCache don't apply while a tree plays.
+    // Blend tree isn't serialized; current animation is.
+    void SetBlendTree(std::shared_ptr<const BlendTree> pTree);
+
+    std::shared_ptr<const BlendTree> GetBlendTree() const;
+
+    // Binds 'pAnimation' to clip slot 'slot' of blend tree, playing from 'time'. Slots play at playback rate of Animator.
+    void SetClip(int slot, std::shared_ptr<Animation> pAnimation, float time = 0.0f);
+
+    // Sets weight parameter 'index' of blend tree. Clamped to [0, 1] when the tree is evaluated.
+    void SetBlendParameter(int index, float value);
+
+    float GetBlendParameter(int index) const;
+
+    // Gets how bone rotations are interpolated between KeyFrames.
+    PoseBlend::RotationMode GetRotationMode();
+
+    // Sets how bone rotations are interpolated between KeyFrames. PoseBlend::RM_NLERP is cheaper.
+    void SetRotationMode(PoseBlend::RotationMode mode);
+
+    // Sets playing time of current animation. Wrapped into animation length.
+    void SetAnimationTime(float time);
+
+    float GetAnimationTime();
+
+    // Sets how fast animation plays. 1 is normal speed, negative plays backward.
+    void SetPlaybackRate(float rate);
+
+    float GetPlaybackRate();
+
+    // Makes playback time advance only in whole steps of 'timeStep' seconds; the remainder of elapsed time is carried to
+    // following updates. Playback time is then origin + step count * 'timeStep', which doesn't depend on how
+    // elapsed time was split into frames. Blend tree clip slots and crossfades advance by the same whole steps
+    // ( crossfade duration is then in playback time ). 0 advances by elapsed time as it is.
+    void SetFixedTimeStep(float timeStep);
+
+    float GetFixedTimeStep();
+
+    // Shares palette through PoseCache with other animators playing the same animation on the same skeleton.
+    // Playback is sampled at PoseCache time steps while enabled. Suits crowds of background characters.
+    void SetPoseCacheEnabled(bool enabled);
+
+    bool IsPoseCacheEnabled();
+
+    // Sets how often and how much of the skeleton Update() samples. Set by AnimationLod.
+    // Pose is sampled on frames where ( AnimationLod frame + 'phase' ) is a multiple of 'updateInterval'; never if it is 0.
+    // Bones deeper than 'maxBoneDepth' keep their last sampled local transform. Ignored while PoseCache is enabled.
+    void SetLod(int updateInterval, int maxBoneDepth, int phase);
+
+    // Plays palettes baked from an animation instead of sampling it; current animation becomes the one 'pBaked'
+    // was baked from. If 'blendFrames' is true palette is blended between the two baked frames surrounding playback time,
+    // otherwise the earlier frame is played as it is. LOD and PoseCache don't apply. nullptr goes back to sampling.
+    void SetBakedAnimation(std::shared_ptr<const BakedAnimation> pBaked, bool blendFrames);
+
+    std::shared_ptr<const BakedAnimation> GetBakedAnimation() const;
+
+    // Gets baked frames and blend factor selected by the last Update() of baked animation.
+    void GetBakedFrames(int& frame0, int& frame1, float& t) const;
+
+    // Makes Update() fill palette even while shader reads baked frames. Set while object is skinned on CPU.
+    void SetPaletteRequired(bool required);
+
+    // Computes palette of current animation at 'animationTime' for every bone of 'skeleton', regardless of LOD.
+    // Doesn't move playback time.
+    void Sample(const Skeleton& skeleton, float animationTime);
+
+    // Invoke every frame to play animation. 'dt' is seconds passed since the last frame.
+    void Update(Object& object, float dt);
+
+    // Update() for animator that isn't owned by an Object. Pose is sampled without palette if 'pSkeleton' is nullptr.
+    void Update(const Skeleton* pSkeleton, float dt);
+
+    // Gets skinning matrix per bone computed by the last Update(), indexed by bone index.
+    // nullptr until the first Update(). Not updated while playing baked animation that is uploaded, unless
+    // SetPaletteRequired(); shader reads baked frames from GetBakedFrames() instead.
+    const glm::mat4* GetPalette() const;
+
+    // Gets number of matrices GetPalette() points to.
+    int GetPaletteSize() const;
+
+    // Changes every time palette is written, so that users of the palette can tell it didn't change since they read it.
+    unsigned int GetPaletteVersion() const;
 
     void Serialize(std::ostream& os) const;
 
@@ -54,19 +149,154 @@ public:
     void CopyTo(Animator& dest);
 
 private:
+    // Where Serialize() writes current animation
+    enum AnimationSource : int
+    {
+        // Whole animation follows
+        AS_EMBEDDED,
+        // Clip library filename and clip name follow
+        AS_CLIP_LIBRARY,
+    };
+
+    // Clip bound to a slot of blend tree and its own playback state
+    struct ClipSlot
+    {
+        std::shared_ptr<Animation> pAnimation;
+        float time;
+        int keyFrameCursor;
+        // KeyFrame index the slot's registers hold. -1 if not decoded.
+        int prevPoseIndex;
+        int nextPoseIndex;
+    };
+
     // Currently playing animation.
     std::shared_ptr<Animation> m_currentAnimation;
 
     // Currently playing time of the animation
     float m_animationTime;
 
-    void IncreaseAnimationTime();
+    // Playback speed multiplier
+    float m_playbackRate;
+
+    // Fixed step playback. Disabled if m_fixedTimeStep is 0.
+    float m_fixedTimeStep;
+    // Elapsed time that didn't make a whole step yet
+    float m_timeAccumulator;
+    // Playback time when fixed step playback started or the time was set
+    float m_fixedStepOrigin;
+    // Steps taken from m_fixedStepOrigin
+    int64_t m_fixedStepCount;
+
+    // Index of the KeyFrame sampled last time. Lets Animation skip the search during forward playback.
+    int m_keyFrameCursor;
+
+    // Rotation interpolation used by CalcCurrentAnimationPose()
+    PoseBlend::RotationMode m_rotationMode;
+
+    bool m_poseCacheEnabled;
+
+    // Set by SetLod()
+    int m_updateInterval;
+    int m_maxBoneDepth;
+    int m_lodPhase;
+    // Sampling was due but skipped for frame budget. Sampled on the next Update(), even if over budget then.
+    bool m_posePending;
+
+    // Set by SetBakedAnimation()
+    std::shared_ptr<const BakedAnimation> m_pBakedAnimation;
+    bool m_bakedFrameBlend;
+    int m_bakedFrames[2];
+    float m_bakedFrameT;
+    bool m_paletteRequired;
+
+    // Set by SetBlendTree()
+    std::shared_ptr<const BlendTree> m_pBlendTree;
+    std::vector<ClipSlot> m_clipSlots;
+    std::vector<float> m_blendParameters;
+    // Pose registers of blend tree, sized to its register count and m_boneCount
+    PosePool m_posePool;
+    // Set by CrossfadeTo(). Crossfade is done when elapsed time reaches duration.
+    float m_crossfadeDuration;
+    float m_crossfadeElapsed;
+
+    // Indices of bones not deeper than m_maskedBoneDepth
+    std::vector<int> m_maskedBones;
+    // Depth m_maskedBones was built for. -1 if not built.
+    int m_maskedBoneDepth;
+
+    // KeyFrames decoded from current animation, surrounding m_animationTime.
+    // Kept across frames; a KeyFrame is decoded only when playback moves onto it.
+    Pose m_prevPose;
+    Pose m_nextPose;
+
+    // KeyFrame index m_prevPose/m_nextPose hold. -1 if not decoded.
+    int m_prevPoseIndex;
+    int m_nextPoseIndex;
+
+    // Number of bones m_matrices is sized for.
+    int m_boneCount;
+
+    // Increased whenever palette is written
+    unsigned int m_paletteVersion;
+
+    // Per instance pose state. Skeleton and Animation are shared between instances; this is the only part that isn't.
+    // Three arrays indexed by bone index in one allocation, kept across frames so that playback doesn't allocate.
+    //  [0, BoneCount)              : local transform of each bone sampled from current animation
+    //  [BoneCount, 2 * BoneCount)  : model space transform of each bone
+    //  [2 * BoneCount, 3 * BoneCount) : skinning matrix of each bone sent to shader( palette )
+    std::vector<glm::mat4> m_matrices;
+
+    glm::mat4* GetLocalTransforms();
+
+    glm::mat4* GetGlobalTransforms();
+
+    // Resizes scratch buffers to 'boneCount'. Returns true if buffers had to be resized.
+    bool PrepareBuffers(int boneCount);
+
+    void IncreaseAnimationTime(float dt);
+
+    // Selects baked frames for current playback time and unpacks them into palette unless shader reads them.
+    void UpdateBaked();
+
+    // Wraps 'time' into [0, animation length)
+    float WrapAnimationTime(double time);
+
+    // Restarts fixed step count from current playback time.
+    void ResetFixedStep();
+
+    // Samples local transform per bone at 'animationTime' into local transforms buffer.
+    // Only bones in m_maskedBones if 'masked' is true.
+    void CalcCurrentAnimationPose(float animationTime, bool masked);
+
+    // Builds m_maskedBones for m_maxBoneDepth. Returns true if the mask leaves out any bone.
+    bool UpdateBoneMask(const Skeleton& skeleton);
+
+    // Makes m_prevPose/m_nextPose hold KeyFrame 'prevIndex' and 'nextIndex' of current animation.
+    void DecodePoses(int prevIndex, int nextIndex);
+
+    // Bone count of clips bound to blend tree. 0 if none is bound.
+    int GetBlendTreeBoneCount() const;
+
+    // Sizes pose registers to m_boneCount, forgets decoded KeyFrames and decodes reference poses of bound clips.
+    void ResetBlendTreeBuffers();
+
+    // Decodes reference pose of clip slot 'slot' if blend tree uses it as additive layer and its bone count fits.
+    void DecodeReferencePose(int slot);
+
+    // Runs blend tree instructions and writes the resulting local transform per bone into local transforms buffer.
+    void EvaluateBlendTree();
+
+    // Samples clip slot 'slot' into 'target', keeping its KeyFrames decoded in registers 'source' and 'source' + 1.
+    void SampleClipSlot(int slot, int source, Pose& target);
 
-    std::map<std::string, glm::mat4> CalcCurrentAnimationPose();
+    // Advances clip slots by 'playbackDelta' seconds of playback and crossfade by 'crossfadeDelta' seconds.
+    void AdvanceBlendTree(float playbackDelta, float crossfadeDelta);
 
-    std::map<std::string, glm::mat4> InterpolatePoses(KeyFrame& prev, KeyFrame& next, float t);
+    // Forgets decoded KeyFrames. Call when current animation changes.
+    void InvalidatePoses();
 
-    void ApplyPoseToBones(std::map<std::string, glm::mat4>& pose, std::shared_ptr<Skeleton> pSkeleton);
+    // Computes model space transforms and palette from local transforms.
+    void ApplyPoseToBones(const Skeleton& skeleton);
 };
 
 #endif
@@ -0,0 +1,96 @@
+/*
+    AssetCooker.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    Dependencies:
+        FBX SDK 2019 - through FbxLoader
+
+    AssetCooker class implementation.
+*/
+#include "Common.h"
+#include "AssetCooker.h"
+#include "CookedAsset.h"
+#include "FbxLoader.h"
+#include "Object.h"
+#include "System.h"
+
+AssetCooker::AssetCooker(const std::vector<std::string>& sourceFilenames, bool force, int& failureCount)
+    : m_sourceFilenames(sourceFilenames)
+    , m_force(force)
+    , m_failureCount(failureCount)
+{
+    m_failureCount = 0;
+}
+
+void AssetCooker::OnStart()
+{
+    for (const std::string& sourceFilename : m_sourceFilenames)
+    {
+        const std::string CookedFilename = CookedAsset::GetCookedFilename(sourceFilename);
+        if (!m_force && CookedAsset::IsUpToDate(CookedFilename, CookedAsset::HashFile(sourceFilename)))
+        {
+            std::cout << CookedFilename << " is up to date" << std::endl;
+            continue;
+        }
+
+        std::vector<std::shared_ptr<Object>> objects;
+        const float StartTime = System::Instance()->CurrentTime();
+        if (Cook(sourceFilename, objects))
+        {
+            std::cout << "Cooked " << sourceFilename << " in " << System::Instance()->CurrentTime() - StartTime << " sec" << std::endl;
+        }
+        else
+        {
+            ++m_failureCount;
+        }
+
+        for (std::shared_ptr<Object>& pObject : objects)
+        {
+            pObject->Free();
+        }
+    }
+
+    System::Instance()->SetQuitFlag();
+}
+
+bool AssetCooker::Cook(const std::string& sourceFilename, std::vector<std::shared_ptr<Object>>& objects)
+{
+    const uint64_t SourceHash = CookedAsset::HashFile(sourceFilename);
+    if (SourceHash == 0)
+    {
+        std::cout << "AssetCooker::Cook() : can't read " << sourceFilename << std::endl;
+        return false;
+    }
+
+    FbxLoader loader;
+    loader.Load(sourceFilename.c_str());
+    std::vector<std::shared_ptr<Object>> loaded;
+    for (int i = 0; i < loader.GetObjectCount(); ++i)
+    {
+        loaded.push_back(loader.GetObjectByIndex(i));
+    }
+    if (loaded.empty())
+    {
+        std::cout << "AssetCooker::Cook() : no object in " << sourceFilename << std::endl;
+        return false;
+    }
+
+    objects.insert(objects.end(), loaded.begin(), loaded.end());
+    return CookedAsset::Write(CookedAsset::GetCookedFilename(sourceFilename), SourceHash, loaded);
+}
+
+bool AssetCooker::Load(const std::string& sourceFilename, std::vector<std::shared_ptr<Object>>& objects)
+{
+    const std::string CookedFilename = CookedAsset::GetCookedFilename(sourceFilename);
+    const uint64_t SourceHash = CookedAsset::HashFile(sourceFilename);
+    // Without its source a cooked asset is used as it is; builds may ship cooked assets only.
+    if ((SourceHash == 0 || CookedAsset::IsUpToDate(CookedFilename, SourceHash)) && CookedAsset::Read(CookedFilename, SourceHash, objects))
+        return true;
+
+    std::cout << "Cooking " << sourceFilename << std::endl;
+    // Objects just imported are used as they are even if writing the cooked asset fails.
+    const size_t CountBefore = objects.size();
+    Cook(sourceFilename, objects);
+    return objects.size() > CountBefore;
+}
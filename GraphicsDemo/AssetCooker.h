@@ -0,0 +1,55 @@
+/*
+    AssetCooker.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    Dependencies:
+        FBX SDK 2019 - through FbxLoader
+
+    AssetCooker class definition.
+*/
+#ifndef ASSET_COOKER_H_
+#define ASSET_COOKER_H_
+
+#include "SystemComponent.h"
+
+class Object;
+
+//
+// class AssetCooker
+//
+// Runs FbxLoader once per source asset and keeps the result as a CookedAsset next to the source,
+// so later runs skip FBX import, triangulation, attribute extraction and image decoding.
+//
+// Load() is what scenes call: it reads the cooked asset if it is up to date and cooks it first otherwise.
+// As a SystemComponent it is the command line cooker; it cooks the given sources once GL context is up( texture maps
+// are decoded into texture objects and read back ) and quits.
+//
+// usage:
+//  std::vector<std::shared_ptr<Object>> objects;
+//  AssetCooker::Load("./Resources/Punching Knight.fbx", objects);
+//  ...
+//  GraphicsDemo.exe -cook [-force] "Resources/Punching Knight.fbx" Resources/Terrain/Coast.fbx
+//
+class AssetCooker : public SystemComponent
+{
+public:
+    // Cooks 'sourceFilenames' on start. Sources whose cooked asset is up to date are skipped unless 'force' is true.
+    // Number of sources that failed to cook is written to 'failureCount', which outlives the component( System frees it ).
+    AssetCooker(const std::vector<std::string>& sourceFilenames, bool force, int& failureCount);
+
+    void OnStart() override;
+
+    // Imports 'sourceFilename' with FbxLoader and writes its objects to the cooked asset. Objects are appended to 'objects'.
+    static bool Cook(const std::string& sourceFilename, std::vector<std::shared_ptr<Object>>& objects);
+
+    // Appends objects of 'sourceFilename' to 'objects', from its cooked asset if it is up to date, cooking it otherwise.
+    static bool Load(const std::string& sourceFilename, std::vector<std::shared_ptr<Object>>& objects);
+
+private:
+    std::vector<std::string> m_sourceFilenames;
+    bool m_force;
+    int& m_failureCount;
+};
+
+#endif
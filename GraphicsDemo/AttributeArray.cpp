@@ -38,7 +38,7 @@ AttributeArray::AttributeArray(int size, GLenum type, int stride, const void* of
 {
 }
 
-void AttributeArray::Fill(GLsizeiptr size, void * data)
+void AttributeArray::Fill(GLsizeiptr size, const void * data, GLenum usage)
 {
     if (m_bo == 0)
     {
@@ -49,19 +49,37 @@ void AttributeArray::Fill(GLsizeiptr size, void * data)
     glBindBuffer(GL_ARRAY_BUFFER, m_bo);
     GET_AND_HANDLE_GL_ERROR();
 
-    glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, size, data, usage);
     GET_AND_HANDLE_GL_ERROR();
 
     m_attributeCount = static_cast<int>(m_stride == 0 ? (size / GLEnumTypeToSize(m_type)) : (size / m_stride));
 }
 
+void AttributeArray::GetData(std::vector<char>& out)
+{
+    out.clear();
+    if (m_bo == 0)
+        return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_bo);
+    GET_AND_HANDLE_GL_ERROR();
+
+    GLint size = 0;
+    glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &size);
+    GET_AND_HANDLE_GL_ERROR();
+
+    out.resize(size);
+    glGetBufferSubData(GL_ARRAY_BUFFER, 0, size, out.data());
+    GET_AND_HANDLE_GL_ERROR();
+}
+
 void AttributeArray::VertexAttribPointer(int index, GLboolean normalized)
 {
     
     glBindBuffer(GL_ARRAY_BUFFER, m_bo);
     GET_AND_HANDLE_GL_ERROR();
-    if (m_type == GL_INT || m_type == GL_SHORT || m_type == GL_BYTE
-      || m_type == GL_UNSIGNED_INT || m_type == GL_UNSIGNED_SHORT || m_type == GL_UNSIGNED_BYTE)
+    if (!normalized && (m_type == GL_INT || m_type == GL_SHORT || m_type == GL_BYTE
+      || m_type == GL_UNSIGNED_INT || m_type == GL_UNSIGNED_SHORT || m_type == GL_UNSIGNED_BYTE))
     {
         glVertexAttribIPointer(index, m_size, m_type, m_stride, reinterpret_cast<const void*>(m_offset));
     }
@@ -89,6 +107,16 @@ int AttributeArray::GetAttributeCount()
     return m_attributeCount;
 }
 
+int AttributeArray::GetSize() const
+{
+    return m_size;
+}
+
+GLenum AttributeArray::GetType() const
+{
+    return m_type;
+}
+
 namespace
 {
     void SerializeBufferObject(std::ostream& os, GLuint bo)
@@ -25,14 +25,29 @@ public:
 
     AttributeArray(int size, GLenum type, int stride, const void* offset);
 
-    void Fill(GLsizeiptr size, void* data);
+    // 'usage' is GL_STATIC_DRAW for data filled once, GL_STREAM_DRAW for data refilled every frame.
+    void Fill(GLsizeiptr size, const void* data, GLenum usage = GL_STATIC_DRAW);
 
+    // Reads buffer contents back from GPU into 'out'.
+    void GetData(std::vector<char>& out);
+
+    // Reads buffer contents back from GPU into 'out' as elements of 'T'. Bytes that don't make a whole element are dropped.
+    template <typename T>
+    void GetData(std::vector<T>& out);
+
+    // Integer types are read as integers unless 'normalized' is GL_TRUE, in which case they are read as [0, 1] floats.
     void VertexAttribPointer(int index, GLboolean normalized);
 
     void Free();
 
     int GetAttributeCount();
 
+    // Number of components per attribute
+    int GetSize() const;
+
+    // Type of components
+    GLenum GetType() const;
+
     void Serialize(std::ostream& os);
 
     void Deserialize(std::istream& is);
@@ -46,4 +61,16 @@ private:
     int m_attributeCount;
 };
 
+template <typename T>
+void AttributeArray::GetData(std::vector<T>& out)
+{
+    std::vector<char> bytes;
+    GetData(bytes);
+    out.resize(bytes.size() / sizeof(T));
+    if (!out.empty())
+    {
+        std::memcpy(out.data(), bytes.data(), out.size() * sizeof(T));
+    }
+}
+
 #endif
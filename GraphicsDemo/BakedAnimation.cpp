@@ -0,0 +1,277 @@
+/*
+    BakedAnimation.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    Dependencies :
+        glm - matrix representation, half float packing
+        glad - texture buffer
+
+    BakedAnimation class implementation.
+*/
+#include "Common.h"
+#include "BakedAnimation.h"
+#include "Animation.h"
+#include "Animator.h"
+#include "Skeleton.h"
+#ifndef GD_HEADLESS
+#include "Errors.h"
+#endif
+
+namespace
+{
+    // RGBA texels per bone in texture buffer
+    const int TexelsPerBone = 3;
+}
+
+std::shared_ptr<BakedAnimation> BakedAnimation::Bake(const std::shared_ptr<Animation>& pAnimation, const std::shared_ptr<const Skeleton>& pSkeleton,
+    float frameRate, PoseBlend::RotationMode rotationMode, Precision precision)
+{
+    assert(pAnimation && pSkeleton);
+    assert(frameRate > 0.0f);
+    assert(pAnimation->IsBoundTo(*pSkeleton));
+
+    std::shared_ptr<BakedAnimation> pBaked(new BakedAnimation);
+    pBaked->m_pSourceAnimation = pAnimation;
+    pBaked->m_pSkeleton = pSkeleton;
+    pBaked->m_boneCount = pSkeleton->GetBoneCount();
+    pBaked->m_length = pAnimation->GetLength();
+    pBaked->m_frameCount = std::max(1, static_cast<int>(std::round(pBaked->m_length * frameRate)));
+    pBaked->m_frameRate = pBaked->m_length > 0.0f ? pBaked->m_frameCount / pBaked->m_length : frameRate;
+    pBaked->m_precision = precision;
+
+    const size_t ValueCount = static_cast<size_t>(pBaked->m_frameCount) * pBaked->m_boneCount * FloatsPerBone;
+    if (precision == BP_FLOAT)
+    {
+        pBaked->m_floats.resize(ValueCount);
+    }
+    else
+    {
+        pBaked->m_halves.resize(ValueCount);
+    }
+
+    // Sampled by the same code live playback uses, so baked palettes match what Animator would have computed.
+    Animator animator;
+    animator.SetCurrentAnimation(pAnimation);
+    animator.SetRotationMode(rotationMode);
+    for (int i = 0; i < pBaked->m_frameCount; ++i)
+    {
+        animator.Sample(*pSkeleton, i / pBaked->m_frameRate);
+        pBaked->StoreFrame(i, animator.GetPalette());
+    }
+
+    return pBaked;
+}
+
+BakedAnimation::BakedAnimation()
+    : m_pSourceAnimation()
+    , m_pSkeleton()
+    , m_frameCount(0)
+    , m_boneCount(0)
+    , m_frameRate(0.0f)
+    , m_length(0.0f)
+    , m_precision(BP_FLOAT)
+    , m_floats()
+    , m_halves()
+    , m_buffer(0)
+    , m_texture(0)
+{
+}
+
+std::shared_ptr<Animation> BakedAnimation::GetSourceAnimation() const
+{
+    return m_pSourceAnimation;
+}
+
+const Skeleton* BakedAnimation::GetSkeleton() const
+{
+    return m_pSkeleton.get();
+}
+
+int BakedAnimation::GetFrameCount() const
+{
+    return m_frameCount;
+}
+
+int BakedAnimation::GetBoneCount() const
+{
+    return m_boneCount;
+}
+
+float BakedAnimation::GetFrameRate() const
+{
+    return m_frameRate;
+}
+
+float BakedAnimation::GetLength() const
+{
+    return m_length;
+}
+
+BakedAnimation::Precision BakedAnimation::GetPrecision() const
+{
+    return m_precision;
+}
+
+size_t BakedAnimation::GetDataSize() const
+{
+    return m_floats.size() * sizeof(float) + m_halves.size() * sizeof(uint16_t);
+}
+
+void BakedAnimation::FindFrames(float time, int& frame0, int& frame1, float& t) const
+{
+    const float Frame = time * m_frameRate;
+    const float Whole = std::floor(Frame);
+    frame0 = static_cast<int>(Whole) % m_frameCount;
+    if (frame0 < 0)
+    {
+        frame0 += m_frameCount;
+    }
+    frame1 = frame0 + 1 < m_frameCount ? frame0 + 1 : 0;
+    t = Frame - Whole;
+}
+
+void BakedAnimation::UnpackFrame(int frame, glm::mat4* pOut) const
+{
+    UnpackFrames(frame, frame, 0.0f, pOut);
+}
+
+void BakedAnimation::UnpackFrames(int frame0, int frame1, float t, glm::mat4* pOut) const
+{
+    assert(0 <= frame0 && frame0 < m_frameCount);
+    assert(0 <= frame1 && frame1 < m_frameCount);
+
+    const bool Blend = frame0 != frame1 && t > 0.0f;
+    float a[FloatsPerBone];
+    float b[FloatsPerBone];
+    for (int i = 0; i < m_boneCount; ++i)
+    {
+        LoadBone(frame0, i, a);
+        if (Blend)
+        {
+            LoadBone(frame1, i, b);
+            for (int j = 0; j < FloatsPerBone; ++j)
+            {
+                a[j] += (b[j] - a[j]) * t;
+            }
+        }
+
+        // Rows back to columns
+        glm::mat4& m = pOut[i];
+        for (int row = 0; row < 3; ++row)
+        {
+            for (int col = 0; col < 4; ++col)
+            {
+                m[col][row] = a[row * 4 + col];
+            }
+        }
+        m[0][3] = 0.0f;
+        m[1][3] = 0.0f;
+        m[2][3] = 0.0f;
+        m[3][3] = 1.0f;
+    }
+}
+
+void BakedAnimation::Upload()
+{
+    if (m_texture != 0)
+        return;
+
+#ifndef GD_HEADLESS
+    GLint maxTexelCount = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexelCount);
+    GET_AND_HANDLE_GL_ERROR();
+    const int TexelCount = m_frameCount * m_boneCount * TexelsPerBone;
+    if (TexelCount > maxTexelCount)
+    {
+        std::cout << "BakedAnimation::Upload() : " << TexelCount << " texels exceed texture buffer limit " << maxTexelCount << std::endl;
+        return;
+    }
+
+    glGenBuffers(1, &m_buffer);
+    GET_AND_HANDLE_GL_ERROR();
+    glBindBuffer(GL_TEXTURE_BUFFER, m_buffer);
+    GET_AND_HANDLE_GL_ERROR();
+    const void* pData = m_precision == BP_FLOAT ? static_cast<const void*>(m_floats.data()) : static_cast<const void*>(m_halves.data());
+    glBufferData(GL_TEXTURE_BUFFER, GetDataSize(), pData, GL_STATIC_DRAW);
+    GET_AND_HANDLE_GL_ERROR();
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    GET_AND_HANDLE_GL_ERROR();
+
+    glGenTextures(1, &m_texture);
+    GET_AND_HANDLE_GL_ERROR();
+    glBindTexture(GL_TEXTURE_BUFFER, m_texture);
+    GET_AND_HANDLE_GL_ERROR();
+    glTexBuffer(GL_TEXTURE_BUFFER, m_precision == BP_FLOAT ? GL_RGBA32F : GL_RGBA16F, m_buffer);
+    GET_AND_HANDLE_GL_ERROR();
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    GET_AND_HANDLE_GL_ERROR();
+#endif
+}
+
+GLuint BakedAnimation::GetTexture() const
+{
+    return m_texture;
+}
+
+void BakedAnimation::Free()
+{
+#ifndef GD_HEADLESS
+    if (m_texture)
+    {
+        glDeleteTextures(1, &m_texture);
+        GET_AND_HANDLE_GL_ERROR();
+        m_texture = 0;
+    }
+
+    if (m_buffer)
+    {
+        glDeleteBuffers(1, &m_buffer);
+        GET_AND_HANDLE_GL_ERROR();
+        m_buffer = 0;
+    }
+#endif
+}
+
+void BakedAnimation::StoreFrame(int frame, const glm::mat4* pPalette)
+{
+    const size_t FrameOffset = static_cast<size_t>(frame) * m_boneCount * FloatsPerBone;
+    for (int i = 0; i < m_boneCount; ++i)
+    {
+        const glm::mat4& m = pPalette[i];
+        // Bottom row of an affine matrix is always ( 0, 0, 0, 1 )
+        assert(std::abs(m[3][3] - 1.0f) < 1e-4f);
+        const size_t BoneOffset = FrameOffset + static_cast<size_t>(i) * FloatsPerBone;
+        for (int row = 0; row < 3; ++row)
+        {
+            for (int col = 0; col < 4; ++col)
+            {
+                const float Value = m[col][row];
+                if (m_precision == BP_FLOAT)
+                {
+                    m_floats[BoneOffset + row * 4 + col] = Value;
+                }
+                else
+                {
+                    m_halves[BoneOffset + row * 4 + col] = glm::packHalf1x16(Value);
+                }
+            }
+        }
+    }
+}
+
+void BakedAnimation::LoadBone(int frame, int bone, float* pOut) const
+{
+    const size_t Offset = (static_cast<size_t>(frame) * m_boneCount + bone) * FloatsPerBone;
+    if (m_precision == BP_FLOAT)
+    {
+        std::memcpy(pOut, &m_floats[Offset], sizeof(float) * FloatsPerBone);
+    }
+    else
+    {
+        for (int i = 0; i < FloatsPerBone; ++i)
+        {
+            pOut[i] = glm::unpackHalf1x16(m_halves[Offset + i]);
+        }
+    }
+}
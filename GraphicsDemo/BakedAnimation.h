@@ -0,0 +1,118 @@
+/*
+    BakedAnimation.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    Dependencies :
+        glm - matrix representation, half float packing
+        glad - texture buffer
+
+    BakedAnimation class definition.
+*/
+#ifndef BAKED_ANIMATION_H_
+#define BAKED_ANIMATION_H_
+
+#include "PoseBlend.h"
+
+class Animation;
+class Skeleton;
+
+//
+// class BakedAnimation
+//
+// Skinning palette of every frame of a looping Animation, sampled at a fixed frame rate ahead of time.
+// Playing it back is an index and an optional blend between two neighbouring frames; no KeyFrame decoding,
+// no interpolation of bone transforms and no hierarchy evaluation. Trades memory for CPU, which suits
+// crowds of background characters that only loop a clip.
+//
+// Each skinning matrix is affine, so only its top three rows are stored( 3x4, row-major ),
+// either in 32 bit floats or in 16 bit halves.
+// The same layout can be uploaded once as a texture buffer of RGBA texels, three texels per bone,
+// so that shader reads the palette of a frame directly and instances only send frame indices.
+//
+// usage:
+//  std::shared_ptr<BakedAnimation> pBaked = BakedAnimation::Bake(*pAnimation, pSkeleton, 30.0f, PoseBlend::RM_SLERP, BakedAnimation::BP_HALF);
+//  pBaked->Upload(); // optional. Lets shader index into the baked palettes.
+//  animator.SetBakedAnimation(pBaked, true);
+//  ...
+//  pBaked->Free(); // before GL context is destroyed
+//
+class BakedAnimation
+{
+public:
+    enum Precision
+    {
+        BP_FLOAT,
+        BP_HALF,
+    };
+
+    // Number of floats each bone takes in a frame
+    static const int FloatsPerBone = 12;
+
+    // Samples palette of 'animation' on 'pSkeleton' every 1 / 'frameRate' seconds.
+    // Frame rate is adjusted so that whole number of frames fits in animation length, so the clip loops seamlessly.
+    static std::shared_ptr<BakedAnimation> Bake(const std::shared_ptr<Animation>& pAnimation, const std::shared_ptr<const Skeleton>& pSkeleton,
+        float frameRate, PoseBlend::RotationMode rotationMode, Precision precision);
+
+    BakedAnimation();
+
+    // Animation this was baked from
+    std::shared_ptr<Animation> GetSourceAnimation() const;
+
+    const Skeleton* GetSkeleton() const;
+
+    int GetFrameCount() const;
+
+    int GetBoneCount() const;
+
+    // Frames per second after adjustment in Bake()
+    float GetFrameRate() const;
+
+    float GetLength() const;
+
+    Precision GetPrecision() const;
+
+    // Bytes taken by baked palettes in system memory
+    size_t GetDataSize() const;
+
+    // Finds the two frames surrounding 'time' and how far 'time' is from 'frame0' to 'frame1'. Wraps to the first frame
+    // after the last.
+    void FindFrames(float time, int& frame0, int& frame1, float& t) const;
+
+    // Writes palette of 'frame' to 'pOut' sized to GetBoneCount().
+    void UnpackFrame(int frame, glm::mat4* pOut) const;
+
+    // Writes palette blended linearly from 'frame0' to 'frame1' by 't' to 'pOut' sized to GetBoneCount().
+    void UnpackFrames(int frame0, int frame1, float t, glm::mat4* pOut) const;
+
+    // Creates texture buffer holding every frame. Texel index of bone 'b' of frame 'f' is ( f * GetBoneCount() + b ) * 3.
+    void Upload();
+
+    // Texture buffer created by Upload(). 0 if not uploaded.
+    GLuint GetTexture() const;
+
+    void Free();
+
+private:
+    std::shared_ptr<Animation> m_pSourceAnimation;
+    std::shared_ptr<const Skeleton> m_pSkeleton;
+    int m_frameCount;
+    int m_boneCount;
+    float m_frameRate;
+    float m_length;
+    Precision m_precision;
+
+    // Frames one after another; bones one after another in a frame; 12 values per bone. One of the two is used.
+    std::vector<float> m_floats;
+    std::vector<uint16_t> m_halves;
+
+    GLuint m_buffer;
+    GLuint m_texture;
+
+    void StoreFrame(int frame, const glm::mat4* pPalette);
+
+    // Reads 12 values of bone 'bone' in 'frame'
+    void LoadBone(int frame, int bone, float* pOut) const;
+};
+
+#endif
@@ -0,0 +1,369 @@
+/*
+    Benchmark.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    Micro benchmark implementation.
+*/
+#include "Common.h"
+#include "Benchmark.h"
+#include "Animation.h"
+#include "PoseBlend.h"
+#include "Object.h"
+#include "Scene.h"
+#include "JobSystem.h"
+#include "PoseCache.h"
+
+namespace
+{
+    typedef std::function<void(const Pose&, const Pose&, float, glm::mat4*)> InterpolateFunction;
+
+    // Keeps optimizer from dropping benchmark loops.
+    volatile float s_sink;
+
+    // Path Animator took before PoseBlend; interpolates and builds matrix bone by bone.
+    void InterpolatePerBone(const Pose& a, const Pose& b, float t, glm::mat4* pOut)
+    {
+        const int BoneCount = a.GetBoneCount();
+        for (int i = 0; i < BoneCount; ++i)
+        {
+            BoneTransform transformA = a.GetBoneTransform(i);
+            BoneTransform transformB = b.GetBoneTransform(i);
+            pOut[i] = BoneTransform::Interpolate(transformA, transformB, t).GetTransformMatrix();
+        }
+    }
+
+    // Interpolation factor used for 'index'th KeyFrame pair. Spread over [0, 1) so slerp takes every branch.
+    float GetSampleFactor(int index)
+    {
+        return (index % 7 + 0.5f) / 7.0f;
+    }
+
+    float MaxDifference(const glm::mat4* pLhs, const glm::mat4* pRhs, int count)
+    {
+        float maxDifference = 0.0f;
+        for (int i = 0; i < count; ++i)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                for (int r = 0; r < 4; ++r)
+                {
+                    maxDifference = std::max(maxDifference, std::abs(pLhs[i][c][r] - pRhs[i][c][r]));
+                }
+            }
+        }
+        return maxDifference;
+    }
+
+    // Animation time difference between neighbouring copies, so they don't sample the same frame.
+    const float CopyTimeStagger = 0.37f;
+
+    // Copies play at 'phaseCount' different times; copies with the same phase play in lockstep.
+    std::shared_ptr<Scene> CreateCopyScene(Object& source, int instanceCount, int phaseCount, bool poseCacheEnabled)
+    {
+        std::shared_ptr<Scene> pScene(new Scene);
+        for (int i = 0; i < instanceCount; ++i)
+        {
+            std::shared_ptr<Object> pObject(new Object);
+            source.CopyTo(*pObject);
+            if (pObject->GetAnimator())
+            {
+                pObject->GetAnimator()->SetAnimationTime((i % phaseCount) * CopyTimeStagger);
+                pObject->GetAnimator()->SetPoseCacheEnabled(poseCacheEnabled);
+            }
+            pScene->AddSceneObject(pObject);
+        }
+        return pScene;
+    }
+
+    bool HasSamePalettes(Scene& lhs, Scene& rhs)
+    {
+        assert(lhs.GetSceneObjectCount() == rhs.GetSceneObjectCount());
+        for (int i = 0; i < lhs.GetSceneObjectCount(); ++i)
+        {
+            std::shared_ptr<Animator> pLhs = lhs.GetSceneObject(i)->GetAnimator();
+            std::shared_ptr<Animator> pRhs = rhs.GetSceneObject(i)->GetAnimator();
+            if (!pLhs || !pRhs)
+                continue;
+            if (pLhs->GetPaletteSize() != pRhs->GetPaletteSize())
+                return false;
+            if (std::memcmp(pLhs->GetPalette(), pRhs->GetPalette(), sizeof(glm::mat4) * pLhs->GetPaletteSize()) != 0)
+                return false;
+        }
+        return true;
+    }
+
+    // Decodes every KeyFrame of 'animation' up front, so interpolation is measured without decoding.
+    std::vector<Pose> DecodeAllPoses(const Animation& animation)
+    {
+        std::vector<Pose> poses(animation.GetKeyFrameCount(), Pose(animation.GetBoneCount()));
+        for (int k = 0; k < animation.GetKeyFrameCount(); ++k)
+        {
+            animation.DecodePose(k, poses[k]);
+        }
+        return poses;
+    }
+
+    void MeasureDecode(const Animation& animation, int iterations, std::ostream& os)
+    {
+        const int BoneCount = animation.GetBoneCount();
+        const int KeyFrameCount = animation.GetKeyFrameCount();
+        Pose pose(BoneCount);
+
+        float sink = 0.0f;
+        const auto Begin = std::chrono::high_resolution_clock::now();
+        for (int iteration = 0; iteration < iterations; ++iteration)
+        {
+            for (int k = 0; k < KeyFrameCount; ++k)
+            {
+                animation.DecodePose(k, pose);
+                sink += pose.GetRotations()[k % BoneCount].w;
+            }
+        }
+        const auto End = std::chrono::high_resolution_clock::now();
+        s_sink = sink;
+
+        const double Nanoseconds = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(End - Begin).count());
+        const double BoneSamples = static_cast<double>(iterations) * KeyFrameCount * BoneCount;
+        os << std::left << std::setw(28) << "Animation::DecodePose" << std::right
+            << std::fixed << std::setprecision(2) << std::setw(8) << Nanoseconds / BoneSamples << " ns/bone"
+            << std::defaultfloat << std::endl;
+    }
+
+    // Frame time scenes are updated with. Fixed so that every run plays the same frames.
+    const float FrameTime = 1.0f / 60.0f;
+
+    // Average milliseconds Scene::Update() takes
+    double MeasureSceneUpdate(Scene& scene, int frameCount)
+    {
+        // First update sizes Animator buffers; leave it out of timing.
+        scene.Update(FrameTime);
+        const auto Begin = std::chrono::high_resolution_clock::now();
+        for (int frame = 1; frame < frameCount; ++frame)
+        {
+            scene.Update(FrameTime);
+        }
+        const auto End = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(End - Begin).count() / std::max(frameCount - 1, 1);
+    }
+
+    typedef std::function<void(const CpuSkinning::Source&, const glm::mat4*, int, int, CpuSkinning::Output&)> SkinFunction;
+
+    // Skins every output 'iterations' times and returns nanoseconds per vertex.
+    double MeasureSkinning(const CpuSkinning::Source& source, const glm::mat4* pPalette, std::vector<CpuSkinning::Output>& outputs,
+        int iterations, const SkinFunction& function)
+    {
+        const auto Begin = std::chrono::high_resolution_clock::now();
+        for (int iteration = 0; iteration < iterations; ++iteration)
+        {
+            for (CpuSkinning::Output& output : outputs)
+            {
+                function(source, pPalette, 0, source.vertexCount, output);
+            }
+        }
+        const auto End = std::chrono::high_resolution_clock::now();
+        const double Nanoseconds = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(End - Begin).count());
+        return Nanoseconds / (static_cast<double>(iterations) * outputs.size() * std::max(source.vertexCount, 1));
+    }
+
+    float MaxDifference(const std::vector<float>& lhs, const std::vector<float>& rhs)
+    {
+        assert(lhs.size() == rhs.size());
+        float maxDifference = 0.0f;
+        for (size_t i = 0; i < lhs.size(); ++i)
+        {
+            maxDifference = std::max(maxDifference, std::abs(lhs[i] - rhs[i]));
+        }
+        return maxDifference;
+    }
+
+    void Measure(const std::vector<Pose>& poses, int iterations, const char* const label, const InterpolateFunction& function, std::ostream& os)
+    {
+        const int BoneCount = poses.front().GetBoneCount();
+        const int PairCount = static_cast<int>(poses.size()) - 1;
+        std::vector<glm::mat4> result(BoneCount);
+        std::vector<glm::mat4> reference(BoneCount);
+
+        float maxError = 0.0f;
+        for (int k = 0; k < PairCount; ++k)
+        {
+            const Pose& A = poses[k];
+            const Pose& B = poses[k + 1];
+            InterpolatePerBone(A, B, GetSampleFactor(k), reference.data());
+            function(A, B, GetSampleFactor(k), result.data());
+            maxError = std::max(maxError, MaxDifference(result.data(), reference.data(), BoneCount));
+        }
+
+        float sink = 0.0f;
+        const auto Begin = std::chrono::high_resolution_clock::now();
+        for (int iteration = 0; iteration < iterations; ++iteration)
+        {
+            for (int k = 0; k < PairCount; ++k)
+            {
+                function(poses[k], poses[k + 1], GetSampleFactor(k), result.data());
+                sink += result[k % BoneCount][3][0];
+            }
+        }
+        const auto End = std::chrono::high_resolution_clock::now();
+        s_sink = sink;
+
+        const double Nanoseconds = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(End - Begin).count());
+        const double BoneSamples = static_cast<double>(iterations) * PairCount * BoneCount;
+        os << std::left << std::setw(28) << label << std::right
+            << std::fixed << std::setprecision(2) << std::setw(8) << Nanoseconds / BoneSamples << " ns/bone"
+            << "  max error " << std::scientific << std::setprecision(2) << maxError
+            << std::defaultfloat << std::endl;
+    }
+}
+
+void BenchmarkPoseBlend(Animation& animation, std::ostream& os, int iterations)
+{
+    const int BoneCount = animation.GetBoneCount();
+    if (animation.GetKeyFrameCount() < 2 || BoneCount == 0)
+    {
+        os << "BenchmarkPoseBlend() : '" << animation.GetName() << "' has nothing to interpolate" << std::endl;
+        return;
+    }
+
+    os << "Pose blend benchmark : '" << animation.GetName() << "' "
+        << BoneCount << " bones, "
+        << animation.GetKeyFrameCount() << " keyframes, "
+        << iterations << " iterations, SIMD " << (PoseBlend::IsSimdEnabled() ? "on" : "off") << std::endl;
+    os << "pose data " << animation.GetPoseDataSize() << " bytes, " << animation.GetTrackKeyCount() << " track keys"
+        << (animation.IsCompressed() ? ", compressed" : ", raw")
+        << ", max error " << animation.GetMaxRotationError() << " rad, " << animation.GetMaxTranslationError() << std::endl;
+
+    MeasureDecode(animation, iterations, os);
+
+    const std::vector<Pose> Poses = DecodeAllPoses(animation);
+    Measure(Poses, iterations, "per-bone slerp", InterpolatePerBone, os);
+    Measure(Poses, iterations, "PoseBlend scalar slerp",
+        [](const Pose& a, const Pose& b, float t, glm::mat4* pOut) { PoseBlend::InterpolateToMatricesScalar(a, b, t, PoseBlend::RM_SLERP, pOut); }, os);
+    Measure(Poses, iterations, "PoseBlend batch slerp",
+        [](const Pose& a, const Pose& b, float t, glm::mat4* pOut) { PoseBlend::InterpolateToMatrices(a, b, t, PoseBlend::RM_SLERP, pOut); }, os);
+    Measure(Poses, iterations, "PoseBlend scalar nlerp",
+        [](const Pose& a, const Pose& b, float t, glm::mat4* pOut) { PoseBlend::InterpolateToMatricesScalar(a, b, t, PoseBlend::RM_NLERP, pOut); }, os);
+    Measure(Poses, iterations, "PoseBlend batch nlerp",
+        [](const Pose& a, const Pose& b, float t, glm::mat4* pOut) { PoseBlend::InterpolateToMatrices(a, b, t, PoseBlend::RM_NLERP, pOut); }, os);
+}
+
+void BenchmarkAnimationUpdate(Object& source, int instanceCount, std::ostream& os, int frameCount)
+{
+    JobSystem* pJobSystem = JobSystem::Instance();
+    const int DefaultWorkerCount = JobSystem::GetDefaultWorkerCount();
+
+    // 0 workers first; it is the serial reference for the others.
+    std::vector<int> workerCounts;
+    for (int workerCount = 0; workerCount < DefaultWorkerCount; workerCount = workerCount * 2 + 1)
+    {
+        workerCounts.push_back(workerCount);
+    }
+    workerCounts.push_back(DefaultWorkerCount);
+
+    os << "Animation update benchmark : " << instanceCount << " copies, " << frameCount << " frames" << std::endl;
+
+    std::shared_ptr<Scene> pReference;
+    double serialMilliseconds = 0.0;
+    for (int workerCount : workerCounts)
+    {
+        pJobSystem->SetWorkerCount(workerCount);
+        std::shared_ptr<Scene> pScene = CreateCopyScene(source, instanceCount, instanceCount, false);
+        const double Milliseconds = MeasureSceneUpdate(*pScene, frameCount);
+
+        if (!pReference)
+        {
+            pReference = pScene;
+            serialMilliseconds = Milliseconds;
+        }
+
+        os << std::setw(3) << workerCount + 1 << " threads : "
+            << std::fixed << std::setprecision(3) << std::setw(9) << Milliseconds << " ms/frame  x"
+            << std::setprecision(2) << serialMilliseconds / Milliseconds
+            << (HasSamePalettes(*pReference, *pScene) ? "  identical" : "  MISMATCH")
+            << std::defaultfloat << std::endl;
+    }
+
+    pJobSystem->SetWorkerCount(DefaultWorkerCount);
+}
+
+void BenchmarkPoseCache(Object& source, int instanceCount, int phaseCount, std::ostream& os, int frameCount)
+{
+    PoseCache* pPoseCache = PoseCache::Instance();
+    os << "Pose cache benchmark : " << instanceCount << " copies in " << phaseCount << " phases, " << frameCount << " frames, "
+        << JobSystem::Instance()->GetWorkerCount() + 1 << " threads" << std::endl;
+
+    const double UncachedMilliseconds = MeasureSceneUpdate(*CreateCopyScene(source, instanceCount, phaseCount, false), frameCount);
+
+    pPoseCache->Clear();
+    pPoseCache->ResetCounters();
+    std::shared_ptr<Scene> pScene = CreateCopyScene(source, instanceCount, phaseCount, true);
+    const double CachedMilliseconds = MeasureSceneUpdate(*pScene, frameCount);
+    const int HitCount = pPoseCache->GetHitCount();
+    const int MissCount = pPoseCache->GetMissCount();
+
+    os << std::fixed << std::setprecision(3)
+        << "no cache   : " << std::setw(9) << UncachedMilliseconds << " ms/frame" << std::endl
+        << "pose cache : " << std::setw(9) << CachedMilliseconds << " ms/frame  x"
+        << std::setprecision(2) << UncachedMilliseconds / CachedMilliseconds << std::endl
+        << std::defaultfloat
+        << "hits " << HitCount << ", misses " << MissCount
+        << ", hit rate " << 100.0 * HitCount / std::max(HitCount + MissCount, 1) << "%"
+        << ", " << pPoseCache->GetEntryCount() << " palettes cached" << std::endl;
+
+    pScene.reset();
+    pPoseCache->Clear();
+}
+
+void BenchmarkCpuSkinning(const CpuSkinning::Source& source, const glm::mat4* pPalette, int instanceCount, std::ostream& os, int iterations)
+{
+    instanceCount = std::max(instanceCount, 1);
+    os << "CPU skinning benchmark : " << instanceCount << " copies of " << source.vertexCount << " vertices, "
+        << iterations << " iterations" << (CpuSkinning::IsSimdEnabled() ? "" : " (SSE disabled)") << std::endl;
+
+    std::vector<CpuSkinning::Output> outputs(instanceCount);
+    for (CpuSkinning::Output& output : outputs)
+    {
+        output.Resize(source);
+    }
+
+    // Scalar kernel does what the shader does; reference for the others.
+    const double ScalarNanoseconds = MeasureSkinning(source, pPalette, outputs, iterations, CpuSkinning::SkinRangeScalar);
+    const CpuSkinning::Output Reference = outputs.front();
+
+    const double SimdNanoseconds = MeasureSkinning(source, pPalette, outputs, iterations, CpuSkinning::SkinRange);
+    const CpuSkinning::Output Serial = outputs.front();
+    const float MaxError = std::max(MaxDifference(Serial.positions, Reference.positions),
+        std::max(MaxDifference(Serial.normals, Reference.normals), MaxDifference(Serial.tangents, Reference.tangents)));
+
+    // Every copy split into vertex ranges, the way Scene::Update() runs it.
+    const int VerticesPerJob = 4096;
+    const int RangesPerCopy = std::max((source.vertexCount + VerticesPerJob - 1) / VerticesPerJob, 1);
+    JobSystem* pJobSystem = JobSystem::Instance();
+    const auto Begin = std::chrono::high_resolution_clock::now();
+    for (int iteration = 0; iteration < iterations; ++iteration)
+    {
+        pJobSystem->ParallelFor(instanceCount * RangesPerCopy, 1, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                const int Range = i % RangesPerCopy;
+                CpuSkinning::SkinRange(source, pPalette, Range * VerticesPerJob,
+                    std::min((Range + 1) * VerticesPerJob, source.vertexCount), outputs[i / RangesPerCopy]);
+            }
+        });
+    }
+    const auto End = std::chrono::high_resolution_clock::now();
+    const double ParallelNanoseconds = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(End - Begin).count())
+        / (static_cast<double>(iterations) * instanceCount * std::max(source.vertexCount, 1));
+    const bool Identical = outputs.front().positions == Serial.positions
+        && outputs.front().normals == Serial.normals
+        && outputs.front().tangents == Serial.tangents;
+
+    os << std::fixed << std::setprecision(2)
+        << "scalar     : " << std::setw(8) << ScalarNanoseconds << " ns/vertex" << std::endl
+        << "sse        : " << std::setw(8) << SimdNanoseconds << " ns/vertex  x" << ScalarNanoseconds / SimdNanoseconds
+        << "  max error " << std::scientific << MaxError << std::fixed << std::endl
+        << "sse x " << std::setw(2) << pJobSystem->GetWorkerCount() + 1 << " : " << std::setw(8) << ParallelNanoseconds << " ns/vertex  x"
+        << ScalarNanoseconds / ParallelNanoseconds << (Identical ? "  identical" : "  MISMATCH")
+        << std::defaultfloat << std::endl;
+}
@@ -0,0 +1,37 @@
+/*
+    Benchmark.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    Micro benchmarks runnable from command console.
+    Each benchmark writes human readable result to the given stream.
+*/
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include "CpuSkinning.h"
+
+class Animation;
+class Object;
+
+// Measures Animation::DecodePose() per KeyFrame, then
+// interpolates every adjacent KeyFrame pair of 'animation' 'iterations' times with
+// per-bone scalar path( BoneTransform::Interpolate ) and PoseBlend kernels, and reports time per bone
+// and max matrix element difference from the per-bone path.
+void BenchmarkPoseBlend(Animation& animation, std::ostream& os, int iterations = 200);
+
+// Updates 'instanceCount' copies of 'source' for 'frameCount' frames through Scene::Update() with increasing number of
+// JobSystem workers, and reports time per frame and whether the resulting palettes are bit-identical to serial update.
+void BenchmarkAnimationUpdate(Object& source, int instanceCount, std::ostream& os, int frameCount = 100);
+
+// Updates 'instanceCount' copies of 'source' playing in 'phaseCount' groups in lockstep, with and without PoseCache,
+// and reports time per frame and cache hit/miss counts.
+void BenchmarkPoseCache(Object& source, int instanceCount, int phaseCount, std::ostream& os, int frameCount = 100);
+
+// Skins 'instanceCount' copies of 'source' with 'pPalette' 'iterations' times with the scalar kernel, the SSE kernel and
+// the SSE kernel split by vertex range across JobSystem workers. Reports time per vertex, max difference of the SSE kernel
+// from the scalar one, and whether the parallel result is bit-identical to the serial one.
+// Needs no GL context.
+void BenchmarkCpuSkinning(const CpuSkinning::Source& source, const glm::mat4* pPalette, int instanceCount, std::ostream& os, int iterations = 20);
+
+#endif
@@ -0,0 +1,231 @@
+/*
+    BlendTree.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    BlendTree class implementation.
+*/
+#include "Common.h"
+#include "BlendTree.h"
+#include "Skeleton.h"
+
+BlendTree::BlendTree()
+    : m_nodes()
+    , m_masks()
+    , m_slotCount(0)
+    , m_parameterCount(0)
+    , m_instructions()
+    , m_referenceRegisters()
+    , m_registerCount(0)
+    , m_compiled(false)
+{
+}
+
+int BlendTree::AddClip(int slot)
+{
+    assert(slot >= 0);
+    m_slotCount = std::max(m_slotCount, slot + 1);
+    return AddNode(NT_CLIP, INVALID_NODE, INVALID_NODE, -1, slot);
+}
+
+int BlendTree::AddCrossfade(int a, int b, int parameter)
+{
+    return AddNode(NT_CROSSFADE, a, b, parameter, -1);
+}
+
+int BlendTree::AddAdditive(int base, int additiveClip, int parameter)
+{
+    // Reference pose is per clip, so the layer itself must be a clip.
+    assert(0 <= additiveClip && additiveClip < static_cast<int>(m_nodes.size()) && m_nodes[additiveClip].type == NT_CLIP);
+    return AddNode(NT_ADDITIVE, base, additiveClip, parameter, -1);
+}
+
+int BlendTree::AddMasked(int base, int layer, int mask, int parameter)
+{
+    assert(0 <= mask && mask < static_cast<int>(m_masks.size()));
+    return AddNode(NT_MASKED, base, layer, parameter, mask);
+}
+
+int BlendTree::AddMask(const std::vector<float>& boneWeights)
+{
+    m_masks.push_back(boneWeights);
+    return static_cast<int>(m_masks.size()) - 1;
+}
+
+int BlendTree::AddBranchMask(const Skeleton& skeleton, int boneIndex)
+{
+    assert(0 <= boneIndex && boneIndex < skeleton.GetBoneCount());
+    // Parents come before children, so a bone is in the branch if its parent is.
+    const int* pParentIndices = skeleton.GetParentIndices();
+    std::vector<float> boneWeights(skeleton.GetBoneCount(), 0.0f);
+    boneWeights[boneIndex] = 1.0f;
+    for (int i = boneIndex + 1; i < skeleton.GetBoneCount(); ++i)
+    {
+        if (pParentIndices[i] != Skeleton::DUMMY_PARENT_NODE_INDEX && boneWeights[pParentIndices[i]] > 0.0f)
+        {
+            boneWeights[i] = 1.0f;
+        }
+    }
+    return AddMask(boneWeights);
+}
+
+void BlendTree::Compile(int root)
+{
+    assert(!m_compiled && 0 <= root && root < static_cast<int>(m_nodes.size()));
+    m_instructions.clear();
+    int stackRegisterCount = 0;
+    Emit(root, 0, stackRegisterCount);
+
+    // Each slot keeps its two decoded KeyFrames above the stack, then reference poses of additive slots.
+    m_registerCount = stackRegisterCount + m_slotCount * 2;
+    m_referenceRegisters.assign(m_slotCount, -1);
+    for (Instruction& instruction : m_instructions)
+    {
+        if (instruction.op == OP_SAMPLE)
+        {
+            instruction.source = stackRegisterCount + instruction.operand * 2;
+        }
+    }
+    for (const Node& node : m_nodes)
+    {
+        if (node.type == NT_ADDITIVE)
+        {
+            const int Slot = m_nodes[node.children[1]].operand;
+            if (m_referenceRegisters[Slot] < 0)
+            {
+                m_referenceRegisters[Slot] = m_registerCount++;
+            }
+        }
+    }
+    for (Instruction& instruction : m_instructions)
+    {
+        if (instruction.op == OP_ADDITIVE)
+        {
+            instruction.operand = m_referenceRegisters[instruction.operand];
+        }
+    }
+    m_compiled = true;
+}
+
+bool BlendTree::IsCompiled() const
+{
+    return m_compiled;
+}
+
+const std::vector<BlendTree::Instruction>& BlendTree::GetInstructions() const
+{
+    return m_instructions;
+}
+
+int BlendTree::GetResultRegister() const
+{
+    return 0;
+}
+
+int BlendTree::GetRegisterCount() const
+{
+    return m_registerCount;
+}
+
+int BlendTree::GetSlotCount() const
+{
+    return m_slotCount;
+}
+
+int BlendTree::GetParameterCount() const
+{
+    return m_parameterCount;
+}
+
+int BlendTree::GetReferenceRegister(int slot) const
+{
+    return m_referenceRegisters[slot];
+}
+
+const std::vector<float>& BlendTree::GetMask(int mask) const
+{
+    return m_masks[mask];
+}
+
+int BlendTree::AddNode(NodeType type, int a, int b, int parameter, int operand)
+{
+    assert(!m_compiled);
+    assert(type == NT_CLIP || (0 <= a && a < static_cast<int>(m_nodes.size()) && 0 <= b && b < static_cast<int>(m_nodes.size())));
+    assert(type == NT_CLIP || parameter >= 0);
+    m_parameterCount = std::max(m_parameterCount, parameter + 1);
+
+    Node node;
+    node.type = type;
+    node.children[0] = a;
+    node.children[1] = b;
+    node.parameter = parameter;
+    node.operand = operand;
+    m_nodes.push_back(node);
+    return static_cast<int>(m_nodes.size()) - 1;
+}
+
+void BlendTree::Emit(int node, int target, int& stackRegisterCount)
+{
+    const Node& Current = m_nodes[node];
+    stackRegisterCount = std::max(stackRegisterCount, target + 1);
+
+    Instruction instruction;
+    instruction.target = target;
+    instruction.source = target + 1;
+    instruction.parameter = Current.parameter;
+    instruction.operand = Current.operand;
+
+    switch (Current.type)
+    {
+    case NT_CLIP:
+        // Source is filled by Compile() once the stack size is known.
+        instruction.op = OP_SAMPLE;
+        m_instructions.push_back(instruction);
+        return;
+
+    case NT_CROSSFADE:
+    {
+        // Only 'b' shows at weight 1; then crossfade moves it into target.
+        const int SkipA = BeginSkip(OP_SKIP_IF_ONE, Current.parameter);
+        Emit(Current.children[0], target, stackRegisterCount);
+        EndSkip(SkipA);
+        instruction.op = OP_CROSSFADE;
+        break;
+    }
+
+    case NT_ADDITIVE:
+        Emit(Current.children[0], target, stackRegisterCount);
+        // Operand is the slot until Compile() assigns reference registers.
+        instruction.op = OP_ADDITIVE;
+        instruction.operand = m_nodes[Current.children[1]].operand;
+        break;
+
+    case NT_MASKED:
+        Emit(Current.children[0], target, stackRegisterCount);
+        instruction.op = OP_MASKED;
+        break;
+    }
+
+    // Layer and the blend itself are skipped at weight 0; target keeps the base.
+    const int SkipB = BeginSkip(OP_SKIP_IF_ZERO, Current.parameter);
+    Emit(Current.children[1], target + 1, stackRegisterCount);
+    m_instructions.push_back(instruction);
+    EndSkip(SkipB);
+}
+
+int BlendTree::BeginSkip(OpCode op, int parameter)
+{
+    Instruction skip;
+    skip.op = op;
+    skip.target = -1;
+    skip.source = -1;
+    skip.parameter = parameter;
+    skip.operand = 0;
+    m_instructions.push_back(skip);
+    return static_cast<int>(m_instructions.size()) - 1;
+}
+
+void BlendTree::EndSkip(int skip)
+{
+    m_instructions[skip].operand = static_cast<int>(m_instructions.size()) - skip - 1;
+}
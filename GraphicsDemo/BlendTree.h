@@ -0,0 +1,151 @@
+/*
+    BlendTree.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    BlendTree class definition.
+*/
+#ifndef BLEND_TREE_H_
+#define BLEND_TREE_H_
+
+class Skeleton;
+
+//
+// class BlendTree
+//
+// Describes how poses of several clips are combined into the pose of a character: crossfades between two poses,
+// additive layers applied on top of a pose, and layers that override a pose on some bones only( masked ).
+// Clips are not part of the tree; leaves refer to clip slots which each Animator binds to Animations,
+// and blend weights are parameters each Animator sets. So one tree is shared by every character that uses it.
+//
+// Compile() flattens the tree into a list of instructions that read and write pose registers( PosePool indices ).
+// Each blend is preceded by a skip instruction that jumps over the subtree it doesn't need when its weight is 0 or 1,
+// so evaluation cost follows the layers that contribute, not the size of the tree.
+//
+// usage:
+//  std::shared_ptr<BlendTree> pTree(new BlendTree);
+//  const int Locomotion = pTree->AddCrossfade(pTree->AddClip(0), pTree->AddClip(1), 0); // walk -> run by parameter 0
+//  const int UpperBody = pTree->AddBranchMask(skeleton, skeleton.FindBoneIndex("Spine"));
+//  pTree->Compile(pTree->AddMasked(Locomotion, pTree->AddClip(2), UpperBody, 1));      // wave on upper body by parameter 1
+//  ...
+//  animator.SetBlendTree(pTree);
+//  animator.SetClip(0, pWalk);
+//
+class BlendTree
+{
+public:
+    enum { INVALID_NODE = -1 };
+
+    // Instruction operations. 'target', 'source', 'parameter' and 'operand' of Instruction mean:
+    enum OpCode : uint8_t
+    {
+        // Samples clip slot 'operand' into 'target'. KeyFrames of the slot are cached in 'source' and 'source' + 1.
+        OP_SAMPLE,
+        // Skips next 'operand' instructions if weight 'parameter' is 0 or less.
+        OP_SKIP_IF_ZERO,
+        // Skips next 'operand' instructions if weight 'parameter' is 1 or more.
+        OP_SKIP_IF_ONE,
+        // target = blend of target toward source by weight 'parameter'
+        OP_CROSSFADE,
+        // target = target + ( source - register 'operand' ) * weight 'parameter'. Register 'operand' holds reference pose.
+        OP_ADDITIVE,
+        // target = blend of target toward source by weight 'parameter' times weights of mask 'operand'
+        OP_MASKED,
+    };
+
+    struct Instruction
+    {
+        OpCode op;
+        int target;
+        int source;
+        int parameter;
+        int operand;
+    };
+
+    BlendTree();
+
+    // Leaf that plays clip slot 'slot'. Returns node id.
+    int AddClip(int slot);
+
+    // Crossfade from node 'a' to node 'b'. Weight parameter 'parameter' is 0 for 'a' only, 1 for 'b' only.
+    int AddCrossfade(int a, int b, int parameter);
+
+    // Adds difference of clip node 'additiveClip' from its first KeyFrame on top of node 'base', scaled by 'parameter'.
+    int AddAdditive(int base, int additiveClip, int parameter);
+
+    // Blends node 'layer' over node 'base' by 'parameter' times per bone weight of mask 'mask'.
+    int AddMasked(int base, int layer, int mask, int parameter);
+
+    // Adds per bone weights for AddMasked(), indexed by bone index. Returns mask index.
+    int AddMask(const std::vector<float>& boneWeights);
+
+    // Adds mask that is 1 for bone 'boneIndex' and its descendants in 'skeleton', 0 for the others.
+    int AddBranchMask(const Skeleton& skeleton, int boneIndex);
+
+    // Flattens the tree under 'root' into instructions. Nodes can't be added after.
+    void Compile(int root);
+
+    bool IsCompiled() const;
+
+    const std::vector<Instruction>& GetInstructions() const;
+
+    // Pose register the result is in after evaluation
+    int GetResultRegister() const;
+
+    // Number of pose registers instructions use
+    int GetRegisterCount() const;
+
+    // Number of clip slots leaves refer to
+    int GetSlotCount() const;
+
+    // Number of weight parameters blends refer to
+    int GetParameterCount() const;
+
+    // Register that holds reference pose( first KeyFrame ) of clip slot 'slot' if it is used as additive layer, -1 otherwise.
+    int GetReferenceRegister(int slot) const;
+
+    // Per bone weights of mask 'mask'
+    const std::vector<float>& GetMask(int mask) const;
+
+private:
+    enum NodeType : uint8_t
+    {
+        NT_CLIP,
+        NT_CROSSFADE,
+        NT_ADDITIVE,
+        NT_MASKED,
+    };
+
+    struct Node
+    {
+        NodeType type;
+        // Child nodes. Clip nodes have none.
+        int children[2];
+        int parameter;
+        // Clip slot of NT_CLIP, mask of NT_MASKED
+        int operand;
+    };
+
+    std::vector<Node> m_nodes;
+    std::vector<std::vector<float>> m_masks;
+    int m_slotCount;
+    int m_parameterCount;
+
+    // Compiled form
+    std::vector<Instruction> m_instructions;
+    std::vector<int> m_referenceRegisters;
+    int m_registerCount;
+    bool m_compiled;
+
+    int AddNode(NodeType type, int a, int b, int parameter, int operand);
+
+    // Emits instructions that leave result of 'node' in register 'target'. Registers above 'target' are scratch.
+    void Emit(int node, int target, int& stackRegisterCount);
+
+    // Emits skip instruction whose count is filled by EndSkip(). Returns its index.
+    int BeginSkip(OpCode op, int parameter);
+
+    void EndSkip(int skip);
+};
+
+#endif
@@ -17,11 +17,11 @@
 
 Bone::Bone()
     : m_parent(DUMMY_PARENT_NODE_INDEX)
+    , m_nameId(NameTable::INVALID_NAME_ID)
     , m_transform(glm::identity<glm::mat4>())
     , m_linkTransform(glm::identity<glm::mat4>())
     , m_invTransform(glm::identity<glm::mat4>())
     , m_invLinkTransform(glm::identity<glm::mat4>())
-    , m_animationTransform(glm::identity<glm::mat4>())
 {
 }
 
@@ -31,12 +31,12 @@ void Bone::SetTransform(const glm::mat4 & transform)
     m_invTransform = glm::inverse(transform);
 }
 
-const glm::mat4 & Bone::GetTransform()
+const glm::mat4 & Bone::GetTransform() const
 {
     return m_transform;
 }
 
-const glm::mat4 & Bone::GetInvTransform()
+const glm::mat4 & Bone::GetInvTransform() const
 {
     return m_invTransform;
 }
@@ -47,17 +47,17 @@ void Bone::SetLinkTransform(const glm::mat4 & linkTransform)
     m_invLinkTransform = glm::inverse(linkTransform);
 }
 
-const glm::mat4 & Bone::GetLinkTransform()
+const glm::mat4 & Bone::GetLinkTransform() const
 {
     return m_linkTransform;
 }
 
-const glm::mat4 & Bone::GetInvLinkTransform()
+const glm::mat4 & Bone::GetInvLinkTransform() const
 {
     return m_invLinkTransform;
 }
 
-int Bone::GetParent()
+int Bone::GetParent() const
 {
     return m_parent;
 }
@@ -69,35 +69,29 @@ void Bone::SetParent(int parentIndex)
 
 void Bone::SetName(const char * name)
 {
-    m_name = name;
+    m_nameId = NameTable::Instance()->Intern(name);
 }
 
 void Bone::SetName(const std::string & name)
 {
-    m_name = name;
+    m_nameId = NameTable::Instance()->Intern(name);
 }
 
 const std::string & Bone::GetName() const
 {
-    return m_name;
+    return NameTable::Instance()->GetString(m_nameId);
 }
 
-void Bone::SetAnimationTransform(const glm::mat4 & mat)
+NameId Bone::GetNameId() const
 {
-    m_animationTransform = mat;
+    return m_nameId;
 }
 
-const glm::mat4 & Bone::GetAnimationTrasnform()
-{
-    return m_animationTransform;
-}
-
-void Bone::Serialize(std::ostream& os)
+void Bone::Serialize(std::ostream& os) const
 {
     Serialization::Write(os, m_parent);
-    Serialization::Write(os, m_name);
+    Serialization::Write(os, GetName());
     Serialization::Write(os, m_transform);
-    Serialization::Write(os, m_animationTransform);
     Serialization::Write(os, m_invTransform);
     Serialization::Write(os, m_linkTransform);
     Serialization::Write(os, m_invLinkTransform);
@@ -106,9 +100,10 @@ void Bone::Serialize(std::ostream& os)
 void Bone::Deserialize(std::istream& is)
 {
     Serialization::Read(is, m_parent);
-    Serialization::Read(is, m_name);
+    std::string name;
+    Serialization::Read(is, name);
+    SetName(name);
     Serialization::Read(is, m_transform);
-    Serialization::Read(is, m_animationTransform);
     Serialization::Read(is, m_invTransform);
     Serialization::Read(is, m_linkTransform);
     Serialization::Read(is, m_invLinkTransform);
@@ -14,6 +14,14 @@
 #ifndef BONE_H_
 #define BONE_H_
 
+#include "NameTable.h"
+
+//
+// class Bone
+//
+// Bind pose description of a bone as loaded from file.
+// Only read while building a Skeleton; Skeleton keeps what is needed every frame in its own arrays.
+//
 class Bone
 {
 public:
@@ -23,17 +31,17 @@ public:
 
     void SetTransform(const glm::mat4& transform);
 
-    const glm::mat4& GetTransform();
+    const glm::mat4& GetTransform() const;
 
-    const glm::mat4& GetInvTransform();
+    const glm::mat4& GetInvTransform() const;
 
     void SetLinkTransform(const glm::mat4& linkTransform);
 
-    const glm::mat4& GetLinkTransform();
+    const glm::mat4& GetLinkTransform() const;
 
-    const glm::mat4& GetInvLinkTransform();
+    const glm::mat4& GetInvLinkTransform() const;
 
-    int GetParent();
+    int GetParent() const;
 
     void SetParent(int parentIndex);
 
@@ -43,21 +51,18 @@ public:
 
     const std::string& GetName() const;
 
-    void SetAnimationTransform(const glm::mat4& mat);
+    // Name interned in NameTable
+    NameId GetNameId() const;
 
-    const glm::mat4& GetAnimationTrasnform();
-
-    void Serialize(std::ostream& os);
+    void Serialize(std::ostream& os) const;
 
     void Deserialize(std::istream& is);
 
 private:
     int m_parent;
-    std::string m_name;
+    NameId m_nameId;
     // Joint Transform that sends vertex to animated location in model space
     glm::mat4 m_transform;    
-    // Animation Traget Transform
-    glm::mat4 m_animationTransform;
     glm::mat4 m_invTransform;
     glm::mat4 m_linkTransform;
     glm::mat4 m_invLinkTransform;
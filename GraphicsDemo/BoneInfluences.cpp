@@ -0,0 +1,258 @@
+/*
+    BoneInfluences.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    Dependencies :
+        glad - attribute arrays
+
+    BoneInfluences class implementation.
+*/
+#include "Common.h"
+#include "BoneInfluences.h"
+#include "AttributeArray.h"
+
+namespace
+{
+    // Quantizes renormalized 'weights' to [0, Maximum] so that they sum to exactly 'Maximum'.
+    // Rounding error goes to the first weight, which is the largest.
+    template <typename T>
+    void QuantizeWeights(const float* weights, int count, T* pOut)
+    {
+        const int Maximum = std::numeric_limits<T>::max();
+        int sum = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            const int Quantized = static_cast<int>(weights[i] * Maximum + 0.5f);
+            pOut[i] = static_cast<T>(Quantized);
+            sum += Quantized;
+        }
+        if (count > 0)
+        {
+            pOut[0] = static_cast<T>(pOut[0] + Maximum - sum);
+        }
+        for (int i = count; i < BoneInfluences::ComponentCount; ++i)
+        {
+            pOut[i] = 0;
+        }
+    }
+
+    // Widens 'size' components per vertex of 'in' to ComponentCount components per vertex in 'out', scaled by 'scale'.
+    template <typename In, typename Out>
+    void Widen(const std::vector<In>& in, int size, Out scale, std::vector<Out>& out)
+    {
+        const size_t VertexCount = in.size() / size;
+        out.assign(VertexCount * BoneInfluences::ComponentCount, Out(0));
+        for (size_t i = 0; i < VertexCount; ++i)
+        {
+            for (int j = 0; j < size && j < BoneInfluences::ComponentCount; ++j)
+            {
+                out[i * BoneInfluences::ComponentCount + j] = static_cast<Out>(in[i * size + j]) * scale;
+            }
+        }
+    }
+}
+
+BoneInfluences::Influence::Influence(int bone, float weight)
+    : bone(bone)
+    , weight(weight)
+{
+}
+
+BoneInfluences::BoneInfluences(int maximumInfluenceCount, WeightPrecision precision)
+    : m_maximumInfluenceCount(std::min(std::max(maximumInfluenceCount, 1), static_cast<int>(ComponentCount)))
+    , m_precision(precision)
+    , m_vertexCount(0)
+    , m_bones()
+    , m_maximumBone(0)
+    , m_weights8()
+    , m_weights16()
+    , m_maximumDroppedWeight(0.0f)
+    , m_sorted()
+{
+}
+
+void BoneInfluences::Reserve(int vertexCount)
+{
+    m_bones.reserve(vertexCount * ComponentCount);
+    if (m_precision == WP_UNORM8)
+    {
+        m_weights8.reserve(vertexCount * ComponentCount);
+    }
+    else
+    {
+        m_weights16.reserve(vertexCount * ComponentCount);
+    }
+}
+
+void BoneInfluences::AddVertex(const std::vector<Influence>& influences)
+{
+    m_sorted.clear();
+    for (const Influence& influence : influences)
+    {
+        if (0 <= influence.bone && influence.bone <= std::numeric_limits<uint16_t>::max())
+        {
+            m_sorted.push_back(influence);
+        }
+        else
+        {
+            m_maximumDroppedWeight = std::max(m_maximumDroppedWeight, influence.weight);
+        }
+    }
+    // Largest first. Ties are broken by bone index so that output doesn't depend on cluster order.
+    std::sort(m_sorted.begin(), m_sorted.end(), [](const Influence& a, const Influence& b)
+    {
+        return a.weight != b.weight ? a.weight > b.weight : a.bone < b.bone;
+    });
+
+    const int Count = std::min(static_cast<int>(m_sorted.size()), m_maximumInfluenceCount);
+    for (int i = Count; i < static_cast<int>(m_sorted.size()); ++i)
+    {
+        m_maximumDroppedWeight = std::max(m_maximumDroppedWeight, m_sorted[i].weight);
+    }
+
+    float sum = 0.0f;
+    for (int i = 0; i < Count; ++i)
+    {
+        sum += std::max(m_sorted[i].weight, 0.0f);
+    }
+
+    float weights[ComponentCount] = {};
+    uint16_t bones[ComponentCount] = {};
+    for (int i = 0; i < Count; ++i)
+    {
+        bones[i] = static_cast<uint16_t>(m_sorted[i].bone);
+        m_maximumBone = std::max(m_maximumBone, m_sorted[i].bone);
+        weights[i] = sum > 0.0f ? std::max(m_sorted[i].weight, 0.0f) / sum : 0.0f;
+    }
+
+    m_bones.insert(m_bones.end(), bones, bones + ComponentCount);
+    // Vertex no bone affects stays all zero, as it was before packing.
+    const int WeightCount = sum > 0.0f ? Count : 0;
+    if (m_precision == WP_UNORM8)
+    {
+        uint8_t quantized[ComponentCount];
+        QuantizeWeights(weights, WeightCount, quantized);
+        m_weights8.insert(m_weights8.end(), quantized, quantized + ComponentCount);
+    }
+    else
+    {
+        uint16_t quantized[ComponentCount];
+        QuantizeWeights(weights, WeightCount, quantized);
+        m_weights16.insert(m_weights16.end(), quantized, quantized + ComponentCount);
+    }
+    ++m_vertexCount;
+}
+
+int BoneInfluences::GetVertexCount() const
+{
+    return m_vertexCount;
+}
+
+int BoneInfluences::GetBytesPerVertex() const
+{
+    const size_t BoneSize = m_maximumBone > std::numeric_limits<uint8_t>::max() ? sizeof(uint16_t) : sizeof(uint8_t);
+    return static_cast<int>(ComponentCount * (BoneSize + (m_precision == WP_UNORM8 ? sizeof(uint8_t) : sizeof(uint16_t))));
+}
+
+float BoneInfluences::GetMaximumDroppedWeight() const
+{
+    return m_maximumDroppedWeight;
+}
+
+std::shared_ptr<AttributeArray> BoneInfluences::CreateBonesAttributeArray() const
+{
+    std::shared_ptr<AttributeArray> pBones;
+    if (m_maximumBone > std::numeric_limits<uint8_t>::max())
+    {
+        pBones.reset(new AttributeArray(ComponentCount, GL_UNSIGNED_SHORT, 0, 0));
+        pBones->Fill(m_bones.size() * sizeof(m_bones[0]), m_bones.data());
+    }
+    else
+    {
+        const std::vector<uint8_t> Bones(m_bones.begin(), m_bones.end());
+        pBones.reset(new AttributeArray(ComponentCount, GL_UNSIGNED_BYTE, 0, 0));
+        pBones->Fill(Bones.size() * sizeof(Bones[0]), Bones.data());
+    }
+    return pBones;
+}
+
+std::shared_ptr<AttributeArray> BoneInfluences::CreateWeightsAttributeArray() const
+{
+    std::shared_ptr<AttributeArray> pWeights;
+    if (m_precision == WP_UNORM8)
+    {
+        pWeights.reset(new AttributeArray(ComponentCount, GL_UNSIGNED_BYTE, 0, 0));
+        pWeights->Fill(m_weights8.size() * sizeof(m_weights8[0]), m_weights8.data());
+    }
+    else
+    {
+        pWeights.reset(new AttributeArray(ComponentCount, GL_UNSIGNED_SHORT, 0, 0));
+        pWeights->Fill(m_weights16.size() * sizeof(m_weights16[0]), m_weights16.data());
+    }
+    return pWeights;
+}
+
+bool BoneInfluences::Decode(AttributeArray& bones, AttributeArray& weights, std::vector<int>& outBones, std::vector<float>& outWeights)
+{
+    const int BoneSize = bones.GetSize();
+    const int WeightSize = weights.GetSize();
+    if (BoneSize <= 0 || WeightSize <= 0)
+        return false;
+
+    switch (bones.GetType())
+    {
+    case GL_UNSIGNED_BYTE:
+    {
+        std::vector<uint8_t> in;
+        bones.GetData(in);
+        Widen(in, BoneSize, 1, outBones);
+        break;
+    }
+    case GL_UNSIGNED_SHORT:
+    {
+        std::vector<uint16_t> in;
+        bones.GetData(in);
+        Widen(in, BoneSize, 1, outBones);
+        break;
+    }
+    case GL_INT:
+    {
+        std::vector<int> in;
+        bones.GetData(in);
+        Widen(in, BoneSize, 1, outBones);
+        break;
+    }
+    default:
+        return false;
+    }
+
+    switch (weights.GetType())
+    {
+    case GL_UNSIGNED_BYTE:
+    {
+        std::vector<uint8_t> in;
+        weights.GetData(in);
+        Widen(in, WeightSize, 1.0f / std::numeric_limits<uint8_t>::max(), outWeights);
+        break;
+    }
+    case GL_UNSIGNED_SHORT:
+    {
+        std::vector<uint16_t> in;
+        weights.GetData(in);
+        Widen(in, WeightSize, 1.0f / std::numeric_limits<uint16_t>::max(), outWeights);
+        break;
+    }
+    case GL_FLOAT:
+    {
+        std::vector<float> in;
+        weights.GetData(in);
+        Widen(in, WeightSize, 1.0f, outWeights);
+        break;
+    }
+    default:
+        return false;
+    }
+
+    return outBones.size() == outWeights.size();
+}
@@ -0,0 +1,91 @@
+/*
+    BoneInfluences.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    Dependencies :
+        glad - attribute arrays
+
+    BoneInfluences class definition.
+*/
+#ifndef BONE_INFLUENCES_H_
+#define BONE_INFLUENCES_H_
+
+class AttributeArray;
+
+//
+// class BoneInfluences
+//
+// Builds bone index and bone weight attribute arrays of a skinned mesh.
+// Of the bones that affect a vertex, only the ones with the largest weights are kept, and their weights are
+// renormalized so that they still sum to one. Indices are stored in unsigned bytes and weights in normalized
+// unsigned bytes or shorts, so the two attributes take 8( or 12 ) bytes per vertex. Meshes that use a bone index above
+// 255 keep indices in unsigned shorts, 4 bytes more per vertex. Influences of bones outside [0, 65535] are dropped.
+//
+// usage:
+//  BoneInfluences influences(BoneInfluences::ComponentCount, BoneInfluences::WP_UNORM8);
+//  for each vertex
+//      influences.AddVertex(boneWeightsOfVertex);
+//  pMesh->SetBonesAttributeArray(influences.CreateBonesAttributeArray());
+//  pMesh->SetWeightsAttributeArray(influences.CreateWeightsAttributeArray());
+//
+class BoneInfluences
+{
+public:
+    enum WeightPrecision
+    {
+        WP_UNORM8,
+        WP_UNORM16,
+    };
+
+    struct Influence
+    {
+        Influence(int bone, float weight);
+
+        int bone;
+        float weight;
+    };
+
+    // Components of bone and weight attributes. Influences a vertex doesn't use have zero weight.
+    static const int ComponentCount = 4;
+
+    // Keeps up to 'maximumInfluenceCount'( at most ComponentCount ) influences per vertex.
+    BoneInfluences(int maximumInfluenceCount = ComponentCount, WeightPrecision precision = WP_UNORM8);
+
+    void Reserve(int vertexCount);
+
+    // Appends a vertex affected by 'influences'. Order of 'influences' doesn't matter.
+    void AddVertex(const std::vector<Influence>& influences);
+
+    int GetVertexCount() const;
+
+    // Bytes per vertex of the two attribute arrays, for vertices added so far
+    int GetBytesPerVertex() const;
+
+    // Largest weight AddVertex() has dropped so far, before renormalization.
+    float GetMaximumDroppedWeight() const;
+
+    std::shared_ptr<AttributeArray> CreateBonesAttributeArray() const;
+
+    std::shared_ptr<AttributeArray> CreateWeightsAttributeArray() const;
+
+    // Reads bone and weight attribute arrays back as ComponentCount indices and weights per vertex.
+    // Understands both the packed arrays and the int / float arrays older scene files store. Returns false on unknown layout.
+    static bool Decode(AttributeArray& bones, AttributeArray& weights, std::vector<int>& outBones, std::vector<float>& outWeights);
+
+private:
+    int m_maximumInfluenceCount;
+    WeightPrecision m_precision;
+    int m_vertexCount;
+    // ComponentCount per vertex. Narrowed to bytes on upload unless m_maximumBone needs more.
+    std::vector<uint16_t> m_bones;
+    int m_maximumBone;
+    // ComponentCount per vertex. One of the two is used depending on m_precision.
+    std::vector<uint8_t> m_weights8;
+    std::vector<uint16_t> m_weights16;
+    float m_maximumDroppedWeight;
+    // Sorted copy of influences of the vertex being added
+    std::vector<Influence> m_sorted;
+};
+
+#endif
@@ -0,0 +1,384 @@
+/*
+    ClipLibrary.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    Dependencies :
+        Win32 - file mapping( mmap on other platforms )
+
+    ClipLibrary class implementation.
+*/
+#include "Common.h"
+#include "ClipLibrary.h"
+#include "Animation.h"
+#include "Serialization.h"
+
+#ifndef _WIN32
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace
+{
+    // 'GDCL'
+    const uint32_t LibraryMagic = 0x4c434447;
+    const uint32_t LibraryVersion = 1;
+    const size_t DefaultMemoryBudget = 64 * 1024 * 1024;
+
+    // Lets Serialization read from memory without copying it.
+    class MemoryStreamBuffer : public std::streambuf
+    {
+    public:
+        MemoryStreamBuffer(const char* pData, size_t size)
+        {
+            char* pBegin = const_cast<char*>(pData);
+            setg(pBegin, pBegin, pBegin + size);
+        }
+    };
+
+    // Bytes a table of contents entry takes in the file
+    size_t GetEntrySize(const std::string& name)
+    {
+        return sizeof(int) + name.size() + sizeof(float) + sizeof(int) + sizeof(uint64_t) * 2;
+    }
+}
+
+ClipLibrary::ClipLibrary()
+    : m_filename()
+    , m_entries()
+    , m_memoryBudget(DefaultMemoryBudget)
+    , m_residentSize(0)
+    , m_useCounter(0)
+    , m_pageInCount(0)
+    , m_pMappedData(nullptr)
+    , m_mappedSize(0)
+    , m_fileHandle(nullptr)
+    , m_mappingHandle(nullptr)
+{
+}
+
+ClipLibrary::~ClipLibrary()
+{
+    Close();
+}
+
+bool ClipLibrary::Write(const std::string& filename, const std::vector<std::shared_ptr<Animation>>& clips)
+{
+    // Clips are serialized first; their sizes decide where each one goes.
+    std::vector<std::string> blobs(clips.size());
+    size_t tableSize = sizeof(LibraryMagic) + sizeof(LibraryVersion) + sizeof(int);
+    for (size_t i = 0; i < clips.size(); ++i)
+    {
+        std::ostringstream oss(std::ios::binary);
+        clips[i]->Serialize(oss);
+        blobs[i] = oss.str();
+        tableSize += GetEntrySize(clips[i]->GetName());
+    }
+
+    std::ofstream ofs(filename, std::ios::binary);
+    if (!ofs)
+    {
+        std::cout << "ClipLibrary::Write() : can't open " << filename << std::endl;
+        return false;
+    }
+
+    Serialization::Write(ofs, LibraryMagic);
+    Serialization::Write(ofs, LibraryVersion);
+    const int ClipCount = static_cast<int>(clips.size());
+    Serialization::Write(ofs, ClipCount);
+    uint64_t offset = tableSize;
+    for (size_t i = 0; i < clips.size(); ++i)
+    {
+        const uint64_t Size = blobs[i].size();
+        Serialization::Write(ofs, clips[i]->GetName());
+        Serialization::Write(ofs, clips[i]->GetLength());
+        Serialization::Write(ofs, clips[i]->GetBoneCount());
+        Serialization::Write(ofs, offset);
+        Serialization::Write(ofs, Size);
+        offset += Size;
+    }
+    assert(static_cast<size_t>(ofs.tellp()) == tableSize);
+
+    for (const std::string& blob : blobs)
+    {
+        ofs.write(blob.data(), blob.size());
+    }
+    return static_cast<bool>(ofs);
+}
+
+bool ClipLibrary::Open(const std::string& filename)
+{
+    Close();
+    if (!MapFile(filename))
+    {
+        std::cout << "ClipLibrary::Open() : can't map " << filename << std::endl;
+        return false;
+    }
+
+    MemoryStreamBuffer buffer(m_pMappedData, m_mappedSize);
+    std::istream is(&buffer);
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    int clipCount = 0;
+    Serialization::Read(is, magic);
+    Serialization::Read(is, version);
+    Serialization::Read(is, clipCount);
+    if (!is || magic != LibraryMagic || version != LibraryVersion || clipCount < 0)
+    {
+        std::cout << "ClipLibrary::Open() : " << filename << " is not a clip library" << std::endl;
+        Close();
+        return false;
+    }
+
+    m_entries.resize(clipCount);
+    for (Entry& entry : m_entries)
+    {
+        Serialization::Read(is, entry.name);
+        Serialization::Read(is, entry.length);
+        Serialization::Read(is, entry.boneCount);
+        Serialization::Read(is, entry.offset);
+        Serialization::Read(is, entry.size);
+        entry.residentSize = 0;
+        entry.lastUse = 0;
+        if (!is || entry.offset > m_mappedSize || entry.size > m_mappedSize - entry.offset)
+        {
+            std::cout << "ClipLibrary::Open() : table of contents of " << filename << " is corrupt" << std::endl;
+            Close();
+            return false;
+        }
+    }
+
+    m_filename = filename;
+    return true;
+}
+
+void ClipLibrary::Close()
+{
+    m_entries.clear();
+    m_residentSize = 0;
+    m_filename.clear();
+    UnmapFile();
+}
+
+bool ClipLibrary::IsOpen() const
+{
+    return m_pMappedData != nullptr;
+}
+
+const std::string& ClipLibrary::GetFilename() const
+{
+    return m_filename;
+}
+
+int ClipLibrary::GetClipCount() const
+{
+    return static_cast<int>(m_entries.size());
+}
+
+const std::string& ClipLibrary::GetClipName(int index) const
+{
+    return m_entries[index].name;
+}
+
+float ClipLibrary::GetClipLength(int index) const
+{
+    return m_entries[index].length;
+}
+
+int ClipLibrary::GetClipBoneCount(int index) const
+{
+    return m_entries[index].boneCount;
+}
+
+bool ClipLibrary::IsClipResident(int index) const
+{
+    return m_entries[index].pAnimation != nullptr;
+}
+
+int ClipLibrary::FindClip(const std::string& name) const
+{
+    for (int i = 0; i < static_cast<int>(m_entries.size()); ++i)
+    {
+        if (m_entries[i].name == name)
+            return i;
+    }
+    return -1;
+}
+
+int ClipLibrary::FindClip(const Animation* pAnimation) const
+{
+    for (int i = 0; i < static_cast<int>(m_entries.size()); ++i)
+    {
+        if (m_entries[i].pAnimation.get() == pAnimation)
+            return i;
+    }
+    return -1;
+}
+
+std::shared_ptr<Animation> ClipLibrary::Acquire(int index)
+{
+    if (index < 0 || index >= static_cast<int>(m_entries.size()))
+        return nullptr;
+
+    Entry& entry = m_entries[index];
+    entry.lastUse = ++m_useCounter;
+    if (entry.pAnimation)
+        return entry.pAnimation;
+
+    MemoryStreamBuffer buffer(m_pMappedData + entry.offset, static_cast<size_t>(entry.size));
+    std::istream is(&buffer);
+    std::shared_ptr<Animation> pAnimation(new Animation(entry.name));
+    pAnimation->Deserialize(is);
+    if (!is || pAnimation->GetBoneCount() != entry.boneCount)
+    {
+        std::cout << "ClipLibrary::Acquire() : clip '" << entry.name << "' is corrupt" << std::endl;
+        return nullptr;
+    }
+
+    entry.pAnimation = pAnimation;
+    entry.residentSize = pAnimation->GetPoseDataSize();
+    m_residentSize += entry.residentSize;
+    ++m_pageInCount;
+    Evict();
+    return pAnimation;
+}
+
+void ClipLibrary::SetMemoryBudget(size_t bytes)
+{
+    m_memoryBudget = bytes;
+    Evict();
+}
+
+size_t ClipLibrary::GetMemoryBudget() const
+{
+    return m_memoryBudget;
+}
+
+size_t ClipLibrary::GetResidentSize() const
+{
+    return m_residentSize;
+}
+
+int ClipLibrary::GetResidentCount() const
+{
+    return static_cast<int>(std::count_if(m_entries.begin(), m_entries.end(), [](const Entry& entry)
+    {
+        return entry.pAnimation != nullptr;
+    }));
+}
+
+int ClipLibrary::GetPageInCount() const
+{
+    return m_pageInCount;
+}
+
+void ClipLibrary::Evict()
+{
+    while (m_residentSize > m_memoryBudget)
+    {
+        // Least recently acquired clip only the library holds
+        Entry* pVictim = nullptr;
+        for (Entry& entry : m_entries)
+        {
+            if (entry.pAnimation && entry.pAnimation.use_count() == 1 && (!pVictim || entry.lastUse < pVictim->lastUse))
+            {
+                pVictim = &entry;
+            }
+        }
+
+        // Everything left is being played
+        if (!pVictim)
+            return;
+
+        m_residentSize -= pVictim->residentSize;
+        pVictim->residentSize = 0;
+        pVictim->pAnimation.reset();
+    }
+}
+
+#ifdef _WIN32
+bool ClipLibrary::MapFile(const std::string& filename)
+{
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    const void* pView = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!pView)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_pMappedData = static_cast<const char*>(pView);
+    m_mappedSize = static_cast<size_t>(size.QuadPart);
+    m_fileHandle = file;
+    m_mappingHandle = mapping;
+    return true;
+}
+
+void ClipLibrary::UnmapFile()
+{
+    if (m_pMappedData)
+    {
+        UnmapViewOfFile(m_pMappedData);
+        CloseHandle(m_mappingHandle);
+        CloseHandle(m_fileHandle);
+    }
+    m_pMappedData = nullptr;
+    m_mappedSize = 0;
+    m_fileHandle = nullptr;
+    m_mappingHandle = nullptr;
+}
+#else
+bool ClipLibrary::MapFile(const std::string& filename)
+{
+    const int File = open(filename.c_str(), O_RDONLY);
+    if (File < 0)
+        return false;
+
+    struct stat status;
+    if (fstat(File, &status) != 0 || status.st_size == 0)
+    {
+        close(File);
+        return false;
+    }
+
+    void* pView = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, File, 0);
+    // Mapping stays valid after the descriptor is closed
+    close(File);
+    if (pView == MAP_FAILED)
+        return false;
+
+    m_pMappedData = static_cast<const char*>(pView);
+    m_mappedSize = static_cast<size_t>(status.st_size);
+    return true;
+}
+
+void ClipLibrary::UnmapFile()
+{
+    if (m_pMappedData)
+    {
+        munmap(const_cast<char*>(m_pMappedData), m_mappedSize);
+    }
+    m_pMappedData = nullptr;
+    m_mappedSize = 0;
+}
+#endif
@@ -0,0 +1,129 @@
+/*
+    ClipLibrary.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    Dependencies :
+        Win32 - file mapping( mmap on other platforms )
+
+    ClipLibrary class definition.
+*/
+#ifndef CLIP_LIBRARY_H_
+#define CLIP_LIBRARY_H_
+
+#include "Singleton.h"
+
+class Animation;
+
+//
+// class ClipLibrary
+//
+// File of many Animations that are loaded one at a time, when something starts playing them.
+// The file starts with a table of contents( name, length, bone count and location of each clip ) followed by
+// clips, each a self-contained compressed Animation( Animation::Serialize ).
+// Open() maps the file and reads only the table of contents; a clip is decoded from the mapping
+// the first time it is acquired, so the OS pages in only clips that are played.
+//
+// Decoded clips stay resident while anything holds them. Clips nothing holds are kept too, as long as
+// resident clips fit in the memory budget; beyond that the least recently acquired ones are released.
+// Must be used from the main thread.
+//
+// usage:
+//  ClipLibrary::Write("mocap.clips", animations);
+//  ...
+//  ClipLibrary::Instance()->Open("mocap.clips");
+//  animator.SetCurrentAnimation(ClipLibrary::Instance()->Acquire(ClipLibrary::Instance()->FindClip("Walk")));
+//
+class ClipLibrary : public Singleton<ClipLibrary>
+{
+public:
+    ClipLibrary();
+
+    ~ClipLibrary();
+
+    // Writes 'clips' to 'filename' as a clip library. Clips are compressed if they are not yet.
+    static bool Write(const std::string& filename, const std::vector<std::shared_ptr<Animation>>& clips);
+
+    // Maps 'filename' and reads its table of contents. Closes the library opened before.
+    bool Open(const std::string& filename);
+
+    // Releases resident clips and unmaps the file. Clips still held elsewhere stay valid.
+    void Close();
+
+    bool IsOpen() const;
+
+    const std::string& GetFilename() const;
+
+    int GetClipCount() const;
+
+    const std::string& GetClipName(int index) const;
+
+    float GetClipLength(int index) const;
+
+    int GetClipBoneCount(int index) const;
+
+    // Returns true if clip 'index' is decoded in memory.
+    bool IsClipResident(int index) const;
+
+    // Index of clip named 'name'. -1 if there is none.
+    int FindClip(const std::string& name) const;
+
+    // Index of clip 'pAnimation' was acquired from. -1 if it is not a resident clip of this library.
+    int FindClip(const Animation* pAnimation) const;
+
+    // Returns clip 'index', decoding it from the file if it is not resident. nullptr on bad index or corrupt clip.
+    std::shared_ptr<Animation> Acquire(int index);
+
+    // Releases least recently acquired clips nothing holds until resident clips fit in 'bytes'.
+    void SetMemoryBudget(size_t bytes);
+
+    size_t GetMemoryBudget() const;
+
+    // Pose data bytes of resident clips
+    size_t GetResidentSize() const;
+
+    int GetResidentCount() const;
+
+    // Number of times Acquire() decoded a clip from the file
+    int GetPageInCount() const;
+
+private:
+    struct Entry
+    {
+        std::string name;
+        float length;
+        int boneCount;
+        // Location of the clip in the file
+        uint64_t offset;
+        uint64_t size;
+
+        // Decoded clip. nullptr if not resident.
+        std::shared_ptr<Animation> pAnimation;
+        size_t residentSize;
+        // Value of m_useCounter when the clip was acquired last
+        uint64_t lastUse;
+    };
+
+    std::string m_filename;
+    std::vector<Entry> m_entries;
+    size_t m_memoryBudget;
+    size_t m_residentSize;
+    uint64_t m_useCounter;
+    int m_pageInCount;
+
+    // Mapped view of the file
+    const char* m_pMappedData;
+    size_t m_mappedSize;
+    // Platform handles of the mapping. Unused where closing the view is enough.
+    void* m_fileHandle;
+    void* m_mappingHandle;
+
+    bool MapFile(const std::string& filename);
+
+    void UnmapFile();
+
+    // Releases clips nothing holds, least recently acquired first, until resident clips fit in the budget.
+    void Evict();
+};
+
+#endif
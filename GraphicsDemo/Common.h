@@ -13,9 +13,13 @@
 
     Changelog:
         190307 - Now Common.h is precompiled header
+
+    GD_HEADLESS builds the animation core without window, GL and FBX SDK( e.g. AnimationBenchmark on Linux ).
+    Only GL handle types are declared then, so that headers that mention them still compile.
 */
 #ifndef NDEBUG
 #   define GD_USE_CONSOLE
+#   define GD_COUNT_ALLOCATIONS
 #endif
 
 #ifdef _UNICODE
@@ -24,6 +28,11 @@
 #   define GD_TSTRING std::string
 #endif
 
+// SSE2 is guaranteed on x64 and on x86 when built with /arch:SSE2 or above.
+#if defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#   define GD_USE_SSE
+#endif
+
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -32,22 +41,46 @@
 #include <vector>
 #include <cstdint>
 #include <climits>
+#include <limits>
+#include <cstring>
+#include <cassert>
 #include <string>
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <functional>
 #include <queue>
+#include <deque>
 #include <stack>
 #include <iomanip>
 #include <iterator>
 #include <locale>
 #include <codecvt>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
+#ifdef GD_USE_SSE
+#   include <emmintrin.h>
+#endif
+
+#ifdef GD_HEADLESS
+typedef unsigned int GLenum;
+typedef unsigned char GLboolean;
+typedef int GLint;
+typedef int GLsizei;
+typedef unsigned int GLuint;
+typedef float GLfloat;
+typedef std::ptrdiff_t GLsizeiptr;
+#else
 #include <Windows.h>
 #include <Windowsx.h>
 #include <WinUser.h>
 
 #include <glad.h>
+#endif
 
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
@@ -56,10 +89,12 @@
 #include <glm/gtx/rotate_vector.hpp>
 #include <glm/gtx/transform.hpp>
 
+#ifndef GD_HEADLESS
 #include <fbxsdk.h>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include FT_GLYPH_H 
+#endif
 
 
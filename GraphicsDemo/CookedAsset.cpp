@@ -0,0 +1,161 @@
+/*
+    CookedAsset.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    References :
+        http://www.isthe.com/chongo/tech/comp/fnv/index.html
+
+    CookedAsset class implementation.
+*/
+#include "Common.h"
+#include "CookedAsset.h"
+#include "Object.h"
+#include "Serialization.h"
+
+namespace
+{
+    // 'GDCA'
+    const uint32_t AssetMagic = 0x41434447;
+    const char* const CookedExtension = ".cooked";
+    const size_t HashChunkSize = 64 * 1024;
+
+    struct AssetHeader
+    {
+        uint32_t magic;
+        uint32_t cookerVersion;
+        uint64_t sourceHash;
+    };
+
+    bool ReadHeader(std::istream& is, AssetHeader& header)
+    {
+        Serialization::Read(is, header.magic);
+        Serialization::Read(is, header.cookerVersion);
+        Serialization::Read(is, header.sourceHash);
+        return static_cast<bool>(is) && header.magic == AssetMagic;
+    }
+}
+
+std::string CookedAsset::GetCookedFilename(const std::string& sourceFilename)
+{
+    return sourceFilename + CookedExtension;
+}
+
+uint64_t CookedAsset::HashFile(const std::string& filename)
+{
+    std::ifstream ifs(filename, std::ios::binary);
+    if (!ifs)
+        return 0;
+
+    // 64 bit FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    std::vector<char> chunk(HashChunkSize);
+    while (ifs)
+    {
+        ifs.read(chunk.data(), chunk.size());
+        const std::streamsize ReadSize = ifs.gcount();
+        for (std::streamsize i = 0; i < ReadSize; ++i)
+        {
+            hash ^= static_cast<uint8_t>(chunk[i]);
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+bool CookedAsset::IsUpToDate(const std::string& cookedFilename, uint64_t sourceHash)
+{
+    std::ifstream ifs(cookedFilename, std::ios::binary);
+    AssetHeader header;
+    return ifs && ReadHeader(ifs, header) && header.cookerVersion == CookerVersion && header.sourceHash == sourceHash;
+}
+
+bool CookedAsset::Write(const std::string& cookedFilename, uint64_t sourceHash, const std::vector<std::shared_ptr<Object>>& objects)
+{
+    // Written aside and moved in place once complete, so a failed cook never leaves a file that looks up to date.
+    const std::string TemporaryFilename = cookedFilename + ".tmp";
+    {
+        std::ofstream ofs(TemporaryFilename, std::ios::binary);
+        if (!ofs)
+        {
+            std::cout << "CookedAsset::Write() : can't open " << TemporaryFilename << std::endl;
+            return false;
+        }
+
+        Serialization::Write(ofs, AssetMagic);
+        Serialization::Write(ofs, static_cast<uint32_t>(CookerVersion));
+        Serialization::Write(ofs, sourceHash);
+        const int ObjectCount = static_cast<int>(objects.size());
+        Serialization::Write(ofs, ObjectCount);
+        for (const std::shared_ptr<Object>& pObject : objects)
+        {
+            pObject->Serialize(ofs);
+        }
+
+        if (!ofs)
+        {
+            std::cout << "CookedAsset::Write() : can't write " << TemporaryFilename << std::endl;
+            ofs.close();
+            std::remove(TemporaryFilename.c_str());
+            return false;
+        }
+    }
+
+    std::remove(cookedFilename.c_str());
+    if (std::rename(TemporaryFilename.c_str(), cookedFilename.c_str()) != 0)
+    {
+        std::cout << "CookedAsset::Write() : can't move " << TemporaryFilename << " to " << cookedFilename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool CookedAsset::Read(const std::string& cookedFilename, uint64_t sourceHash, std::vector<std::shared_ptr<Object>>& objects)
+{
+    std::ifstream ifs(cookedFilename, std::ios::binary);
+    if (!ifs)
+        return false;
+
+    AssetHeader header;
+    if (!ReadHeader(ifs, header) || header.cookerVersion != CookerVersion)
+    {
+        std::cout << "CookedAsset::Read() : " << cookedFilename << " is not a cooked asset of cooker version " << CookerVersion << std::endl;
+        return false;
+    }
+    // Checked again here, as the file may have been cooked again since IsUpToDate().
+    if (sourceHash != 0 && header.sourceHash != sourceHash)
+    {
+        std::cout << "CookedAsset::Read() : " << cookedFilename << " was cooked from another version of its source" << std::endl;
+        return false;
+    }
+
+    int objectCount = 0;
+    Serialization::Read(ifs, objectCount);
+    if (!ifs || objectCount < 0)
+    {
+        std::cout << "CookedAsset::Read() : " << cookedFilename << " is corrupt" << std::endl;
+        return false;
+    }
+
+    // Objects are kept only if all of them are read. GL objects of partially read ones are released, as nothing else
+    // refers to them.
+    std::vector<std::shared_ptr<Object>> loaded;
+    for (int i = 0; i < objectCount && ifs; ++i)
+    {
+        std::shared_ptr<Object> pObject(new Object);
+        pObject->Deserialize(ifs);
+        loaded.push_back(pObject);
+    }
+    if (!ifs)
+    {
+        std::cout << "CookedAsset::Read() : " << cookedFilename << " is corrupt" << std::endl;
+        for (std::shared_ptr<Object>& pObject : loaded)
+        {
+            pObject->Free();
+        }
+        return false;
+    }
+
+    objects.insert(objects.end(), loaded.begin(), loaded.end());
+    return true;
+}
@@ -0,0 +1,55 @@
+/*
+    CookedAsset.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    References :
+        http://www.isthe.com/chongo/tech/comp/fnv/index.html
+
+    CookedAsset class definition.
+*/
+#ifndef COOKED_ASSET_H_
+#define COOKED_ASSET_H_
+
+class Object;
+
+//
+// class CookedAsset
+//
+// Binary file of objects imported from a source asset( fbx ), ready to be loaded without FBX SDK:
+// triangulated meshes, packed bone influences, skeleton, animation and materials with decoded texture maps.
+// The file starts with a header( magic, cooker version, hash of the source file ) followed by objects( Object::Serialize ).
+//
+// A cooked asset is up to date while both the hash of its source and the cooker version match its header.
+// Bump CookerVersion whenever serialization of anything an Object holds changes, so older files are cooked again.
+// AssetCooker makes cooked assets.
+//
+// usage:
+//  std::vector<std::shared_ptr<Object>> objects;
+//  if (CookedAsset::IsUpToDate(CookedAsset::GetCookedFilename(source), CookedAsset::HashFile(source)))
+//      CookedAsset::Read(CookedAsset::GetCookedFilename(source), CookedAsset::HashFile(source), objects);
+//
+class CookedAsset
+{
+public:
+    enum : uint32_t { CookerVersion = 5 };
+
+    // Where the cooked asset of 'sourceFilename' is kept. Next to the source.
+    static std::string GetCookedFilename(const std::string& sourceFilename);
+
+    // 64 bit FNV-1a of contents of 'filename'. 0 if it can't be read.
+    static uint64_t HashFile(const std::string& filename);
+
+    // True if 'cookedFilename' exists and was cooked from source of hash 'sourceHash' by this version of the cooker.
+    static bool IsUpToDate(const std::string& cookedFilename, uint64_t sourceHash);
+
+    // Writes 'objects' to 'cookedFilename' with header of this cooker version and 'sourceHash'.
+    // Needs GL context; texture maps are read back from their texture objects.
+    static bool Write(const std::string& cookedFilename, uint64_t sourceHash, const std::vector<std::shared_ptr<Object>>& objects);
+
+    // Appends objects in 'cookedFilename' to 'objects'. Fails if the file is not a cooked asset of this cooker version,
+    // was cooked from source other than 'sourceHash'( unless it is 0 ) or is corrupt; 'objects' is left as it was then.
+    static bool Read(const std::string& cookedFilename, uint64_t sourceHash, std::vector<std::shared_ptr<Object>>& objects);
+};
+
+#endif
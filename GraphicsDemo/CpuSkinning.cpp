@@ -0,0 +1,189 @@
+/*
+    CpuSkinning.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    References :
+        https://software.intel.com/sites/landingpage/IntrinsicsGuide/
+
+    CpuSkinning class implementation.
+*/
+#include "Common.h"
+#include "CpuSkinning.h"
+
+namespace
+{
+#ifdef GD_USE_SSE
+    static_assert(sizeof(glm::mat4) == sizeof(float) * 16, "glm::mat4 is expected to be 16 packed floats");
+
+    // Column 'column' of weighted sum of palette matrices of 4 bones.
+    inline __m128 BlendColumn(const float* const pMs[4], const __m128 ws[4], int column)
+    {
+        const int Offset = column * 4;
+        return _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(pMs[0] + Offset), ws[0]), _mm_mul_ps(_mm_loadu_ps(pMs[1] + Offset), ws[1])),
+            _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(pMs[2] + Offset), ws[2]), _mm_mul_ps(_mm_loadu_ps(pMs[3] + Offset), ws[3])));
+    }
+
+    // c0 * x + c1 * y + c2 * z
+    inline __m128 TransformVector(__m128 c0, __m128 c1, __m128 c2, const float* pV)
+    {
+        return _mm_add_ps(_mm_add_ps(
+            _mm_mul_ps(c0, _mm_set1_ps(pV[0])),
+            _mm_mul_ps(c1, _mm_set1_ps(pV[1]))),
+            _mm_mul_ps(c2, _mm_set1_ps(pV[2])));
+    }
+
+    // Stores x, y, z of 'v'. Writing 4 floats is faster but spills into the next vertex,
+    // so it is only done when the next vertex belongs to the same range and is written afterwards.
+    inline void Store3(float* pOut, __m128 v, bool spillAllowed)
+    {
+        if (spillAllowed)
+        {
+            _mm_storeu_ps(pOut, v);
+        }
+        else
+        {
+            float temp[4];
+            _mm_storeu_ps(temp, v);
+            pOut[0] = temp[0];
+            pOut[1] = temp[1];
+            pOut[2] = temp[2];
+        }
+    }
+#endif
+}
+
+CpuSkinning::Source::Source()
+    : vertexCount(0)
+    , positions()
+    , normals()
+    , tangents()
+    , bones()
+    , weights()
+{
+}
+
+void CpuSkinning::Output::Resize(const Source& source)
+{
+    positions.resize(source.positions.size());
+    normals.resize(source.normals.size());
+    tangents.resize(source.tangents.size());
+}
+
+bool CpuSkinning::IsSimdEnabled()
+{
+#ifdef GD_USE_SSE
+    return true;
+#else
+    return false;
+#endif
+}
+
+void CpuSkinning::SkinRange(const Source& source, const glm::mat4* pPalette, int begin, int end, Output& out)
+{
+#ifdef GD_USE_SSE
+    assert(0 <= begin && begin <= end && end <= source.vertexCount);
+    assert(out.positions.size() == source.positions.size());
+
+    const bool HasNormals = !source.normals.empty();
+    const bool HasTangents = !source.tangents.empty();
+    const float* pPaletteFloats = &pPalette[0][0][0];
+    for (int i = begin; i < end; ++i)
+    {
+        const int* pBones = &source.bones[i * BonesPerVertex];
+        const float* pWeights = &source.weights[i * BonesPerVertex];
+        static_assert(BonesPerVertex == 4, "SSE path blends 4 matrices");
+        const float* const pMs[BonesPerVertex] = {
+            pPaletteFloats + pBones[0] * 16,
+            pPaletteFloats + pBones[1] * 16,
+            pPaletteFloats + pBones[2] * 16,
+            pPaletteFloats + pBones[3] * 16 };
+        const __m128 Ws[BonesPerVertex] = {
+            _mm_set1_ps(pWeights[0]),
+            _mm_set1_ps(pWeights[1]),
+            _mm_set1_ps(pWeights[2]),
+            _mm_set1_ps(pWeights[3]) };
+
+        const __m128 C0 = BlendColumn(pMs, Ws, 0);
+        const __m128 C1 = BlendColumn(pMs, Ws, 1);
+        const __m128 C2 = BlendColumn(pMs, Ws, 2);
+        const __m128 C3 = BlendColumn(pMs, Ws, 3);
+
+        const bool SpillAllowed = i + 1 < end;
+        const __m128 Position = _mm_add_ps(TransformVector(C0, C1, C2, &source.positions[i * 3]), C3);
+        Store3(&out.positions[i * 3], Position, SpillAllowed);
+
+        if (HasNormals)
+        {
+            Store3(&out.normals[i * 3], TransformVector(C0, C1, C2, &source.normals[i * 3]), SpillAllowed);
+        }
+
+        if (HasTangents)
+        {
+            const float* pTangent = &source.tangents[i * 4];
+            float* pOutTangent = &out.tangents[i * 4];
+            // Handedness is kept as it is.
+            const float Handedness = pTangent[3];
+            _mm_storeu_ps(pOutTangent, TransformVector(C0, C1, C2, pTangent));
+            pOutTangent[3] = Handedness;
+        }
+    }
+#else
+    SkinRangeScalar(source, pPalette, begin, end, out);
+#endif
+}
+
+void CpuSkinning::SkinRangeScalar(const Source& source, const glm::mat4* pPalette, int begin, int end, Output& out)
+{
+    assert(0 <= begin && begin <= end && end <= source.vertexCount);
+    assert(out.positions.size() == source.positions.size());
+
+    const bool HasNormals = !source.normals.empty();
+    const bool HasTangents = !source.tangents.empty();
+    for (int i = begin; i < end; ++i)
+    {
+        glm::mat4 jointTransform(0.0f);
+        for (int j = 0; j < BonesPerVertex; ++j)
+        {
+            jointTransform += pPalette[source.bones[i * BonesPerVertex + j]] * source.weights[i * BonesPerVertex + j];
+        }
+
+        const glm::vec4 Position = jointTransform * glm::vec4(source.positions[i * 3], source.positions[i * 3 + 1], source.positions[i * 3 + 2], 1.0f);
+        out.positions[i * 3] = Position.x;
+        out.positions[i * 3 + 1] = Position.y;
+        out.positions[i * 3 + 2] = Position.z;
+
+        if (HasNormals)
+        {
+            const glm::vec4 Normal = jointTransform * glm::vec4(source.normals[i * 3], source.normals[i * 3 + 1], source.normals[i * 3 + 2], 0.0f);
+            out.normals[i * 3] = Normal.x;
+            out.normals[i * 3 + 1] = Normal.y;
+            out.normals[i * 3 + 2] = Normal.z;
+        }
+
+        if (HasTangents)
+        {
+            const glm::vec4 Tangent = jointTransform * glm::vec4(source.tangents[i * 4], source.tangents[i * 4 + 1], source.tangents[i * 4 + 2], 0.0f);
+            out.tangents[i * 4] = Tangent.x;
+            out.tangents[i * 4 + 1] = Tangent.y;
+            out.tangents[i * 4 + 2] = Tangent.z;
+            out.tangents[i * 4 + 3] = source.tangents[i * 4 + 3];
+        }
+    }
+}
+
+void CpuSkinning::CopyBindPose(const Source& source, int begin, int end, Output& out)
+{
+    assert(0 <= begin && begin <= end && end <= source.vertexCount);
+
+    std::copy(source.positions.begin() + begin * 3, source.positions.begin() + end * 3, out.positions.begin() + begin * 3);
+    if (!source.normals.empty())
+    {
+        std::copy(source.normals.begin() + begin * 3, source.normals.begin() + end * 3, out.normals.begin() + begin * 3);
+    }
+    if (!source.tangents.empty())
+    {
+        std::copy(source.tangents.begin() + begin * 4, source.tangents.begin() + end * 4, out.tangents.begin() + begin * 4);
+    }
+}
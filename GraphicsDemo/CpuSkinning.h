@@ -0,0 +1,81 @@
+/*
+    CpuSkinning.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    References :
+        https://software.intel.com/sites/landingpage/IntrinsicsGuide/
+
+    Dependencies :
+        glm - vector, matrix representation
+        SSE2 - (optional) 4-wide path. Enabled when Common.h defines GD_USE_SSE.
+
+    CpuSkinning class definition.
+*/
+#ifndef CPU_SKINNING_H_
+#define CPU_SKINNING_H_
+
+//
+// class CpuSkinning
+//
+// Skins vertex streams with a bone palette on CPU, doing what phong.vert does when animation is enabled:
+// every vertex is transformed by the weighted sum of palette matrices of its bones.
+// Kernels work on a vertex range, so a mesh can be split across JobSystem workers; ranges write disjoint output.
+// The SSE path keeps blended matrix columns in registers; the scalar path is written in plain glm
+// the way the shader is, and serves as reference for both.
+//
+// usage:
+//  CpuSkinning::Output output;
+//  output.Resize(source);
+//  CpuSkinning::SkinRange(source, pAnimator->GetPalette(), 0, source.vertexCount, output);
+//
+class CpuSkinning
+{
+public:
+    // Number of bones that affect a vertex. Matches MaximumWeights of phong.vert and BoneInfluences::ComponentCount.
+    static const int BonesPerVertex = 4;
+
+    // Bind pose vertex streams. Same layout as attribute arrays of Mesh.
+    struct Source
+    {
+        Source();
+
+        int vertexCount;
+        // 3 floats per vertex
+        std::vector<float> positions;
+        // 3 floats per vertex
+        std::vector<float> normals;
+        // 4 floats per vertex; w is handedness of bitangent. Empty if mesh has no tangents.
+        std::vector<float> tangents;
+        // BonesPerVertex bone indices per vertex
+        std::vector<int> bones;
+        // BonesPerVertex weights per vertex
+        std::vector<float> weights;
+    };
+
+    // Skinned vertex streams. Same layout as the matching streams of Source.
+    struct Output
+    {
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<float> tangents;
+
+        // Sizes streams for 'source'.
+        void Resize(const Source& source);
+    };
+
+    // Skins vertices [begin, end) of 'source' with 'pPalette' into the same vertices of 'out'.
+    // 'out' must be sized by Output::Resize(). Bone indices of 'source' must be within 'pPalette'.
+    static void SkinRange(const Source& source, const glm::mat4* pPalette, int begin, int end, Output& out);
+
+    // Same as 'SkinRange' but never takes the SSE path.
+    static void SkinRangeScalar(const Source& source, const glm::mat4* pPalette, int begin, int end, Output& out);
+
+    // Copies bind pose of vertices [begin, end) to 'out'. For objects that have no palette yet.
+    static void CopyBindPose(const Source& source, int begin, int end, Output& out);
+
+    // Returns true if 'SkinRange' runs the SSE path on this build.
+    static bool IsSimdEnabled();
+};
+
+#endif
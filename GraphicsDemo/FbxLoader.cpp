@@ -37,11 +37,15 @@
 #include "PerspectiveCamera.h"
 #include "Material.h"
 #include "Mesh.h"
-#include "stb_image.h"
+#include "VertexWelder.h"
+#include "MeshOptimizer.h"
 #include "Skeleton.h"
 #include "Bone.h"
 #include "Animation.h"
 #include "Animator.h"
+#include "BoneInfluences.h"
+#include "JobSystem.h"
+#include "TextureLoader.h"
 
 namespace
 {
@@ -53,9 +57,11 @@ namespace
         COMPONENT_COUNT_POSITION = 3,
         COMPONENT_COUNT_UV = 2,
         COMPONENT_COUNT_NORMAL = 3,
-        COMPONENT_COUNT_BONE = 3,
-        COMPONENT_COUNT_WEIGHT = 3,
         COMPONENT_COUNT_TANGENT = 4,
+        // Corner is position, uv, normal, tangent handedness and tangent direction. Corners weld on all but tangent direction,
+        // which differs per triangle; directions of welded corners are averaged instead.
+        COMPONENT_COUNT_WELD_KEY = COMPONENT_COUNT_POSITION + COMPONENT_COUNT_UV + COMPONENT_COUNT_NORMAL + 1,
+        COMPONENT_COUNT_CORNER = COMPONENT_COUNT_WELD_KEY + 3,
     };
     
     void TraverseFbxNodeDepthFirst(FbxNode* pNode, std::function<void(FbxNode* node, int depth)> delegator, int depth = 0)
@@ -70,65 +76,6 @@ namespace
         }
     }
 
-    struct BoneWeight
-    {
-        BoneWeight(int boneIndex, float weight)
-            : boneIndex(boneIndex)
-            , weight(weight)
-        {
-        }
-
-        int boneIndex;
-        float weight;
-    };
-
-    // 
-    // Dependency : stb_image.h 
-    // Loads texture file and generates 2D OpenGL texture object
-    // 
-    bool LoadTextureFromFile(const FbxString & pFilePath, unsigned int & pTextureObject)
-    {
-        // OpenGL Texture pixel data must start from bottom-left whereas actual file data usually has data starting from top-left
-        stbi_set_flip_vertically_on_load(true);
-
-        int imageWidth, imageHeight, channelCount;
-
-        unsigned char* data = stbi_load(pFilePath.Buffer(), &imageWidth, &imageHeight, &channelCount, 0);
-
-        // Transfer the texture date into GPU
-        glGenTextures(1, &pTextureObject);
-        GET_AND_HANDLE_GL_ERROR();
-        glBindTexture(GL_TEXTURE_2D, pTextureObject);
-        GET_AND_HANDLE_GL_ERROR();
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        GET_AND_HANDLE_GL_ERROR();
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        GET_AND_HANDLE_GL_ERROR();
-        // RGB
-        if (channelCount == 3)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, imageWidth, imageHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        }
-        // RGBA
-        else if (channelCount == 4)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, imageWidth, imageHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        }
-        else
-        {
-            // GRAY -> channel count == 1
-            // GRAY ALPHA -> channel count == 2
-            std::cout << "Not supported" << std::endl;
-        }
-
-        glBindTexture(GL_TEXTURE_2D, 0);
-        GET_AND_HANDLE_GL_ERROR();
-
-        stbi_image_free(data);
-
-        return true;
-    }
-
     void LoadRecursive(FbxNode* pFbxNode)
     {
         
@@ -259,9 +206,15 @@ namespace
 
 }
 
+// Well below differences that show between normals or uvs of real seams
+const float FbxLoader::DefaultVertexWeldEpsilon = 1e-5f;
+
 FbxLoader::FbxLoader()
     : m_pFbxManager(nullptr)
     , m_pScene(nullptr)
+    , m_maximumBoneInfluenceCount(BoneInfluences::ComponentCount)
+    , m_boneWeightPrecision(BoneInfluences::WP_UNORM8)
+    , m_vertexWeldEpsilon(DefaultVertexWeldEpsilon)
 {
     //The first thing to do is to create the FBX Manager which is the object allocator for almost all the classes in the SDK
     m_pFbxManager = FbxManager::Create();
@@ -415,6 +368,9 @@ void FbxLoader::LoadTextures()
 {
     assert(m_pScene != nullptr);
 
+    // Texture files are decoded on JobSystem workers and uploaded here as they finish.
+    TextureLoader loader;
+    std::vector<std::string> filenames;
     const int TextureCount = m_pScene->GetTextureCount();
     for (int ti = 0; ti < TextureCount; ++ti)
     {
@@ -426,46 +382,39 @@ void FbxLoader::LoadTextures()
             const FbxString AbsoluteFileName = FbxPathUtils::Resolve(Filename);
             const FbxString AbsoluteFolderName = FbxPathUtils::GetFolderName(AbsoluteFileName);
 
-            FbxString resolvedName = Filename;
-
 #ifndef NDEBUG
             std::cout << "Loading Texture at index " << ti << ": " << Filename << std::endl;
 #endif
-            GLuint textureObject = 0;
-            bool success = LoadTextureFromFile(resolvedName, textureObject);
-
-            if (!success)
-            {
-#ifndef NDEBUG
-                std::cout << "Load texture from relative file name (relative to FBX file)" << std::endl;
-#endif
-                resolvedName = FbxPathUtils::Bind(AbsoluteFolderName, pFileTexture->GetRelativeFileName());
-                success = LoadTextureFromFile(resolvedName, textureObject);
-            }
+            // File name given by fbx file, then relative file name( relative to FBX file ), then file name only( relative to FBX file )
+            const FbxString RelativeName = FbxPathUtils::Bind(AbsoluteFolderName, pFileTexture->GetRelativeFileName());
+            const FbxString FileNameOnly = FbxPathUtils::Bind(AbsoluteFolderName, FbxPathUtils::GetFileName(Filename));
+            const std::vector<std::string> Candidates = { Filename.Buffer(), RelativeName.Buffer(), FileNameOnly.Buffer() };
+
+            // OpenGL Texture pixel data must start from bottom-left whereas actual file data usually has data starting from top-left
+            loader.Add(Candidates, true);
+            filenames.push_back(Filename.Buffer());
+        }
+    }
 
-            if (!success)
-            {
-#ifndef NDEBUG
-                std::cout << "Load texture from file name only (relative to FBX file)" << std::endl;
-#endif
-                const FbxString textureFileName = FbxPathUtils::GetFileName(Filename);
-                const FbxString loadName = FbxPathUtils::Bind(AbsoluteFolderName, textureFileName);
-                success = LoadTextureFromFile(loadName, textureObject);
-            }
+    std::vector<GLuint> textureObjects(filenames.size(), 0);
+    std::vector<std::string> resolvedNames(filenames.size());
+    loader.Load([&textureObjects, &resolvedNames](int request, const TextureLoader::Image& image)
+    {
+        textureObjects[request] = TextureLoader::CreateTexture2D(image);
+        resolvedNames[request] = image.filename;
+    });
 
-            if (!success)
-            {
-                std::cerr << "Failed to load texture file: " << Filename << std::endl;
-                continue;
-            }
-            
-            assert(success);
-            if (success)
-            {
-                TextureCache textureCache(std::string(Filename), std::string(resolvedName.Buffer()), textureObject);
-                m_textures.push_back(textureCache);
-            }
+    // Kept in scene order, whichever finished decoding first.
+    for (size_t i = 0; i < filenames.size(); ++i)
+    {
+        if (textureObjects[i] == 0)
+        {
+            std::cerr << "Failed to load texture file: " << filenames[i] << std::endl;
+            continue;
         }
+
+        TextureCache textureCache(filenames[i], resolvedNames[i], textureObjects[i]);
+        m_textures.push_back(textureCache);
     }
 }
 
@@ -534,66 +483,374 @@ void FbxLoader::LoadSkeleton()
     });
 }
 
-void FbxLoader::LoadMesh()
+namespace
 {
-    assert(m_pScene != nullptr);
+    // Polygons one extraction job converts. Meshes larger than this are split over several jobs.
+    const int PolygonsPerJob = 4096;
+
+    //
+    // Normals or uvs of a mesh, copied out of its layer element. Read the way FbxMesh::GetPolygonVertexNormal() and
+    // GetPolygonVertexUV() read them: by control point or by polygon vertex, directly or through the index array.
+    // Elements of other mappings are left empty and read as zero.
+    //
+    struct ElementData
+    {
+        bool byControlPoint = false;
+        int componentCount = 0;
+        std::vector<double> values;
+        // Index into 'values' of each control point or polygon vertex. Empty if values are in that order already.
+        std::vector<int> indices;
+
+        // Writes 'componentCount' components of the value at 'controlPoint' / 'polygonVertex' to 'pOut'.
+        void Read(int controlPoint, int polygonVertex, double* pOut) const
+        {
+            int index = byControlPoint ? controlPoint : polygonVertex;
+            if (!indices.empty())
+            {
+                index = (index >= 0 && index < static_cast<int>(indices.size())) ? indices[index] : -1;
+            }
+            const bool Valid = componentCount != 0 && index >= 0 && index < static_cast<int>(values.size()) / componentCount;
+            for (int i = 0; i < componentCount; ++i)
+            {
+                pOut[i] = Valid ? values[index * componentCount + i] : 0.0;
+            }
+        }
+    };
 
-    FbxNode* pRootNode = m_pScene->GetRootNode();
-    TraverseFbxNodeDepthFirst(pRootNode, [this](FbxNode* pNode, int depth)
+    //
+    // Mesh node on its way from FbxMesh to Mesh. FbxLoader::LoadMesh() copies everything it needs out of FBX on the loading
+    // thread( CopyMesh() ), as the FBX SDK promises nothing about calling it from several threads. GroupPolygons(),
+    // ExtractCorners() and WeldMesh() then build vertex streams from the copies on JobSystem workers, and only uploading
+    // the streams, back on the loading thread, touches GL.
+    //
+    struct MeshExtraction
     {
-        FbxNodeAttribute* pAttribute = pNode->GetNodeAttribute();
+        std::string name;
+        // xyz of each control point
+        std::vector<double> controlPoints;
+        // Control point of each polygon vertex, and first polygon vertex of each polygon. Polygons are triangles.
+        std::vector<int> polygonVertices;
+        std::vector<int> polygonStarts;
+        ElementData normalElement;
+        ElementData uvElement;
+        // Material of each polygon. Empty if polygons have no material, in which case the mesh has no sub meshes.
+        std::vector<int> polygonMaterials;
+        std::vector<std::vector<BoneInfluences::Influence>> controlPointInfluences;
+
+        // Polygons grouped by material, in material order
+        std::vector<int> polygons;
+        // Material index and polygon count of each sub mesh
+        std::vector<std::pair<int, int>> subMeshes;
+        // COMPONENT_COUNT_CORNER floats and control point of each corner of 'polygons'
+        std::vector<float> corners;
+        std::vector<int> cornerControlPoints;
+
+        // Vertex streams
+        std::vector<float> positions;
+        std::vector<float> uvs;
+        std::vector<float> normals;
+        std::vector<float> tangents;
+        BoneInfluences influences;
+        std::vector<uint32_t> indices;
+        // Printed by the loading thread, so that logs of meshes don't interleave.
+        std::string log;
+    };
 
-        // Attribute can be absent.
-        if (!pAttribute)
+    struct CornerJob
+    {
+        MeshExtraction* pMesh;
+        int begin;
+        int end;
+    };
+
+    // Groups polygons by material, one sub mesh per material.
+    void GroupPolygons(MeshExtraction& mesh)
+    {
+        std::map<int, std::vector<int>> submeshes;
+        const int PolygonCount = static_cast<int>(mesh.polygonMaterials.size());
+        for (int pi = 0; pi < PolygonCount; ++pi)
+        {
+            submeshes[mesh.polygonMaterials[pi]].push_back(pi);
+        }
+        for (std::map<int, std::vector<int>>::iterator it = submeshes.begin(); it != submeshes.end(); ++it)
+        {
+            mesh.subMeshes.push_back(std::make_pair(it->first, static_cast<int>(it->second.size())));
+            mesh.polygons.insert(mesh.polygons.end(), it->second.begin(), it->second.end());
+        }
+
+        const size_t CornerCount = mesh.polygons.size() * TRIANGLE_VERTEX_COUNT;
+        mesh.corners.resize(CornerCount * COMPONENT_COUNT_CORNER);
+        mesh.cornerControlPoints.resize(CornerCount);
+    }
+
+    // Converts polygons [begin, end) of 'mesh.polygons' into corners: position, uv, normal and tangent.
+    void ExtractCorners(MeshExtraction& mesh, int begin, int end)
+    {
+        for (int polygon = begin; polygon < end; ++polygon)
+        {
+            const int i = mesh.polygons[polygon];
+            const int PolygonStart = mesh.polygonStarts[i];
+
+            glm::dvec3 p[TRIANGLE_VERTEX_COUNT];
+            glm::dvec3 n[TRIANGLE_VERTEX_COUNT];
+            glm::dvec2 uv[TRIANGLE_VERTEX_COUNT];
+            int ips[TRIANGLE_VERTEX_COUNT];
+            for (int k = 0; k < TRIANGLE_VERTEX_COUNT; ++k)
+            {
+                const int PolygonVertex = PolygonStart + k;
+                ips[k] = mesh.polygonVertices[PolygonVertex];
+                p[k] = glm::dvec3(mesh.controlPoints[ips[k] * 3], mesh.controlPoints[ips[k] * 3 + 1], mesh.controlPoints[ips[k] * 3 + 2]);
+                mesh.normalElement.Read(ips[k], PolygonVertex, &n[k].x);
+                mesh.uvElement.Read(ips[k], PolygonVertex, &uv[k].x);
+            }
+
+            // ref - http://www.terathon.com/code/tangent.html
+
+            const glm::dvec3 q1 = p[1] - p[0];
+            const glm::dvec3 q2 = p[2] - p[0];
+            const glm::dvec2 duv1 = uv[1] - uv[0];
+            const glm::dvec2 duv2 = uv[2] - uv[0];
+            const double s1 = duv1[0];
+            const double t1 = duv1[1];
+            const double s2 = duv2[0];
+            const double t2 = duv2[1];
+            const double determinant = 1.0 / (s1 * t2 - t1 * s2);
+            const glm::dvec3 tangent = (q1 * t2 + q2 * -t1) / determinant;
+            const glm::dvec3 bitangent = (q1 * -s2 + q2 * s1) / determinant;
+
+            for (int k = 0; k < TRIANGLE_VERTEX_COUNT; ++k)
+            {
+                glm::dvec3 vertexTangent = tangent - n[k] * glm::dot(tangent, n[k]);
+                const glm::dvec3 vertexBitangent = bitangent - n[k] * glm::dot(n[k], bitangent) - vertexTangent * glm::dot(vertexTangent, bitangent) / glm::dot(vertexTangent, vertexTangent);
+                const double TangentLength = glm::length(vertexTangent);
+                if (TangentLength > 0.0)
+                {
+                    vertexTangent /= TangentLength;
+                }
+                const glm::dvec3 generatedBitangent = glm::cross(n[k], vertexTangent);
+
+                const int Corner = polygon * TRIANGLE_VERTEX_COUNT + k;
+                float* pVertex = &mesh.corners[Corner * COMPONENT_COUNT_CORNER];
+                *pVertex++ = static_cast<float>(p[k][0]); *pVertex++ = static_cast<float>(p[k][1]); *pVertex++ = static_cast<float>(p[k][2]);
+                *pVertex++ = static_cast<float>(uv[k][0]); *pVertex++ = static_cast<float>(uv[k][1]);
+                *pVertex++ = static_cast<float>(n[k][0]); *pVertex++ = static_cast<float>(n[k][1]); *pVertex++ = static_cast<float>(n[k][2]);
+                *pVertex++ = static_cast<float>(glm::dot(generatedBitangent, vertexBitangent) < 0.0 ? -1.f : 1.f);
+                *pVertex++ = static_cast<float>(vertexTangent[0]); *pVertex++ = static_cast<float>(vertexTangent[1]); *pVertex++ = static_cast<float>(vertexTangent[2]);
+                mesh.cornerControlPoints[Corner] = ips[k];
+            }
+        }
+    }
+
+    // Welds corners into vertex streams and indices, then reorders them for vertex cache.
+    void WeldMesh(MeshExtraction& mesh, float weldEpsilon)
+    {
+        const int CornerCount = static_cast<int>(mesh.cornerControlPoints.size());
+        mesh.positions.reserve(CornerCount * COMPONENT_COUNT_POSITION);
+        mesh.uvs.reserve(CornerCount * COMPONENT_COUNT_UV);
+        mesh.normals.reserve(CornerCount * COMPONENT_COUNT_NORMAL);
+        mesh.tangents.reserve(CornerCount * COMPONENT_COUNT_TANGENT);
+        mesh.indices.reserve(CornerCount);
+        // Bone influences are added once vertices are in their final order.
+        std::vector<int> vertexControlPoints; vertexControlPoints.reserve(CornerCount);
+
+        // Corners sharing control point, normal, uv and tangent handedness become one vertex.
+        // Control point stands for position and bone influences, which come from it.
+        VertexWelder welder(COMPONENT_COUNT_WELD_KEY, weldEpsilon);
+        welder.Reserve(CornerCount);
+        for (int corner = 0; corner < CornerCount; ++corner)
+        {
+            const float* pVertex = &mesh.corners[corner * COMPONENT_COUNT_CORNER];
+            const uint32_t VertexCount = static_cast<uint32_t>(welder.GetVertexCount());
+            const uint32_t Index = welder.Add(pVertex, mesh.cornerControlPoints[corner]);
+            mesh.indices.push_back(Index);
+            if (Index == VertexCount)
+            {
+                const float* pComponent = pVertex;
+                mesh.positions.insert(mesh.positions.end(), pComponent, pComponent + COMPONENT_COUNT_POSITION); pComponent += COMPONENT_COUNT_POSITION;
+                mesh.uvs.insert(mesh.uvs.end(), pComponent, pComponent + COMPONENT_COUNT_UV); pComponent += COMPONENT_COUNT_UV;
+                mesh.normals.insert(mesh.normals.end(), pComponent, pComponent + COMPONENT_COUNT_NORMAL); pComponent += COMPONENT_COUNT_NORMAL;
+                const float Tangent[COMPONENT_COUNT_TANGENT] = { 0.0f, 0.0f, 0.0f, *pComponent };
+                mesh.tangents.insert(mesh.tangents.end(), Tangent, Tangent + COMPONENT_COUNT_TANGENT);
+                vertexControlPoints.push_back(mesh.cornerControlPoints[corner]);
+            }
+
+            // Sum of tangent directions
+            const float* pTangent = pVertex + COMPONENT_COUNT_WELD_KEY;
+            float* pVertexTangent = &mesh.tangents[Index * COMPONENT_COUNT_TANGENT];
+            pVertexTangent[0] += pTangent[0];
+            pVertexTangent[1] += pTangent[1];
+            pVertexTangent[2] += pTangent[2];
+        }
+        // Corners are not needed anymore.
+        std::vector<float>().swap(mesh.corners);
+        std::vector<int>().swap(mesh.cornerControlPoints);
+
+        // Averaged tangents are made unit and perpendicular to the normal again.
+        const int VertexCount = welder.GetVertexCount();
+        for (int i = 0; i < VertexCount; ++i)
+        {
+            const glm::vec3 Normal = glm::make_vec3(&mesh.normals[i * COMPONENT_COUNT_NORMAL]);
+            float* pTangent = &mesh.tangents[i * COMPONENT_COUNT_TANGENT];
+            glm::vec3 tangent = glm::make_vec3(pTangent);
+            tangent -= Normal * glm::dot(Normal, tangent);
+            const float Length = glm::length(tangent);
+            if (Length > 1e-6f)
+            {
+                tangent /= Length;
+            }
+            else
+            {
+                // Tangents of welded corners cancel out; any direction on the surface will do.
+                tangent = glm::normalize(glm::cross(Normal, std::abs(Normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f)));
+            }
+            pTangent[0] = tangent.x;
+            pTangent[1] = tangent.y;
+            pTangent[2] = tangent.z;
+        }
+
+        std::ostringstream log;
+        log << " Mesh '" << mesh.name << "' vertices : " << VertexCount << " unique of " << mesh.indices.size() << " corners" << std::endl;
+
+        // Triangles are reordered within each sub mesh, so material ranges hold.
+        int subMeshBegin = 0;
+        for (const std::pair<int, int>& subMesh : mesh.subMeshes)
+        {
+            const int IndexCount = subMesh.second * TRIANGLE_VERTEX_COUNT;
+            uint32_t* pSubMeshIndices = mesh.indices.data() + subMeshBegin;
+            const MeshOptimizer::Statistics Before = MeshOptimizer::Measure(pSubMeshIndices, IndexCount);
+            MeshOptimizer::OptimizeTriangleOrder(pSubMeshIndices, IndexCount, welder.GetVertexCount(), mesh.positions.data());
+            const MeshOptimizer::Statistics After = MeshOptimizer::Measure(pSubMeshIndices, IndexCount);
+            log << " Mesh '" << mesh.name << "' material " << subMesh.first << " : "
+                << "ACMR " << Before.acmr << " -> " << After.acmr << ", ATVR " << Before.atvr << " -> " << After.atvr << std::endl;
+            subMeshBegin += IndexCount;
+        }
+
+        std::vector<uint32_t> newToOld;
+        MeshOptimizer::OptimizeVertexOrder(mesh.indices, welder.GetVertexCount(), newToOld);
+        MeshOptimizer::RemapVertices(mesh.positions, COMPONENT_COUNT_POSITION, newToOld);
+        MeshOptimizer::RemapVertices(mesh.uvs, COMPONENT_COUNT_UV, newToOld);
+        MeshOptimizer::RemapVertices(mesh.normals, COMPONENT_COUNT_NORMAL, newToOld);
+        MeshOptimizer::RemapVertices(mesh.tangents, COMPONENT_COUNT_TANGENT, newToOld);
+        MeshOptimizer::RemapVertices(vertexControlPoints, 1, newToOld);
+        mesh.influences.Reserve(static_cast<int>(vertexControlPoints.size()));
+        for (int controlPoint : vertexControlPoints)
+        {
+            mesh.influences.AddVertex(mesh.controlPointInfluences[controlPoint]);
+        }
+
+#ifndef NDEBUG
+        log << " Bone influences : " << mesh.influences.GetBytesPerVertex() << " bytes per vertex, largest dropped weight "
+            << mesh.influences.GetMaximumDroppedWeight() << std::endl;
+#endif
+        mesh.log += log.str();
+    }
+
+    // Copies values, and indices if referenced through them, of 'pElement' into 'element'.
+    template <typename Type>
+    void CopyElement(const FbxLayerElementTemplate<Type>* pElement, int componentCount, ElementData& element)
+    {
+        if (!pElement)
             return;
 
-        // Only interested in mesh node
-        if (pAttribute->GetAttributeType() != FbxNodeAttribute::eMesh)
+        const FbxLayerElement::EMappingMode MappingMode = pElement->GetMappingMode();
+        if (MappingMode != FbxLayerElement::eByControlPoint && MappingMode != FbxLayerElement::eByPolygonVertex)
             return;
 
-        // Sub meshes. One submesh per material.
-        std::map<int, std::vector<int>> submeshes;
+        element.byControlPoint = MappingMode == FbxLayerElement::eByControlPoint;
+        element.componentCount = componentCount;
 
+        const FbxLayerElementArrayTemplate<Type>& Values = pElement->GetDirectArray();
+        const int ValueCount = Values.GetCount();
+        element.values.reserve(ValueCount * componentCount);
+        for (int i = 0; i < ValueCount; ++i)
+        {
+            const Type Value = Values.GetAt(i);
+            for (int c = 0; c < componentCount; ++c)
+            {
+                element.values.push_back(Value[c]);
+            }
+        }
+
+        if (pElement->GetReferenceMode() != FbxLayerElement::eDirect)
+        {
+            const FbxLayerElementArrayTemplate<int>& Indices = pElement->GetIndexArray();
+            const int IndexCount = Indices.GetCount();
+            element.indices.reserve(IndexCount);
+            for (int i = 0; i < IndexCount; ++i)
+            {
+                element.indices.push_back(Indices.GetAt(i));
+            }
+        }
+    }
+
+    // Copies geometry, materials and bone weights of 'pNode' into 'mesh', and sets bind transforms of the bones skinning it.
+    void CopyMesh(FbxNode* pNode, Skeleton& skeleton, MeshExtraction& mesh)
+    {
         FbxMesh* pFbxMesh = pNode->GetMesh();
+        mesh.name = pNode->GetName();
+
+        const int ControlPointCount = pFbxMesh->GetControlPointsCount();
+        const FbxVector4* pControlPoints = pFbxMesh->GetControlPoints();
+        mesh.controlPoints.resize(ControlPointCount * 3);
+        for (int i = 0; i < ControlPointCount; ++i)
+        {
+            mesh.controlPoints[i * 3] = pControlPoints[i][0];
+            mesh.controlPoints[i * 3 + 1] = pControlPoints[i][1];
+            mesh.controlPoints[i * 3 + 2] = pControlPoints[i][2];
+        }
+
         const int PolygonCount = pFbxMesh->GetPolygonCount();
-        const int ElementMaterialCount = pFbxMesh->GetElementMaterialCount();
+        const int* pPolygonVertices = pFbxMesh->GetPolygonVertices();
+        mesh.polygonVertices.assign(pPolygonVertices, pPolygonVertices + pFbxMesh->GetPolygonVertexCount());
+        mesh.polygonStarts.resize(PolygonCount);
+        for (int i = 0; i < PolygonCount; ++i)
+        {
+            // Scene is triangulated on load.
+            assert(pFbxMesh->GetPolygonSize(i) == TRIANGLE_VERTEX_COUNT);
+            mesh.polygonStarts[i] = pFbxMesh->GetPolygonVertexIndex(i);
+        }
+
+        CopyElement(pFbxMesh->GetElementNormal(0), COMPONENT_COUNT_NORMAL, mesh.normalElement);
+        FbxStringList uvNames;
+        pFbxMesh->GetUVSetNames(uvNames);
+        if (uvNames.GetCount())
+        {
+            CopyElement(pFbxMesh->GetElementUV(uvNames[0]), COMPONENT_COUNT_UV, mesh.uvElement);
+        }
+
         FbxLayerElementArrayTemplate<int>* materialIndices;
         pFbxMesh->GetMaterialIndices(&materialIndices);
         FbxGeometryElement::EMappingMode mappingMode = pFbxMesh->GetElementMaterial()->GetMappingMode();
-        FbxGeometryElement::EReferenceMode referenceMode = pFbxMesh->GetElementMaterial()->GetReferenceMode();
         if (materialIndices)
         {
             if (mappingMode == FbxGeometryElement::eByPolygon)
             {
                 assert(materialIndices->GetCount() == PolygonCount);
-                // Count the faces of each material
+                mesh.polygonMaterials.resize(PolygonCount);
                 for (int pi = 0; pi < PolygonCount; ++pi)
                 {
-                    const int materialIndex = materialIndices->GetAt(pi);
-                    submeshes[materialIndex].push_back(pi);
+                    mesh.polygonMaterials[pi] = materialIndices->GetAt(pi);
                 }
             }
             else if (mappingMode == FbxGeometryElement::EMappingMode::eAllSame)
             {
-                for (int pi = 0; pi < PolygonCount; ++pi)
-                {
-                    submeshes[0].push_back(pi);
-                }
+                mesh.polygonMaterials.assign(PolygonCount, 0);
             }
         }
 
+        std::ostringstream log;
         const int DeformerCount = pFbxMesh->GetDeformerCount();
 #ifndef NDEBUG
-        std::cout << "....Loading Deformer...."
+        log << "....Loading Deformer...."
             << "Deformer Count : " << DeformerCount << std::endl;
 #endif
-        std::vector<std::vector<BoneWeight>> controlPointIndexToBoneWeights(pFbxMesh->GetControlPointsCount());
+        mesh.controlPointInfluences.resize(ControlPointCount);
         for (int i = 0; i < DeformerCount; ++i)
         {
             FbxDeformer* pDeformer = pFbxMesh->GetDeformer(i);
             FbxDeformer::EDeformerType type = pDeformer->GetDeformerType();
 #ifndef NDEBUG
-            std::cout << " Deformer Type : " << ToString(type) << std::endl;
+            log << " Deformer Type : " << ToString(type) << std::endl;
 #endif
             if (type == FbxDeformer::EDeformerType::eSkin || type == FbxDeformer::EDeformerType::eVertexCache)
             {
@@ -604,7 +861,7 @@ void FbxLoader::LoadMesh()
                     int ClusterCount = pSkin->GetClusterCount();
 
 #ifndef NDEBUG
-                    std::cout << " Cluster Count : " << ClusterCount << std::endl;
+                    log << " Cluster Count : " << ClusterCount << std::endl;
 #endif
                     for (int j = 0; j < ClusterCount; ++j)
                     {
@@ -614,18 +871,16 @@ void FbxLoader::LoadMesh()
                         assert(pLinkNode != nullptr);
 
                         std::string linkNodeName = pLinkNode->GetName();
-                        int boneIndex = m_pSkeleton->FindBoneIndex(linkNodeName);
+                        int boneIndex = skeleton.FindBoneIndex(linkNodeName);
                         if (boneIndex == Skeleton::DUMMY_PARENT_NODE_INDEX)
                             continue;
 
-                        Bone& bone = m_pSkeleton->GetBoneByIndex(boneIndex);
                         FbxAMatrix clusterMatrix;
                         pCluster->GetTransformMatrix(clusterMatrix);
                         FbxAMatrix clusterLinkMatrix;
                         pCluster->GetTransformLinkMatrix(clusterLinkMatrix);
 
-                        bone.SetTransform(ToMat4(clusterMatrix));
-                        bone.SetLinkTransform(ToMat4(clusterLinkMatrix));
+                        skeleton.SetBoneBindTransforms(boneIndex, ToMat4(clusterMatrix), ToMat4(clusterLinkMatrix));
 
                         int* pIndices = pCluster->GetControlPointIndices();
                         double* pWeights = pCluster->GetControlPointWeights();
@@ -635,167 +890,123 @@ void FbxLoader::LoadMesh()
                         {
                             int controlPointIndex = pIndices[k];
                             double weight = pWeights[k];
-                            std::vector<BoneWeight>& boneWeights = controlPointIndexToBoneWeights[controlPointIndex];
-                            boneWeights.push_back(BoneWeight(boneIndex, static_cast<float>(weight)));
+                            std::vector<BoneInfluences::Influence>& boneWeights = mesh.controlPointInfluences[controlPointIndex];
+                            boneWeights.push_back(BoneInfluences::Influence(boneIndex, static_cast<float>(weight)));
                         }
                     }
                 }
             }
         }
+        mesh.log = log.str();
+    }
+}
 
-        FbxStringList uvNames;
-        pFbxMesh->GetUVSetNames(uvNames);
-        const char * pUvName = NULL;
-        const int uvCount = uvNames.GetCount();
-        if (uvCount)
+void FbxLoader::LoadMesh()
+{
+    assert(m_pScene != nullptr);
+
+    // Mesh nodes in depth first order, which is the order of m_meshes.
+    std::vector<FbxNode*> meshNodes;
+    FbxNode* pRootNode = m_pScene->GetRootNode();
+    TraverseFbxNodeDepthFirst(pRootNode, [&meshNodes](FbxNode* pNode, int depth)
+    {
+        FbxNodeAttribute* pAttribute = pNode->GetNodeAttribute();
+
+        // Attribute can be absent.
+        if (!pAttribute)
+            return;
+
+        // Only interested in mesh node
+        if (pAttribute->GetAttributeType() != FbxNodeAttribute::eMesh)
+            return;
+
+        meshNodes.push_back(pNode);
+    });
+
+    // FBX is read on this thread only. Polygons of the copies are then grouped, converted( large meshes over several
+    // polygon ranges ) and welded on JobSystem workers, and GL buffers are created after, back on this thread.
+    const int MeshCount = static_cast<int>(meshNodes.size());
+    std::vector<MeshExtraction> meshes(MeshCount);
+    for (int i = 0; i < MeshCount; ++i)
+    {
+        meshes[i].influences = BoneInfluences(m_maximumBoneInfluenceCount, m_boneWeightPrecision);
+        CopyMesh(meshNodes[i], *m_pSkeleton, meshes[i]);
+    }
+
+    JobSystem* pJobSystem = JobSystem::Instance();
+    pJobSystem->ParallelFor(MeshCount, 1, [&meshes](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
         {
-            pUvName = uvNames[0];
+            GroupPolygons(meshes[i]);
         }
+    });
 
-        const int PolygonVertexCount = pFbxMesh->GetPolygonVertexCount();
-        std::vector<float> positions; positions.reserve(PolygonVertexCount * COMPONENT_COUNT_POSITION);
-        std::vector<float> normals; normals.reserve(PolygonVertexCount * COMPONENT_COUNT_NORMAL);
-        std::vector<float> uvs; uvs.reserve(PolygonVertexCount * COMPONENT_COUNT_UV);
-        std::vector<int> boneIndices; boneIndices.reserve(PolygonVertexCount * COMPONENT_COUNT_BONE);
-        std::vector<float> weights; weights.reserve(PolygonVertexCount * COMPONENT_COUNT_WEIGHT);
-        std::vector<float> tangents; tangents.reserve(PolygonVertexCount * COMPONENT_COUNT_TANGENT);
-
-        for (std::map<int, std::vector<int>>::iterator it = submeshes.begin(); it != submeshes.end(); ++it)
+    std::vector<CornerJob> cornerJobs;
+    for (MeshExtraction& mesh : meshes)
+    {
+        const int PolygonCount = static_cast<int>(mesh.polygons.size());
+        for (int begin = 0; begin < PolygonCount; begin += PolygonsPerJob)
         {
-            std::vector<int> subMeshPolygonsIndice = it->second;
-            // Per Triangle
-            for (int i : subMeshPolygonsIndice)
-            {
-                int ip0 = pFbxMesh->GetPolygonVertex(i, 0);
-                int ip1 = pFbxMesh->GetPolygonVertex(i, 1);
-                int ip2 = pFbxMesh->GetPolygonVertex(i, 2);
-
-                FbxVector4 p0 = pFbxMesh->GetControlPointAt(ip0);
-                FbxVector4 p1 = pFbxMesh->GetControlPointAt(ip1);
-                FbxVector4 p2 = pFbxMesh->GetControlPointAt(ip2);
-                
-                positions.push_back(static_cast<float>(p0[0]));
-                positions.push_back(static_cast<float>(p0[1]));
-                positions.push_back(static_cast<float>(p0[2]));
-                positions.push_back(static_cast<float>(p1[0]));
-                positions.push_back(static_cast<float>(p1[1]));
-                positions.push_back(static_cast<float>(p1[2]));
-                positions.push_back(static_cast<float>(p2[0]));
-                positions.push_back(static_cast<float>(p2[1]));
-                positions.push_back(static_cast<float>(p2[2]));
-
-                FbxVector4 n0; pFbxMesh->GetPolygonVertexNormal(i, 0, n0);
-                FbxVector4 n1; pFbxMesh->GetPolygonVertexNormal(i, 1, n1);
-                FbxVector4 n2; pFbxMesh->GetPolygonVertexNormal(i, 2, n2);
-
-                normals.push_back(static_cast<float>(n0[0]));
-                normals.push_back(static_cast<float>(n0[1]));
-                normals.push_back(static_cast<float>(n0[2]));
-                normals.push_back(static_cast<float>(n1[0]));
-                normals.push_back(static_cast<float>(n1[1]));
-                normals.push_back(static_cast<float>(n1[2]));
-                normals.push_back(static_cast<float>(n2[0]));
-                normals.push_back(static_cast<float>(n2[1]));
-                normals.push_back(static_cast<float>(n2[2]));
-
-                bool unmapped;
-                FbxVector2 uv0; pFbxMesh->GetPolygonVertexUV(i, 0, pUvName, uv0, unmapped);
-                FbxVector2 uv1; pFbxMesh->GetPolygonVertexUV(i, 1, pUvName, uv1, unmapped);
-                FbxVector2 uv2; pFbxMesh->GetPolygonVertexUV(i, 2, pUvName, uv2, unmapped);
-
-                uvs.push_back(static_cast<float>(uv0[0]));
-                uvs.push_back(static_cast<float>(uv0[1]));
-                uvs.push_back(static_cast<float>(uv1[0]));
-                uvs.push_back(static_cast<float>(uv1[1]));
-                uvs.push_back(static_cast<float>(uv2[0]));
-                uvs.push_back(static_cast<float>(uv2[1]));
-
-                // ref - http://www.terathon.com/code/tangent.html
-
-                FbxVector4 q1 = p1 - p0;
-                FbxVector4 q2 = p2 - p0;
-                FbxVector2 duv1 = uv1 - uv0;
-                FbxVector2 duv2 = uv2 - uv0;
-                FbxDouble s1 = duv1[0];
-                FbxDouble t1 = duv1[1];
-                FbxDouble s2 = duv2[0];
-                FbxDouble t2 = duv2[1];
-                FbxDouble determinant = 1.0 / (s1 * t2 - t1 * s2);
-                FbxVector4 tangent = (q1 * t2 + q2 * -t1) / determinant;
-                FbxVector4 bitangent = (q1 * -s2 + q2 * s1) / determinant;
-
-                FbxVector4 n[] = { n0, n1, n2 };
-                for (int i = 0; i < TRIANGLE_VERTEX_COUNT; ++i)
-                {
-                    FbxVector4 vertexTangent = tangent - n[i] * tangent.DotProduct(n[i]);
-                    FbxVector4 vertexBitangent = bitangent - n[i] * n[i].DotProduct(bitangent) - vertexTangent * vertexTangent.DotProduct(bitangent) / vertexTangent.SquareLength();
-                    vertexTangent.Normalize();
-                    tangents.push_back(static_cast<float>(vertexTangent[0]));
-                    tangents.push_back(static_cast<float>(vertexTangent[1]));
-                    tangents.push_back(static_cast<float>(vertexTangent[2]));
-                    FbxVector4 generatedBitangent = n[i].CrossProduct(vertexTangent);
-                    tangents.push_back(static_cast<float>(generatedBitangent.DotProduct(vertexBitangent) < 0.f ? -1.f : 1.f));
-                }
+            cornerJobs.push_back(CornerJob{ &mesh, begin, std::min(begin + PolygonsPerJob, PolygonCount) });
+        }
+    }
+    pJobSystem->ParallelFor(static_cast<int>(cornerJobs.size()), 1, [&cornerJobs](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            ExtractCorners(*cornerJobs[i].pMesh, cornerJobs[i].begin, cornerJobs[i].end);
+        }
+    });
 
-                int ips[TRIANGLE_VERTEX_COUNT] = { ip0, ip1, ip2 };
-                for (int k = 0; k < TRIANGLE_VERTEX_COUNT; ++k)
-                {
-                    int ip = ips[k];
-                    std::vector<BoneWeight>& boneWeights = controlPointIndexToBoneWeights[ip];
-                    const int CountWeights = std::min(static_cast<int>(boneWeights.size()), static_cast<int>(COMPONENT_COUNT_BONE));
-                    for (int j = 0; j < CountWeights; ++j)
-                    {
-                        boneIndices.push_back(boneWeights[j].boneIndex);
-                        weights.push_back(boneWeights[j].weight);
-                    }
-                    for (int j = CountWeights; j < COMPONENT_COUNT_BONE; ++j)
-                    {
-                        boneIndices.push_back(0);
-                        weights.push_back(0);
-                    }
-                }
-            }
+    const float WeldEpsilon = m_vertexWeldEpsilon;
+    pJobSystem->ParallelFor(MeshCount, 1, [&meshes, WeldEpsilon](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            WeldMesh(meshes[i], WeldEpsilon);
         }
+    });
+
+    for (MeshExtraction& mesh : meshes)
+    {
+        std::cout << mesh.log;
 
         std::shared_ptr<Mesh> pMyMesh(new Mesh());
-        if (!submeshes.empty())
+        int begin = 0;
+        for (const std::pair<int, int>& subMeshPolygons : mesh.subMeshes)
         {
-            int begin = 0;
-            for (std::map<int, std::vector<int>>::iterator it = submeshes.begin(); it != submeshes.end(); ++it)
-            {
-                Mesh::SubMesh subMesh;
-                subMesh.begin = begin;
-                subMesh.vertCount = static_cast<int>(it->second.size() * TRIANGLE_VERTEX_COUNT);
-                pMyMesh->AddSubMesh(subMesh);
-                begin += subMesh.vertCount;
-            }
+            Mesh::SubMesh subMesh;
+            subMesh.begin = begin;
+            subMesh.vertCount = subMeshPolygons.second * TRIANGLE_VERTEX_COUNT;
+            pMyMesh->AddSubMesh(subMesh);
+            begin += subMesh.vertCount;
         }
         std::shared_ptr<AttributeArray> aaPositions(new AttributeArray(COMPONENT_COUNT_POSITION, GL_FLOAT, 0, 0));
-        aaPositions->Fill(positions.size() * sizeof(positions[0]), positions.data());
+        aaPositions->Fill(mesh.positions.size() * sizeof(float), mesh.positions.data());
         pMyMesh->SetPositionAttributeArray(aaPositions);
 
         std::shared_ptr<AttributeArray> aaUvs(new AttributeArray(COMPONENT_COUNT_UV, GL_FLOAT, 0, 0));
-        aaUvs->Fill(uvs.size() * sizeof(uvs[0]), uvs.data());
+        aaUvs->Fill(mesh.uvs.size() * sizeof(float), mesh.uvs.data());
         pMyMesh->SetUvAttributeArray(aaUvs);
 
         std::shared_ptr<AttributeArray> aaNormals(new AttributeArray(COMPONENT_COUNT_NORMAL, GL_FLOAT, 0, 0));
-        aaNormals->Fill(normals.size() * sizeof(normals[0]), normals.data());
+        aaNormals->Fill(mesh.normals.size() * sizeof(float), mesh.normals.data());
         pMyMesh->SetNormalAttributeArray(aaNormals);
 
-        std::shared_ptr<AttributeArray> aaBoneIndices(new AttributeArray(COMPONENT_COUNT_BONE, GL_INT, 0, 0));
-        aaBoneIndices->Fill(boneIndices.size() * sizeof(boneIndices[0]), boneIndices.data());
-        pMyMesh->SetBonesAttributeArray(aaBoneIndices);
-
-        std::shared_ptr<AttributeArray> aaWeights(new AttributeArray(COMPONENT_COUNT_WEIGHT, GL_FLOAT, 0, 0));
-        aaWeights->Fill(weights.size() * sizeof(weights[0]), weights.data());
-        pMyMesh->SetWeightsAttributeArray(aaWeights);
+        pMyMesh->SetBonesAttributeArray(mesh.influences.CreateBonesAttributeArray());
+        pMyMesh->SetWeightsAttributeArray(mesh.influences.CreateWeightsAttributeArray());
 
         std::shared_ptr<AttributeArray> aaTangenets(new AttributeArray(COMPONENT_COUNT_TANGENT, GL_FLOAT, 0, 0));
-        aaTangenets->Fill(tangents.size() * sizeof(tangents[0]), tangents.data());
+        aaTangenets->Fill(mesh.tangents.size() * sizeof(float), mesh.tangents.data());
         pMyMesh->SetTangentAttributeArray(aaTangenets);
 
+        std::shared_ptr<IndexArray> pIndices(new IndexArray());
+        pIndices->Fill(mesh.indices);
+        pMyMesh->SetIndexArray(pIndices);
+
         m_meshes.push_back(pMyMesh);
-    });
+    }
 }
 
 void FbxLoader::LoadAnimation(FbxImporter* pImporter)
@@ -839,6 +1050,13 @@ void FbxLoader::LoadAnimation(FbxImporter* pImporter)
             }
             std::vector<KeyFrame> keyFrames(keyFrameTimes.size());
 
+            // Bind pose of every KeyFrame to the skeleton. Pose is indexed by bone index from now on.
+            const int BoneCount = m_pSkeleton->GetBoneCount();
+            for (KeyFrame& keyFrame : keyFrames)
+            {
+                keyFrame.GetPose().Resize(BoneCount);
+            }
+
             // Generate KeyFrame
             TraverseFbxNodeDepthFirst(m_pScene->GetRootNode(), [this, &keyFrames, endTime, &keyFrameTimes](FbxNode* pNode, int depth)
             {
@@ -849,8 +1067,10 @@ void FbxLoader::LoadAnimation(FbxImporter* pImporter)
                 if (attributeType == FbxNodeAttribute::EType::eSkeleton)
                 {
                     const char* pBoneName = pNode->GetName();
-                    Bone& bone = m_pSkeleton->GetBone(pBoneName);
-                    
+                    const int BoneIndex = m_pSkeleton->FindBoneIndex(pBoneName);
+                    if (BoneIndex == Skeleton::DUMMY_PARENT_NODE_INDEX)
+                        return;
+
                     for( int i = 0; i < keyFrameTimes.size(); ++i )
                     {
                         double keyFrameTime = keyFrameTimes[i];
@@ -865,7 +1085,7 @@ void FbxLoader::LoadAnimation(FbxImporter* pImporter)
                         glm::vec3 scale, skew;
                         glm::vec4 perp;
                         glm::decompose(localTransform, scale, transform.rotation, transform.position, skew, perp);
-                        keyFrames[i].AddPose(pBoneName, transform);
+                        keyFrames[i].SetBoneTransform(BoneIndex, transform);
                         keyFrames[i].SetTimestamp(static_cast<float>(keyFrameTime));
                     }
                 }
@@ -877,6 +1097,13 @@ void FbxLoader::LoadAnimation(FbxImporter* pImporter)
 
             for( int i = 0; i < keyFrames.size(); ++i )
                 pAnimation->AddKeyFrame(keyFrames[i]);
+            pAnimation->SetBoneNames(*m_pSkeleton);
+
+            const int RawSize = pAnimation->GetPoseDataSize();
+            const int RawKeyCount = pAnimation->GetTrackKeyCount();
+            pAnimation->Compress(Animation::CompressionSettings());
+            std::cout << "Animation '" << pAnimation->GetName() << "' compressed " << RawSize << " -> " << pAnimation->GetPoseDataSize()
+                << " bytes, " << RawKeyCount << " -> " << pAnimation->GetTrackKeyCount() << " keys, max error " << pAnimation->GetMaxRotationError() << " rad, " << pAnimation->GetMaxTranslationError() << std::endl;
 
             m_animations.push_back(pAnimation);
         }
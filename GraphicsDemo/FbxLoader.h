@@ -8,6 +8,8 @@
         stb_image.h - for texture file loading
 */
 
+#include "BoneInfluences.h"
+
 class Material;
 class Skeleton;
 class Bone;
@@ -24,6 +26,8 @@ public:
 
     //
     // Load an fbx file saved in given 'filename'
+    // FBX is only read on the calling thread. Copies of mesh data are converted on JobSystem workers, and buffers are
+    // created on the calling thread( which owns GL context ).
     //
     void Load(const char* filename);
 
@@ -32,11 +36,44 @@ public:
     //
     void Clear();
 
+    int GetObjectCount() const
+    {
+        return static_cast<int>(m_objects.size());
+    }
+
     std::shared_ptr<Object> GetObjectByIndex(int index)
     {
         return m_objects[index];
     }
 
+    //
+    // Bones with the largest weights kept per vertex by following calls to 'FbxLoader::Load'. BoneInfluences::ComponentCount by default.
+    //
+    void SetMaximumBoneInfluenceCount(int count)
+    {
+        m_maximumBoneInfluenceCount = count;
+    }
+
+    //
+    // Storage of bone weights of meshes loaded by following calls to 'FbxLoader::Load'. BoneInfluences::WP_UNORM8 by default.
+    //
+    void SetBoneWeightPrecision(BoneInfluences::WeightPrecision precision)
+    {
+        m_boneWeightPrecision = precision;
+    }
+
+    //
+    // Corners of triangles loaded by following calls to 'FbxLoader::Load' are welded into one vertex when they share control point
+    // and tangent handedness and their normal and uv components are within 'epsilon'. Tangent of the vertex is the average of its corners'.
+    // DefaultVertexWeldEpsilon by default, negative to keep every corner.
+    //
+    void SetVertexWeldEpsilon(float epsilon)
+    {
+        m_vertexWeldEpsilon = epsilon;
+    }
+
+    static const float DefaultVertexWeldEpsilon;
+
 private:
     struct TextureCache
     {
@@ -68,6 +105,9 @@ private:
     std::shared_ptr<Skeleton> m_pSkeleton;
     std::vector<std::shared_ptr<Animation>> m_animations;
     std::shared_ptr<Animator> m_pAnimator;
+    int m_maximumBoneInfluenceCount;
+    BoneInfluences::WeightPrecision m_boneWeightPrecision;
+    float m_vertexWeldEpsilon;
 
     void LoadTextures();
     void LoadMaterial();
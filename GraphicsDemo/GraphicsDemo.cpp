@@ -8,7 +8,7 @@
 #include "Errors.h"
 #include "System.h"
 #include "Object.h"
-#include "stb_image.h"
+#include "TextureLoader.h"
 #include "ShaderPrograms.h"
 #include "FontRenderer.h"
 #include "Material.h"
@@ -18,12 +18,34 @@
 #include "VKCode.h"
 #include "ScreenBuffer.h"
 #include "Mesh.h"
+#include "Animation.h"
+#include "Benchmark.h"
+#include "JobSystem.h"
+#include "PoseCache.h"
+#include "AnimationLod.h"
+#include "BakedAnimation.h"
+#include "SkinnedMesh.h"
+#include "ClipLibrary.h"
 
 namespace
 {
     const int ActiveLightCount = 1;
     const int MaximumLightCount = 5;
     const float CameraWalkSpeed = 10.0f;
+    // Number of copies 'bench update' makes when not given
+    const int DefaultCopyCount = 300;
+    // Distance between copies made by 'spawn'
+    const float CopySpacing = 150.0f;
+    // Animation time difference between neighbouring copies made by 'spawn'
+    const float CopyTimeStagger = 0.37f;
+    // Number of groups playing in lockstep 'bench cache' makes
+    const int CachePhaseCount = 8;
+    // Number of copies 'bench skin' skins when not given
+    const int DefaultSkinningCopyCount = 50;
+    // Frame rate 'bake' samples at when not given
+    const float DefaultBakeFrameRate = 30.0f;
+    // Seconds 'clips play' crossfades over when not given
+    const float DefaultClipFadeTime = 0.3f;
 
     FontRenderer s_fontRenderer;
     GLuint s_cubeMap;
@@ -35,7 +57,6 @@ namespace
 
     GLuint LoadCubeMap()
     {
-        stbi_set_flip_vertically_on_load(false);
         const std::string SkyboxLocation = "./Resources/Skybox/mp_orbital/";
         const std::string SkyboxName = "orbital-element";
         const std::string Suffixes[] = { "posx", "negx", "posy", "negy", "posz", "negz" };
@@ -48,15 +69,18 @@ namespace
         glBindTexture(GL_TEXTURE_CUBE_MAP, t);
         GET_AND_HANDLE_GL_ERROR();
 
+        // Faces are decoded in parallel and uploaded as they finish. Request index is the face index.
+        TextureLoader loader;
         for (int i = 0; i < _countof(Suffixes); ++i)
         {
-            GLint w, h, n;
-            const std::string texName = SkyboxLocation + SkyboxName + "_" + Suffixes[i] + Extension;
-            stbi_uc* pData = stbi_load(texName.c_str(), &w, &h, &n, 0);
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, pData);
-            GET_AND_HANDLE_GL_ERROR();
-            stbi_image_free(pData);
+            loader.Add({ SkyboxLocation + SkyboxName + "_" + Suffixes[i] + Extension }, false);
         }
+        loader.Load([](int face, const TextureLoader::Image& image)
+        {
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_RGB, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_BYTE,
+                image.pixels.get());
+            GET_AND_HANDLE_GL_ERROR();
+        });
 
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         GET_AND_HANDLE_GL_ERROR();
@@ -144,9 +168,13 @@ namespace
     bool CaseInsensitiveCompare(const std::string& lhs, const std::string& rhs)
     {
         static std::locale s_locale("C");
+        if (lhs.size() != rhs.size())
+        {
+            return false;
+        }
         for (int i = 0; i < lhs.size(); ++i)
         {
-            if (std::tolower(lhs[0], s_locale) != std::tolower(rhs[0], s_locale))
+            if (std::tolower(lhs[i], s_locale) != std::tolower(rhs[i], s_locale))
             {
                 return false;
             }
@@ -186,7 +214,8 @@ void GraphicsDemo::OnStart()
 
 void GraphicsDemo::Update(float dt)
 {
-    m_pScene->Update();
+    AnimationLod::Instance()->SetViewer(GetCamera());
+    m_pScene->Update(dt);
 }
 
 void GraphicsDemo::Render()
@@ -228,13 +257,11 @@ void GraphicsDemo::Render()
                 for (int k = 0; k < object.GetMeshCount(); ++k)
                 {
                     std::shared_ptr<Mesh> mesh(object.GetMesh(k));
-                    mesh->Apply(); 
+                    object.ApplyMesh(k);
 
                     for (int i = 0; i < mesh->GetSubMeshCount(); ++i)
                     {
-                        Mesh::SubMesh subMesh = mesh->GetSubMesh(i);
-                        glDrawArrays(GL_TRIANGLES, subMesh.begin, subMesh.vertCount);
-                        GET_AND_HANDLE_GL_ERROR();
+                        mesh->DrawSubMesh(i);
                     }
                 }
             }
@@ -322,6 +349,11 @@ void GraphicsDemo::Free()
     }
 
     s_screenBuffer.Free();
+
+    ClearBakedAnimations();
+    ClipLibrary::Instance()->Close();
+    JobSystem::Instance()->Free();
+    PoseCache::Instance()->Clear();
 }
 
 // Ref: https://docs.microsoft.com/en-us/windows/desktop/inputdev/using-keyboard-input
@@ -486,6 +518,111 @@ void GraphicsDemo::OnWndProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
                     }
                 }
 
+                if (tokens.size() > 0 && CaseInsensitiveCompare(tokens[0], "bench"))
+                {
+                    if (tokens.size() > 1 && CaseInsensitiveCompare(tokens[1], "pose"))
+                    {
+                        BenchmarkPose();
+                    }
+
+                    if (tokens.size() > 1 && CaseInsensitiveCompare(tokens[1], "update"))
+                    {
+                        BenchmarkUpdate(tokens.size() > 2 ? std::atoi(tokens[2].c_str()) : DefaultCopyCount);
+                    }
+
+                    if (tokens.size() > 1 && CaseInsensitiveCompare(tokens[1], "cache"))
+                    {
+                        BenchmarkCache(tokens.size() > 2 ? std::atoi(tokens[2].c_str()) : DefaultCopyCount);
+                    }
+
+                    if (tokens.size() > 1 && CaseInsensitiveCompare(tokens[1], "skin"))
+                    {
+                        BenchmarkSkinning(tokens.size() > 2 ? std::atoi(tokens[2].c_str()) : DefaultSkinningCopyCount);
+                    }
+                }
+
+                if (tokens.size() > 2 && CaseInsensitiveCompare(tokens[0], "anim"))
+                {
+                    if (CaseInsensitiveCompare(tokens[1], "rate"))
+                    {
+                        SetPlaybackRate(static_cast<float>(std::atof(tokens[2].c_str())));
+                    }
+
+                    if (CaseInsensitiveCompare(tokens[1], "step"))
+                    {
+                        SetFixedTimeStep(static_cast<float>(std::atof(tokens[2].c_str())));
+                    }
+                }
+
+                if (tokens.size() > 0 && CaseInsensitiveCompare(tokens[0], "lod"))
+                {
+                    if (tokens.size() > 1 && CaseInsensitiveCompare(tokens[1], "on"))
+                    {
+                        AnimationLod::Instance()->SetEnabled(true);
+                    }
+
+                    if (tokens.size() > 1 && CaseInsensitiveCompare(tokens[1], "off"))
+                    {
+                        AnimationLod::Instance()->SetEnabled(false);
+                    }
+
+                    if (tokens.size() > 2 && CaseInsensitiveCompare(tokens[1], "budget"))
+                    {
+                        AnimationLod::Instance()->SetFrameBudget(static_cast<float>(std::atof(tokens[2].c_str())));
+                    }
+
+                    PrintAnimationLod();
+                }
+
+                if (tokens.size() > 1 && CaseInsensitiveCompare(tokens[0], "skin"))
+                {
+                    SetCpuSkinningEnabled(CaseInsensitiveCompare(tokens[1], "cpu"));
+                }
+
+                if (tokens.size() > 0 && CaseInsensitiveCompare(tokens[0], "bake"))
+                {
+                    if (tokens.size() > 1 && CaseInsensitiveCompare(tokens[1], "off"))
+                    {
+                        ClearBakedAnimations();
+                    }
+                    else
+                    {
+                        const float FrameRate = tokens.size() > 1 ? static_cast<float>(std::atof(tokens[1].c_str())) : DefaultBakeFrameRate;
+                        BakeAnimations(FrameRate, tokens.size() > 2 && CaseInsensitiveCompare(tokens[2], "half"));
+                    }
+                }
+
+                if (tokens.size() > 0 && CaseInsensitiveCompare(tokens[0], "clips"))
+                {
+                    if (tokens.size() > 2 && CaseInsensitiveCompare(tokens[1], "save"))
+                    {
+                        SaveClipLibrary(tokens[2]);
+                    }
+                    else if (tokens.size() > 2 && CaseInsensitiveCompare(tokens[1], "open"))
+                    {
+                        ClipLibrary::Instance()->Open(tokens[2]);
+                        PrintClipLibrary();
+                    }
+                    else if (tokens.size() > 2 && CaseInsensitiveCompare(tokens[1], "play"))
+                    {
+                        PlayClip(tokens[2], tokens.size() > 3 ? static_cast<float>(std::atof(tokens[3].c_str())) : DefaultClipFadeTime);
+                    }
+                    else if (tokens.size() > 2 && CaseInsensitiveCompare(tokens[1], "budget"))
+                    {
+                        ClipLibrary::Instance()->SetMemoryBudget(static_cast<size_t>(std::atof(tokens[2].c_str()) * 1024 * 1024));
+                        PrintClipLibrary();
+                    }
+                    else
+                    {
+                        PrintClipLibrary();
+                    }
+                }
+
+                if (tokens.size() > 1 && CaseInsensitiveCompare(tokens[0], "spawn"))
+                {
+                    SpawnCopies(std::atoi(tokens[1].c_str()), tokens.size() > 2 && CaseInsensitiveCompare(tokens[2], "cached"));
+                }
+
                 s_command.resize(0);
                 s_bCommandInputState = false;
             }
@@ -587,8 +724,11 @@ bool GraphicsDemo::LoadScene(const std::string& sceneName)
     pScene->Deserialize(ifs);
     ifs.close();
 
+    ClearBakedAnimations();
     m_pScene->Free();
     m_pScene = pScene;
+    // Palettes are keyed by address of animations that are gone now
+    PoseCache::Instance()->Clear();
 
     return true;
 }
@@ -605,6 +745,298 @@ bool GraphicsDemo::SaveScene(const std::string& sceneName)
     return true;
 }
 
+std::shared_ptr<Object> GraphicsDemo::FindAnimatedObject()
+{
+    for (int i = 0; i < m_pScene->GetSceneObjectCount(); ++i)
+    {
+        std::shared_ptr<Object> pObject = m_pScene->GetSceneObject(i);
+        std::shared_ptr<Animator> pAnimator = pObject->GetAnimator();
+        if (pAnimator && pAnimator->GetCurrentAnimation())
+        {
+            return pObject;
+        }
+    }
+    std::cout << "FindAnimatedObject() : no animated object in the scene" << std::endl;
+    return nullptr;
+}
+
+void GraphicsDemo::BenchmarkPose()
+{
+    std::shared_ptr<Object> pObject = FindAnimatedObject();
+    if (pObject)
+    {
+        BenchmarkPoseBlend(*pObject->GetAnimator()->GetCurrentAnimation(), std::cout);
+    }
+}
+
+void GraphicsDemo::BenchmarkUpdate(int copyCount)
+{
+    std::shared_ptr<Object> pObject = FindAnimatedObject();
+    if (pObject)
+    {
+        BenchmarkAnimationUpdate(*pObject, copyCount, std::cout);
+    }
+}
+
+void GraphicsDemo::BenchmarkCache(int copyCount)
+{
+    std::shared_ptr<Object> pObject = FindAnimatedObject();
+    if (pObject)
+    {
+        BenchmarkPoseCache(*pObject, copyCount, CachePhaseCount, std::cout);
+    }
+}
+
+void GraphicsDemo::BenchmarkSkinning(int copyCount)
+{
+    std::shared_ptr<Object> pObject = FindAnimatedObject();
+    if (!pObject)
+        return;
+
+    const glm::mat4* pPalette = pObject->GetSkinningPalette();
+    if (!pPalette)
+    {
+        std::cout << "BenchmarkSkinning() : animated object has no palette yet" << std::endl;
+        return;
+    }
+
+    for (int i = 0; i < pObject->GetMeshCount(); ++i)
+    {
+        std::shared_ptr<const CpuSkinning::Source> pSource = pObject->GetMesh(i)->GetSkinningSource();
+        if (pSource)
+        {
+            BenchmarkCpuSkinning(*pSource, pPalette, copyCount, std::cout);
+        }
+    }
+}
+
+void GraphicsDemo::SpawnCopies(int copyCount, bool poseCacheEnabled)
+{
+    std::shared_ptr<Object> pSource = FindAnimatedObject();
+    if (!pSource)
+        return;
+
+    // Square grid around the source object
+    const int Columns = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(copyCount))));
+    for (int i = 0; i < copyCount; ++i)
+    {
+        std::shared_ptr<Object> pObject(new Object);
+        pSource->CopyTo(*pObject);
+        const glm::vec3 Offset(
+            (i % Columns - Columns / 2) * CopySpacing,
+            0.0f,
+            (i / Columns + 1) * CopySpacing);
+        pObject->SetPosition(pSource->GetPosition() + Offset);
+        pObject->GetAnimator()->SetAnimationTime(i * CopyTimeStagger);
+        pObject->GetAnimator()->SetPoseCacheEnabled(poseCacheEnabled);
+        m_pScene->AddSceneObject(pObject);
+    }
+    std::cout << "SpawnCopies() : " << m_pScene->GetSceneObjectCount() << " objects in the scene" << std::endl;
+}
+
+void GraphicsDemo::PrintAnimationLod()
+{
+    const AnimationLod* pLod = AnimationLod::Instance();
+    std::cout << "Animation LOD " << (pLod->IsEnabled() ? "on" : "off")
+        << ", frame budget " << pLod->GetFrameBudget() << " ms" << std::endl;
+    const std::vector<AnimationLod::Tier>& Tiers = pLod->GetTiers();
+    for (int i = 0; i < static_cast<int>(Tiers.size()); ++i)
+    {
+        std::cout << "  tier " << i << " : screen size >= " << Tiers[i].minScreenSize
+            << ", every " << Tiers[i].updateInterval << " frames, bone depth <= " << Tiers[i].maxBoneDepth
+            << ", " << pLod->GetTierObjectCount(i) << " objects" << std::endl;
+    }
+    std::cout << "  outside view : " << pLod->GetTierObjectCount(static_cast<int>(Tiers.size())) << " objects" << std::endl;
+}
+
+void GraphicsDemo::SetPlaybackRate(float rate)
+{
+    for (int i = 0; i < m_pScene->GetSceneObjectCount(); ++i)
+    {
+        std::shared_ptr<Animator> pAnimator = m_pScene->GetSceneObject(i)->GetAnimator();
+        if (pAnimator)
+        {
+            pAnimator->SetPlaybackRate(rate);
+        }
+    }
+    std::cout << "SetPlaybackRate() : " << rate << std::endl;
+}
+
+void GraphicsDemo::SetFixedTimeStep(float timeStep)
+{
+    if (timeStep < 0.0f)
+        return;
+
+    for (int i = 0; i < m_pScene->GetSceneObjectCount(); ++i)
+    {
+        std::shared_ptr<Animator> pAnimator = m_pScene->GetSceneObject(i)->GetAnimator();
+        if (pAnimator)
+        {
+            pAnimator->SetFixedTimeStep(timeStep);
+        }
+    }
+    std::cout << "SetFixedTimeStep() : " << timeStep << " s" << std::endl;
+}
+
+void GraphicsDemo::SetCpuSkinningEnabled(bool enabled)
+{
+    int skinnedObjectCount = 0;
+    for (int i = 0; i < m_pScene->GetSceneObjectCount(); ++i)
+    {
+        std::shared_ptr<Object> pObject = m_pScene->GetSceneObject(i);
+        if (pObject->GetSkeleton())
+        {
+            pObject->SetCpuSkinningEnabled(enabled);
+            skinnedObjectCount += pObject->IsCpuSkinningEnabled() ? 1 : 0;
+        }
+    }
+    std::cout << "SetCpuSkinningEnabled() : " << skinnedObjectCount << " objects skinned on CPU" << std::endl;
+}
+
+void GraphicsDemo::BakeAnimations(float frameRate, bool halfPrecision)
+{
+    if (frameRate <= 0.0f)
+        return;
+
+    ClearBakedAnimations();
+
+    const BakedAnimation::Precision Precision = halfPrecision ? BakedAnimation::BP_HALF : BakedAnimation::BP_FLOAT;
+    size_t dataSize = 0;
+    int bakedObjectCount = 0;
+    for (int i = 0; i < m_pScene->GetSceneObjectCount(); ++i)
+    {
+        std::shared_ptr<Object> pObject = m_pScene->GetSceneObject(i);
+        std::shared_ptr<Animator> pAnimator = pObject->GetAnimator();
+        std::shared_ptr<const Skeleton> pSkeleton = pObject->GetSkeleton();
+        if (!pAnimator || !pAnimator->GetCurrentAnimation() || !pSkeleton)
+            continue;
+
+        std::shared_ptr<BakedAnimation> pBaked;
+        for (const std::shared_ptr<BakedAnimation>& pCandidate : m_bakedAnimations)
+        {
+            if (pCandidate->GetSourceAnimation() == pAnimator->GetCurrentAnimation() && pCandidate->GetSkeleton() == pSkeleton.get())
+            {
+                pBaked = pCandidate;
+                break;
+            }
+        }
+
+        if (!pBaked)
+        {
+            pBaked = BakedAnimation::Bake(pAnimator->GetCurrentAnimation(), pSkeleton, frameRate, pAnimator->GetRotationMode(), Precision);
+            pBaked->Upload();
+            m_bakedAnimations.push_back(pBaked);
+            dataSize += pBaked->GetDataSize();
+        }
+
+        // Keeps playback time; only how the palette is computed changes.
+        const float AnimationTime = pAnimator->GetAnimationTime();
+        pAnimator->SetBakedAnimation(pBaked, true);
+        pAnimator->SetAnimationTime(AnimationTime);
+        ++bakedObjectCount;
+    }
+
+    std::cout << "BakeAnimations() : " << m_bakedAnimations.size() << " animations baked for " << bakedObjectCount << " objects, "
+        << dataSize / 1024 << " KB" << std::endl;
+    for (const std::shared_ptr<BakedAnimation>& pBaked : m_bakedAnimations)
+    {
+        std::cout << "  " << pBaked->GetSourceAnimation()->GetName() << " : " << pBaked->GetFrameCount() << " frames at "
+            << pBaked->GetFrameRate() << " fps, " << pBaked->GetBoneCount() << " bones, "
+            << (pBaked->GetTexture() != 0 ? "uploaded" : "unpacked on CPU") << std::endl;
+    }
+}
+
+void GraphicsDemo::ClearBakedAnimations()
+{
+    if (m_bakedAnimations.empty())
+        return;
+
+    for (int i = 0; i < m_pScene->GetSceneObjectCount(); ++i)
+    {
+        std::shared_ptr<Animator> pAnimator = m_pScene->GetSceneObject(i)->GetAnimator();
+        if (pAnimator && pAnimator->GetBakedAnimation())
+        {
+            pAnimator->SetBakedAnimation(nullptr, false);
+        }
+    }
+
+    for (const std::shared_ptr<BakedAnimation>& pBaked : m_bakedAnimations)
+    {
+        pBaked->Free();
+    }
+    m_bakedAnimations.clear();
+    std::cout << "ClearBakedAnimations() : animators sample animations again" << std::endl;
+}
+
+void GraphicsDemo::SaveClipLibrary(const std::string& filename)
+{
+    std::vector<std::shared_ptr<Animation>> clips;
+    for (int i = 0; i < m_pScene->GetSceneObjectCount(); ++i)
+    {
+        std::shared_ptr<Animator> pAnimator = m_pScene->GetSceneObject(i)->GetAnimator();
+        if (pAnimator && pAnimator->GetCurrentAnimation()
+            && std::find(clips.begin(), clips.end(), pAnimator->GetCurrentAnimation()) == clips.end())
+        {
+            clips.push_back(pAnimator->GetCurrentAnimation());
+        }
+    }
+
+    if (ClipLibrary::Write(filename, clips))
+    {
+        std::cout << "SaveClipLibrary() : " << clips.size() << " clips written to " << filename << std::endl;
+    }
+}
+
+void GraphicsDemo::PlayClip(const std::string& clip, float fadeTime)
+{
+    ClipLibrary* pLibrary = ClipLibrary::Instance();
+    int index = pLibrary->FindClip(clip);
+    if (index < 0 && !clip.empty() && std::all_of(clip.begin(), clip.end(), ::isdigit))
+    {
+        index = std::atoi(clip.c_str());
+    }
+
+    std::shared_ptr<Animation> pAnimation = pLibrary->Acquire(index);
+    if (!pAnimation)
+    {
+        std::cout << "PlayClip() : no clip '" << clip << "' in " << pLibrary->GetFilename() << std::endl;
+        return;
+    }
+
+    int playingCount = 0;
+    for (int i = 0; i < m_pScene->GetSceneObjectCount(); ++i)
+    {
+        std::shared_ptr<Object> pObject = m_pScene->GetSceneObject(i);
+        std::shared_ptr<Animator> pAnimator = pObject->GetAnimator();
+        if (pAnimator && pObject->GetSkeleton() && pAnimation->IsBoundTo(*pObject->GetSkeleton()))
+        {
+            pAnimator->CrossfadeTo(pAnimation, fadeTime);
+            ++playingCount;
+        }
+    }
+    std::cout << "PlayClip() : '" << pAnimation->GetName() << "' played by " << playingCount << " objects" << std::endl;
+    PrintClipLibrary();
+}
+
+void GraphicsDemo::PrintClipLibrary()
+{
+    const ClipLibrary* pLibrary = ClipLibrary::Instance();
+    if (!pLibrary->IsOpen())
+    {
+        std::cout << "No clip library open" << std::endl;
+        return;
+    }
+
+    std::cout << "Clip library " << pLibrary->GetFilename() << " : " << pLibrary->GetClipCount() << " clips, "
+        << pLibrary->GetResidentCount() << " resident, " << pLibrary->GetResidentSize() / 1024 << " / "
+        << pLibrary->GetMemoryBudget() / 1024 << " KB, " << pLibrary->GetPageInCount() << " page ins" << std::endl;
+    for (int i = 0; i < pLibrary->GetClipCount(); ++i)
+    {
+        std::cout << "  " << i << " : " << pLibrary->GetClipName(i) << ", " << pLibrary->GetClipLength(i) << " s, "
+            << pLibrary->GetClipBoneCount(i) << " bones" << (pLibrary->IsClipResident(i) ? ", resident" : "") << std::endl;
+    }
+}
+
 PerspectiveCamera& GraphicsDemo::GetCamera()
 {
     return m_pScene->GetCamera(m_activeCameraIndex);
@@ -19,6 +19,7 @@
 class Object;
 class ShaderProgram;
 class Material;
+class BakedAnimation;
 
 class GraphicsDemo : public SystemComponent
 {
@@ -43,11 +44,46 @@ private:
     GizmoRenderer m_gizmoRenderer;
     SkyboxRenderer m_skyboxRenderer;
     int m_activeCameraIndex;
+    // Made by 'bake' command. Kept to free textures.
+    std::vector<std::shared_ptr<BakedAnimation>> m_bakedAnimations;
 
     PerspectiveCamera& GetCamera();
 
     bool SaveScene(const std::string& sceneName);
     bool LoadScene(const std::string& sceneName);
+    // Returns the first object in the scene that is playing animation. nullptr if there is none.
+    std::shared_ptr<Object> FindAnimatedObject();
+    // Runs pose interpolation benchmark on the first animated object of the scene.
+    void BenchmarkPose();
+    // Runs animation update benchmark on 'copyCount' copies of the first animated object of the scene.
+    void BenchmarkUpdate(int copyCount);
+    // Runs PoseCache benchmark on 'copyCount' copies of the first animated object of the scene.
+    void BenchmarkCache(int copyCount);
+    // Runs CPU skinning benchmark on 'copyCount' copies of the meshes of the first animated object of the scene.
+    void BenchmarkSkinning(int copyCount);
+    // Adds 'copyCount' copies of the first animated object of the scene for stress test.
+    // Copies share palettes through PoseCache if 'poseCacheEnabled' is true.
+    void SpawnCopies(int copyCount, bool poseCacheEnabled);
+    // Prints number of objects in each animation LOD tier.
+    void PrintAnimationLod();
+    // Sets playback rate of every animator in the scene.
+    void SetPlaybackRate(float rate);
+    // Sets fixed time step of every animator in the scene. 0 to play by frame time.
+    void SetFixedTimeStep(float timeStep);
+    // Skins every animated object of the scene on CPU if 'enabled' is true, in shader otherwise.
+    void SetCpuSkinningEnabled(bool enabled);
+    // Bakes animation of every animated object in the scene at 'frameRate' and makes them play baked palettes.
+    // Objects playing the same animation on the same skeleton share baked palettes.
+    void BakeAnimations(float frameRate, bool halfPrecision);
+    // Makes every animator go back to sampling animation, and frees baked palettes.
+    void ClearBakedAnimations();
+    // Writes animations played in the scene to 'filename' as a clip library.
+    void SaveClipLibrary(const std::string& filename);
+    // Makes every animated object whose skeleton fits clip 'clip'( name or index ) of the open clip library play it,
+    // crossfading from what it played over 'fadeTime' seconds.
+    void PlayClip(const std::string& clip, float fadeTime);
+    // Prints clips of the open clip library and which of them are resident.
+    void PrintClipLibrary();
     void RenderScreen();
 };
 
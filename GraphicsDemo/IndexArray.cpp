@@ -0,0 +1,131 @@
+/*
+    IndexArray.cpp
+
+    class IndexArray implementation.
+*/
+#include "Common.h"
+#include "IndexArray.h"
+#include "Errors.h"
+#include "Serialization.h"
+
+namespace
+{
+    void UploadIndices(GLuint& bo, const void* data, GLsizeiptr size)
+    {
+        if (bo == 0)
+        {
+            glGenBuffers(1, &bo);
+            GET_AND_HANDLE_GL_ERROR();
+        }
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bo);
+        GET_AND_HANDLE_GL_ERROR();
+
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+        GET_AND_HANDLE_GL_ERROR();
+    }
+}
+
+void IndexArray::Fill(const std::vector<uint32_t>& indices)
+{
+    const uint32_t MaximumIndex = indices.empty() ? 0 : *std::max_element(indices.begin(), indices.end());
+    m_indexCount = static_cast<int>(indices.size());
+    if (MaximumIndex <= std::numeric_limits<uint16_t>::max())
+    {
+        m_type = GL_UNSIGNED_SHORT;
+        std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+        UploadIndices(m_bo, shortIndices.data(), shortIndices.size() * sizeof(uint16_t));
+    }
+    else
+    {
+        m_type = GL_UNSIGNED_INT;
+        UploadIndices(m_bo, indices.data(), indices.size() * sizeof(uint32_t));
+    }
+}
+
+void IndexArray::GetData(std::vector<uint32_t>& out)
+{
+    out.clear();
+    if (m_bo == 0 || m_indexCount == 0)
+        return;
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_bo);
+    GET_AND_HANDLE_GL_ERROR();
+
+    if (m_type == GL_UNSIGNED_SHORT)
+    {
+        std::vector<uint16_t> shortIndices(m_indexCount);
+        glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, shortIndices.size() * sizeof(uint16_t), shortIndices.data());
+        out.assign(shortIndices.begin(), shortIndices.end());
+    }
+    else
+    {
+        out.resize(m_indexCount);
+        glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, out.size() * sizeof(uint32_t), out.data());
+    }
+    GET_AND_HANDLE_GL_ERROR();
+}
+
+void IndexArray::Bind()
+{
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_bo);
+    GET_AND_HANDLE_GL_ERROR();
+}
+
+void IndexArray::DrawTriangles(int first, int count)
+{
+    glDrawElements(GL_TRIANGLES, count, m_type, reinterpret_cast<const void*>(static_cast<size_t>(first) * GetIndexSize()));
+    GET_AND_HANDLE_GL_ERROR();
+}
+
+void IndexArray::Free()
+{
+    if (m_bo != 0)
+    {
+        glDeleteBuffers(1, &m_bo);
+        GET_AND_HANDLE_GL_ERROR();
+        m_bo = 0;
+    }
+    m_indexCount = 0;
+}
+
+int IndexArray::GetIndexCount() const
+{
+    return m_indexCount;
+}
+
+GLenum IndexArray::GetType() const
+{
+    return m_type;
+}
+
+int IndexArray::GetIndexSize() const
+{
+    return m_type == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+void IndexArray::Serialize(std::ostream& os)
+{
+    Serialization::Write(os, m_type);
+    Serialization::Write(os, m_indexCount);
+
+    std::vector<char> buffer(static_cast<size_t>(m_indexCount) * GetIndexSize());
+    if (!buffer.empty())
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_bo);
+        GET_AND_HANDLE_GL_ERROR();
+        glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, buffer.size(), buffer.data());
+        GET_AND_HANDLE_GL_ERROR();
+    }
+    os.write(buffer.data(), buffer.size());
+}
+
+void IndexArray::Deserialize(std::istream& is)
+{
+    Serialization::Read(is, m_type);
+    Serialization::Read(is, m_indexCount);
+
+    std::vector<char> buffer(static_cast<size_t>(m_indexCount) * GetIndexSize(), '\0');
+    is.read(buffer.data(), buffer.size());
+    UploadIndices(m_bo, buffer.data(), buffer.size());
+}
@@ -0,0 +1,52 @@
+/*
+    IndexArray.h
+
+    class IndexArray definition. IndexArray encapsulates element array buffer object( index buffer ).
+*/
+#ifndef INDEX_ARRAY_H_
+#define INDEX_ARRAY_H_
+
+#include <glad.h>
+
+class IndexArray
+{
+public:
+    IndexArray()
+        : m_bo(0)
+        , m_type(GL_INVALID_ENUM)
+        , m_indexCount(0)
+    {
+    }
+
+    // Uploads 'indices'. Stored as 16 bit indices if every index fits in 16 bits, 32 bit otherwise.
+    void Fill(const std::vector<uint32_t>& indices);
+
+    // Reads indices back from GPU into 'out'.
+    void GetData(std::vector<uint32_t>& out);
+
+    // Binds buffer as GL_ELEMENT_ARRAY_BUFFER for following glDrawElements calls.
+    void Bind();
+
+    // Draws 'count' indices from 'first' as triangles.
+    void DrawTriangles(int first, int count);
+
+    void Free();
+
+    int GetIndexCount() const;
+
+    // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    GLenum GetType() const;
+
+    void Serialize(std::ostream& os);
+
+    void Deserialize(std::istream& is);
+
+private:
+    GLuint m_bo;
+    GLenum m_type;
+    int m_indexCount;
+
+    int GetIndexSize() const;
+};
+
+#endif
@@ -0,0 +1,147 @@
+/*
+    JobSystem.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    JobSystem class implementation.
+*/
+#include "Common.h"
+#include "JobSystem.h"
+
+JobSystem::JobSystem()
+    : m_quit(false)
+    , m_generation(0)
+    , m_activeWorkerCount(0)
+    , m_pFunction(nullptr)
+    , m_count(0)
+    , m_grainSize(1)
+    , m_rangeCount(0)
+    , m_nextRange(0)
+    , m_finishedRangeCount(0)
+{
+    SetWorkerCount(GetDefaultWorkerCount());
+}
+
+JobSystem::~JobSystem()
+{
+    Free();
+}
+
+void JobSystem::SetWorkerCount(int workerCount)
+{
+    Free();
+
+    m_quit = false;
+    m_workers.reserve(workerCount);
+    for (int i = 0; i < workerCount; ++i)
+    {
+        m_workers.push_back(std::thread(&JobSystem::WorkerLoop, this));
+    }
+}
+
+int JobSystem::GetWorkerCount() const
+{
+    return static_cast<int>(m_workers.size());
+}
+
+int JobSystem::GetDefaultWorkerCount()
+{
+    const int HardwareThreadCount = static_cast<int>(std::thread::hardware_concurrency());
+    return std::max(HardwareThreadCount - 1, 0);
+}
+
+void JobSystem::ParallelFor(int count, int grainSize, const RangeFunction& function)
+{
+    assert(grainSize > 0);
+    if (count <= 0)
+        return;
+
+    if (m_workers.empty() || count <= grainSize)
+    {
+        function(0, count);
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        // A worker that woke up late for the last job may still be inside it.
+        m_doneCondition.wait(lock, [this]() { return m_activeWorkerCount == 0; });
+
+        m_pFunction = &function;
+        m_count = count;
+        m_grainSize = grainSize;
+        m_rangeCount = (count + grainSize - 1) / grainSize;
+        m_nextRange = 0;
+        m_finishedRangeCount = 0;
+        ++m_generation;
+    }
+    m_jobCondition.notify_all();
+
+    RunRanges();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this]()
+    {
+        return m_finishedRangeCount == m_rangeCount && m_activeWorkerCount == 0;
+    });
+    m_pFunction = nullptr;
+}
+
+void JobSystem::Free()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_jobCondition.notify_all();
+
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+void JobSystem::WorkerLoop()
+{
+    unsigned int lastGeneration = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        lastGeneration = m_generation;
+    }
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobCondition.wait(lock, [this, lastGeneration]() { return m_quit || m_generation != lastGeneration; });
+            if (m_quit)
+                return;
+            lastGeneration = m_generation;
+            ++m_activeWorkerCount;
+        }
+
+        RunRanges();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_activeWorkerCount;
+        }
+        m_doneCondition.notify_all();
+    }
+}
+
+void JobSystem::RunRanges()
+{
+    for (;;)
+    {
+        const int Range = m_nextRange.fetch_add(1);
+        if (Range >= m_rangeCount)
+            return;
+
+        const int Begin = Range * m_grainSize;
+        const int End = std::min(Begin + m_grainSize, m_count);
+        (*m_pFunction)(Begin, End);
+        m_finishedRangeCount.fetch_add(1);
+    }
+}
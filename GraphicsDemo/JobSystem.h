@@ -0,0 +1,85 @@
+/*
+    JobSystem.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    References :
+        https://en.cppreference.com/w/cpp/thread/condition_variable
+
+    JobSystem class definition.
+*/
+#ifndef JOB_SYSTEM_H_
+#define JOB_SYSTEM_H_
+
+#include "Singleton.h"
+
+//
+// class JobSystem
+//
+// Pool of worker threads that runs data parallel loops.
+// ParallelFor() splits an index range into fixed size ranges. Workers and the calling thread take ranges
+// until none is left, and ParallelFor() returns only after every range is done. Work never outlives the call.
+// Which thread runs a range doesn't change what the range computes, so results equal serial execution
+// as long as ranges don't write to shared data.
+//
+// usage:
+//  JobSystem::Instance()->ParallelFor(objectCount, 8, [&](int begin, int end)
+//  {
+//      for (int i = begin; i < end; ++i)
+//          objects[i]->Update();
+//  });
+//
+class JobSystem : public Singleton<JobSystem>
+{
+public:
+    typedef std::function<void(int begin, int end)> RangeFunction;
+
+    // Starts GetDefaultWorkerCount() workers.
+    JobSystem();
+
+    ~JobSystem();
+
+    // Restarts with 'workerCount' worker threads. Calling thread always takes part in ParallelFor(),
+    // so 0 means every range runs on the calling thread.
+    void SetWorkerCount(int workerCount);
+
+    int GetWorkerCount() const;
+
+    // One less than number of hardware threads, leaving one for the calling thread.
+    static int GetDefaultWorkerCount();
+
+    // Calls 'function' for every range of at most 'grainSize' indices in [0, count) and waits for all of them.
+    // Must not be called from inside 'function' or from two threads at once.
+    void ParallelFor(int count, int grainSize, const RangeFunction& function);
+
+    // Stops worker threads. ParallelFor() runs serially after this.
+    void Free();
+
+private:
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    // Workers wait on this for a new job
+    std::condition_variable m_jobCondition;
+    // ParallelFor() waits on this for workers to leave the job
+    std::condition_variable m_doneCondition;
+    bool m_quit;
+    // Increased every ParallelFor(). Worker joins a job once per generation.
+    unsigned int m_generation;
+    // Number of workers currently running ranges of the job
+    int m_activeWorkerCount;
+
+    // Current job
+    const RangeFunction* m_pFunction;
+    int m_count;
+    int m_grainSize;
+    int m_rangeCount;
+    std::atomic<int> m_nextRange;
+    std::atomic<int> m_finishedRangeCount;
+
+    void WorkerLoop();
+
+    // Runs ranges of the current job until none is left.
+    void RunRanges();
+};
+
+#endif
@@ -2,14 +2,25 @@
 #include "KeyFrame.h"
 #include "Serialization.h"
 
-std::map<std::string, BoneTransform>& KeyFrame::GetPose()
+KeyFrame::KeyFrame()
+    : m_timeStamp(0.0f)
+    , m_pose()
+{
+}
+
+Pose& KeyFrame::GetPose()
 {
     return m_pose;
 }
 
-void KeyFrame::AddPose(const char * boneName, BoneTransform transform)
+const Pose& KeyFrame::GetPose() const
 {
-    m_pose[boneName] = transform;
+    return m_pose;
+}
+
+void KeyFrame::SetBoneTransform(int boneIndex, BoneTransform transform)
+{
+    m_pose.SetBoneTransform(boneIndex, transform);
 }
 
 void KeyFrame::SetTimestamp(float timeStamp)
@@ -17,7 +28,7 @@ void KeyFrame::SetTimestamp(float timeStamp)
     m_timeStamp = timeStamp;
 }
 
-float KeyFrame::GetTimeStamp()
+float KeyFrame::GetTimeStamp() const
 {
     return m_timeStamp;
 }
@@ -25,26 +36,11 @@ float KeyFrame::GetTimeStamp()
 void KeyFrame::Serialize(std::ostream& os) const
 {
     Serialization::Write(os, m_timeStamp);
-
-    int poseSize = static_cast<int>(m_pose.size());
-    Serialization::Write(os, poseSize);
-    for (std::map<std::string, BoneTransform>::const_iterator iter = m_pose.begin(); iter != m_pose.end(); ++iter)
-    {
-        Serialization::Write(os, iter->first);
-        Serialization::Write(os, iter->second);
-    }
+    m_pose.Serialize(os);
 }
 
 void KeyFrame::Deserialize(std::istream& is)
 {
     Serialization::Read(is, m_timeStamp);
-
-    int poseSize;
-    Serialization::Read(is, poseSize);
-    for( int i = 0; i < poseSize; ++i )
-    {
-        std::string key;
-        Serialization::Read(is, key);
-        Serialization::Read(is, m_pose[key]);
-    }
+    m_pose.Deserialize(is);
 }
@@ -4,37 +4,28 @@
 #ifndef KEY_FRAME_H_
 #define KEY_FRAME_H_
 
-struct BoneTransform
-{
-    glm::mat4 GetTransformMatrix()
-    {
-        glm::mat4 r = glm::toMat4(rotation);
-        glm::mat4 t = glm::translate(glm::identity<glm::mat4>(), position);
-        return t * r;
-    }
-
-    static BoneTransform Interpolate(BoneTransform& a, BoneTransform& b, float t)
-    {
-        BoneTransform transform;
-        transform.position = glm::lerp(a.position, b.position, t);
-        transform.rotation = glm::slerp(a.rotation, b.rotation, t);
-        return transform;
-    }
-
-    glm::vec3 position;
-    glm::quat rotation;
-};
-
+#include "Pose.h"
+
+//
+// class KeyFrame
+//
+// A Pose placed on the timeline of an 'Animation'.
+// The pose is indexed by bone index of the Skeleton that the Animation is bound to.
+//
 class KeyFrame
 {
 public:
-    std::map<std::string, BoneTransform>& GetPose();
+    KeyFrame();
+
+    Pose& GetPose();
+
+    const Pose& GetPose() const;
 
-    void AddPose(const char* boneName, BoneTransform transform);
+    void SetBoneTransform(int boneIndex, BoneTransform transform);
 
     void SetTimestamp(float timeStamp);
 
-    float GetTimeStamp();
+    float GetTimeStamp() const;
 
     void Serialize(std::ostream& os) const;
 
@@ -42,7 +33,7 @@ public:
 
 private:
     float m_timeStamp;
-    std::map<std::string, BoneTransform> m_pose;
+    Pose m_pose;
 };
 
 #endif
@@ -10,7 +10,7 @@
 #include "KnightPunchingScene.h"
 #include "Object.h"
 #include "Material.h"
-#include "FbxLoader.h"
+#include "AssetCooker.h"
 #include "System.h"
 #include "Geometry.h"
 
@@ -57,19 +57,12 @@ void KnightPunchingScene::Init()
         m_directionalLights.push_back(light);
     }
 
-    // Load Objecrts
-    FbxLoader loader;
-    std::shared_ptr<Object> obj;
-
+    // Load Objecrts. FBX files are imported only when their cooked assets are missing or out of date.
     // Punching Knight
-    loader.Load("./Resources/Punching Knight.fbx");
-    obj = loader.GetObjectByIndex(0);
-    m_objects.push_back(obj);
+    AssetCooker::Load("./Resources/Punching Knight.fbx", m_objects);
 
     // Coast
-    loader.Load("./Resources/Terrain/Coast.fbx");
-    obj = loader.GetObjectByIndex(0);
-    m_objects.push_back(obj);
+    AssetCooker::Load("./Resources/Terrain/Coast.fbx", m_objects);
 
     //// Add ground
     //AddGround();
@@ -95,7 +88,7 @@ void KnightPunchingScene::Init()
     }
 }
 
-void KnightPunchingScene::Update()
+void KnightPunchingScene::Update(float dt)
 {
     float time = System::Instance()->CurrentTime() * 0.25f;
     float x = cosf(time);
@@ -103,7 +96,7 @@ void KnightPunchingScene::Update()
     float z = sinf(time);
     m_directionalLights[0].SetDirection(glm::normalize(glm::vec3(x, y, z)));
 
-    this->Scene::Update();
+    this->Scene::Update(dt);
 }
 
 void KnightPunchingScene::AddGround()
@@ -17,7 +17,7 @@ public:
     KnightPunchingScene();
 
     void Init() override;
-    void Update() override;
+    void Update(float dt) override;
 
 private:
     void AddGround();
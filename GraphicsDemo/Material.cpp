@@ -159,7 +159,44 @@ namespace {
 
     const int PixelComponentCount = 4;
 
-    void SerializeTextureObject(std::ostream& os, GLuint textureObject)
+    // How a map is stored. Scene files saved before 8 bit maps were kept as they are store every map as float.
+    enum MapEncoding
+    {
+        ME_NONE,
+        ME_FLOAT,
+        ME_UNORM8,
+    };
+
+    // Maps loaded from image files have 8 bit channels. Storing them as float would only make files 4 times larger.
+    MapEncoding GetMapEncoding(GLuint textureObject)
+    {
+        glBindTexture(GL_TEXTURE_2D, textureObject);
+        GET_AND_HANDLE_GL_ERROR();
+
+        GLint internalFormat;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+        GET_AND_HANDLE_GL_ERROR();
+
+        switch (internalFormat)
+        {
+        case GL_RGB: case GL_RGBA: case GL_RGB8: case GL_RGBA8:
+            return ME_UNORM8;
+        default:
+            return ME_FLOAT;
+        }
+    }
+
+    GLenum GetPixelType(MapEncoding encoding)
+    {
+        return encoding == ME_UNORM8 ? GL_UNSIGNED_BYTE : GL_FLOAT;
+    }
+
+    size_t GetPixelSize(MapEncoding encoding)
+    {
+        return (encoding == ME_UNORM8 ? sizeof(uint8_t) : sizeof(float)) * PixelComponentCount;
+    }
+
+    void SerializeTextureObject(std::ostream& os, GLuint textureObject, MapEncoding encoding)
     {
         glBindTexture(GL_TEXTURE_2D, textureObject);
         GET_AND_HANDLE_GL_ERROR();
@@ -174,8 +211,10 @@ namespace {
         GET_AND_HANDLE_GL_ERROR();
         assert(height > 0);
 
-        std::vector<char> buffer(sizeof(float) * width * height * PixelComponentCount);
-        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, buffer.data());
+        std::vector<char> buffer(GetPixelSize(encoding) * width * height);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        GET_AND_HANDLE_GL_ERROR();
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GetPixelType(encoding), buffer.data());
         GET_AND_HANDLE_GL_ERROR();
 
         Serialization::Write(os, width);
@@ -183,12 +222,12 @@ namespace {
         os.write(buffer.data(), buffer.size());
     }
 
-    void DeserializeTextureObject(std::istream& is, GLuint& map)
+    void DeserializeTextureObject(std::istream& is, GLuint& map, MapEncoding encoding)
     {
         int width, height;
         Serialization::Read(is, width);
         Serialization::Read(is, height);
-        std::vector<char> buffer(width * height * PixelComponentCount * sizeof(float), '\0');
+        std::vector<char> buffer(GetPixelSize(encoding) * width * height, '\0');
         is.read(buffer.data(), buffer.size());
 
         glGenTextures(1, &map);
@@ -203,27 +242,31 @@ namespace {
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         GET_AND_HANDLE_GL_ERROR();
 
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_FLOAT, buffer.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        GET_AND_HANDLE_GL_ERROR();
+
+        const GLint InternalFormat = encoding == ME_UNORM8 ? GL_RGBA8 : GL_RGBA;
+        glTexImage2D(GL_TEXTURE_2D, 0, InternalFormat, width, height, 0, GL_RGBA, GetPixelType(encoding), buffer.data());
         GET_AND_HANDLE_GL_ERROR();
     }
 
     void SerializeMap(std::ostream& os, GLuint map)
     {
-        int mapCount = map ? 1 : 0;
-        Serialization::Write(os, mapCount);
-        if (mapCount)
+        const MapEncoding Encoding = map ? GetMapEncoding(map) : ME_NONE;
+        Serialization::Write(os, static_cast<int>(Encoding));
+        if (Encoding != ME_NONE)
         {
-            SerializeTextureObject(os, map);
+            SerializeTextureObject(os, map, Encoding);
         }
     }
 
     void DeserializeMap(std::istream& is, GLuint& map)
     {
-        int mapCount;
-        Serialization::Read(is, mapCount);
-        if (mapCount)
+        int encoding;
+        Serialization::Read(is, encoding);
+        if (encoding != ME_NONE)
         {
-            DeserializeTextureObject(is, map);
+            DeserializeTextureObject(is, map, static_cast<MapEncoding>(encoding));
         }
     }
 }
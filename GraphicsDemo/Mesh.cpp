@@ -7,6 +7,7 @@
 #include "Mesh.h"
 #include "Errors.h"
 #include "Serialization.h"
+#include "BoneInfluences.h"
 
 void Mesh::Free()
 {
@@ -41,6 +42,12 @@ void Mesh::Free()
         m_tangent->Free();
         m_tangent.reset();
     }
+    if (m_indices)
+    {
+        m_indices->Free();
+        m_indices.reset();
+    }
+    m_pSkinningSource.reset();
 
 }
 
@@ -84,12 +91,73 @@ void Mesh::Apply()
     }
     if (m_weights)
     {
-        m_weights->VertexAttribPointer(4, GL_FALSE);
+        // Packed weights are normalized integers; float weights of older scene files ignore the flag.
+        m_weights->VertexAttribPointer(4, GL_TRUE);
     }
     if (m_tangent)
     {
         m_tangent->VertexAttribPointer(5, GL_FALSE);
     }
+    if (m_indices)
+    {
+        m_indices->Bind();
+    }
+}
+
+void Mesh::DrawSubMesh(int i)
+{
+    const SubMesh& subMesh = m_subMeshes[i];
+    if (m_indices)
+    {
+        m_indices->DrawTriangles(subMesh.begin, subMesh.vertCount);
+    }
+    else
+    {
+        glDrawArrays(GL_TRIANGLES, subMesh.begin, subMesh.vertCount);
+        GET_AND_HANDLE_GL_ERROR();
+    }
+}
+
+std::shared_ptr<const CpuSkinning::Source> Mesh::GetSkinningSource()
+{
+    if (m_pSkinningSource || !m_position || !m_bones || !m_weights)
+        return m_pSkinningSource;
+
+    std::shared_ptr<CpuSkinning::Source> pSource(new CpuSkinning::Source);
+    m_position->GetData(pSource->positions);
+    if (m_normal)
+    {
+        m_normal->GetData(pSource->normals);
+    }
+    if (m_tangent)
+    {
+        m_tangent->GetData(pSource->tangents);
+    }
+    if (!BoneInfluences::Decode(*m_bones, *m_weights, pSource->bones, pSource->weights))
+    {
+        std::cout << "Mesh::GetSkinningSource() : unknown bone stream layout" << std::endl;
+        return nullptr;
+    }
+
+    pSource->vertexCount = static_cast<int>(pSource->positions.size() / 3);
+    if (pSource->bones.size() != pSource->vertexCount * CpuSkinning::BonesPerVertex
+        || pSource->weights.size() != pSource->vertexCount * CpuSkinning::BonesPerVertex)
+    {
+        std::cout << "Mesh::GetSkinningSource() : bone streams don't match " << pSource->vertexCount << " vertices" << std::endl;
+        return nullptr;
+    }
+    // Streams that don't cover every vertex are left out rather than read past.
+    if (pSource->normals.size() != pSource->vertexCount * 3)
+    {
+        pSource->normals.clear();
+    }
+    if (pSource->tangents.size() != pSource->vertexCount * 4)
+    {
+        pSource->tangents.clear();
+    }
+
+    m_pSkinningSource = pSource;
+    return m_pSkinningSource;
 }
 
 namespace
@@ -114,10 +182,15 @@ namespace
             pAttributeArray->Deserialize(is);
         }
     }
+
+    // Written before sub mesh count by meshes that may have index array. Sub mesh count is never negative,
+    // so scene files saved before indexed meshes are read as they are.
+    const int IndexedMeshTag = -1;
 }
 
 void Mesh::Serialize(std::ostream& os)
 {
+    Serialization::Write(os, IndexedMeshTag);
     int subMeshCount = static_cast<int>(m_subMeshes.size());
     Serialization::Write(os, subMeshCount);
     for (int i = 0; i < m_subMeshes.size(); ++i)
@@ -133,12 +206,23 @@ void Mesh::Serialize(std::ostream& os)
     SerializeAttributeArrayPointer(os, m_weights);
     SerializeAttributeArrayPointer(os, m_tangent);
 
+    int indexArrayCount = m_indices ? 1 : 0;
+    Serialization::Write(os, indexArrayCount);
+    if (indexArrayCount)
+    {
+        m_indices->Serialize(os);
+    }
 }
 
 void Mesh::Deserialize(std::istream& is)
 {
     int subMeshCount = 0;
     Serialization::Read(is, subMeshCount);
+    const bool IndexedMesh = subMeshCount == IndexedMeshTag;
+    if (IndexedMesh)
+    {
+        Serialization::Read(is, subMeshCount);
+    }
     for (int i = 0; i < subMeshCount; ++i)
     {
         SubMesh subMesh;
@@ -152,12 +236,60 @@ void Mesh::Deserialize(std::istream& is)
     DeserializeAttributeArrayPointer(is, m_bones);
     DeserializeAttributeArrayPointer(is, m_weights);
     DeserializeAttributeArrayPointer(is, m_tangent);
+
+    int indexArrayCount = 0;
+    if (IndexedMesh)
+    {
+        Serialization::Read(is, indexArrayCount);
+    }
+    if (indexArrayCount)
+    {
+        m_indices.reset(new IndexArray());
+        m_indices->Deserialize(is);
+    }
+
+    // Scene files saved before bone influences were packed store three int indices and three float weights.
+    if (m_bones && m_weights && m_bones->GetType() == GL_INT)
+    {
+        PackBoneInfluences();
+    }
+}
+
+void Mesh::PackBoneInfluences()
+{
+    std::vector<int> bones;
+    std::vector<float> weights;
+    if (!BoneInfluences::Decode(*m_bones, *m_weights, bones, weights))
+        return;
+
+    const int VertexCount = static_cast<int>(bones.size() / BoneInfluences::ComponentCount);
+    BoneInfluences influences;
+    influences.Reserve(VertexCount);
+    std::vector<BoneInfluences::Influence> vertexInfluences;
+    for (int i = 0; i < VertexCount; ++i)
+    {
+        vertexInfluences.clear();
+        for (int j = 0; j < BoneInfluences::ComponentCount; ++j)
+        {
+            const int Index = i * BoneInfluences::ComponentCount + j;
+            if (weights[Index] > 0.0f)
+            {
+                vertexInfluences.push_back(BoneInfluences::Influence(bones[Index], weights[Index]));
+            }
+        }
+        influences.AddVertex(vertexInfluences);
+    }
+
+    m_bones->Free();
+    m_weights->Free();
+    m_bones = influences.CreateBonesAttributeArray();
+    m_weights = influences.CreateWeightsAttributeArray();
 }
 
 void Mesh::SetDefaultSubMesh()
 {
     m_subMeshes.push_back(SubMesh
     {
-            0, m_position->GetAttributeCount()
+            0, m_indices ? m_indices->GetIndexCount() : m_position->GetAttributeCount()
     });
 }
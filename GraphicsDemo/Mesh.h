@@ -15,12 +15,15 @@
 #define MESH_H_
 
 #include "AttributeArray.h"
+#include "IndexArray.h"
+#include "CpuSkinning.h"
 
 struct RecordHeader;
 
 class Mesh
 {
 public:
+    // Range of indices if mesh has index array, range of vertices otherwise.
     struct SubMesh
     {
         int begin;
@@ -29,6 +32,9 @@ public:
 
     void Apply();
 
+    // Draws sub mesh 'i' with glDrawElements if mesh has index array, glDrawArrays otherwise. Call after Apply().
+    void DrawSubMesh(int i);
+
     void Free();
 
     bool HasSubMesh();
@@ -103,8 +109,23 @@ public:
         m_tangent = aa;
     }
 
+    std::shared_ptr<IndexArray> GetIndexArray()
+    {
+        return m_indices;
+    }
+
+    // Makes vertices drawn by index. Sub meshes are index ranges then.
+    void SetIndexArray(std::shared_ptr<IndexArray> indices)
+    {
+        m_indices = indices;
+    }
+
     void SetDefaultSubMesh();
 
+    // Gets bind pose vertex streams for CPU skinning. Read back from attribute arrays on the first call, so it must be
+    // called on the thread that owns GL context. nullptr if mesh has no bone weights.
+    std::shared_ptr<const CpuSkinning::Source> GetSkinningSource();
+
 private:
     std::vector<SubMesh> m_subMeshes;
     std::shared_ptr<AttributeArray> m_position;
@@ -113,6 +134,11 @@ private:
     std::shared_ptr<AttributeArray> m_bones;
     std::shared_ptr<AttributeArray> m_weights;
     std::shared_ptr<AttributeArray> m_tangent;
+    std::shared_ptr<IndexArray> m_indices;
+    std::shared_ptr<const CpuSkinning::Source> m_pSkinningSource;
+
+    // Replaces bone and weight attribute arrays with the packed layout of BoneInfluences.
+    void PackBoneInfluences();
 };
 
 #endif MESH_H_
@@ -0,0 +1,340 @@
+/*
+    MeshOptimizer.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    References :
+        Linear-Speed Vertex Cache Optimisation, Tom Forsyth
+            https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+        Fast Triangle Reordering for Vertex Locality and Reduced Overdraw, Sander, Nehab, Barczak( SIGGRAPH 2007 )
+
+    MeshOptimizer class implementation.
+*/
+#include "Common.h"
+#include "MeshOptimizer.h"
+
+namespace
+{
+    const int TriangleVertexCount = 3;
+
+    // Forsyth's scoring. Cache modelled as LRU of MaxScoredCacheSize vertices.
+    const int MaxScoredCacheSize = 32;
+    const float CacheDecayPower = 1.5f;
+    const float LastTriangleScore = 0.75f;
+    const float ValenceBoostScale = 2.0f;
+    const float ValenceBoostPower = 0.5f;
+
+    // Overdraw order is dropped if it makes ACMR worse than this times cache order's.
+    const float OverdrawAcmrThreshold = 1.05f;
+
+    float GetVertexScore(int cachePosition, int remainingValence)
+    {
+        // Nothing left to draw with the vertex
+        if (remainingValence == 0)
+            return -1.0f;
+
+        float score = 0.0f;
+        if (cachePosition >= 0)
+        {
+            if (cachePosition < TriangleVertexCount)
+            {
+                // Used by the last triangle. Fixed score so the next triangle doesn't strip along one of its edges.
+                score = LastTriangleScore;
+            }
+            else
+            {
+                const float Scaler = 1.0f / (MaxScoredCacheSize - TriangleVertexCount);
+                score = std::pow(1.0f - (cachePosition - TriangleVertexCount) * Scaler, CacheDecayPower);
+            }
+        }
+
+        // Vertices with few triangles left are finished first, so they don't become lone triangles later.
+        score += ValenceBoostScale * std::pow(static_cast<float>(remainingValence), -ValenceBoostPower);
+        return score;
+    }
+
+    glm::vec3 GetPosition(const float* pPositions, uint32_t index)
+    {
+        const float* p = pPositions + static_cast<size_t>(index) * 3;
+        return glm::vec3(p[0], p[1], p[2]);
+    }
+}
+
+MeshOptimizer::Statistics MeshOptimizer::Measure(const uint32_t* pIndices, int indexCount)
+{
+    Statistics statistics = { 0.0f, 0.0f };
+    if (indexCount < TriangleVertexCount)
+        return statistics;
+
+    // FIFO: a hit doesn't move the vertex.
+    std::deque<uint32_t> cache;
+    std::unordered_set<uint32_t> usedVertices;
+    int missCount = 0;
+    for (int i = 0; i < indexCount; ++i)
+    {
+        const uint32_t Index = pIndices[i];
+        usedVertices.insert(Index);
+        if (std::find(cache.begin(), cache.end(), Index) != cache.end())
+            continue;
+
+        ++missCount;
+        cache.push_back(Index);
+        if (cache.size() > CacheSize)
+        {
+            cache.pop_front();
+        }
+    }
+
+    statistics.acmr = static_cast<float>(missCount) / (indexCount / TriangleVertexCount);
+    statistics.atvr = static_cast<float>(missCount) / usedVertices.size();
+    return statistics;
+}
+
+void MeshOptimizer::OptimizeTriangleOrder(uint32_t* pIndices, int indexCount, int vertexCount, const float* pPositions)
+{
+    assert(indexCount % TriangleVertexCount == 0);
+    if (indexCount < TriangleVertexCount * 2)
+        return;
+
+    OptimizeVertexCache(pIndices, indexCount, vertexCount);
+    if (pPositions)
+    {
+        OptimizeOverdraw(pIndices, indexCount, pPositions);
+    }
+}
+
+void MeshOptimizer::OptimizeVertexOrder(std::vector<uint32_t>& indices, int vertexCount, std::vector<uint32_t>& newToOld)
+{
+    const uint32_t Unused = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> oldToNew(vertexCount, Unused);
+    newToOld.clear();
+    newToOld.reserve(vertexCount);
+    for (uint32_t& index : indices)
+    {
+        if (oldToNew[index] == Unused)
+        {
+            oldToNew[index] = static_cast<uint32_t>(newToOld.size());
+            newToOld.push_back(index);
+        }
+        index = oldToNew[index];
+    }
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t* pIndices, int indexCount, int vertexCount)
+{
+    const int TriangleCount = indexCount / TriangleVertexCount;
+
+    // Triangles of each vertex. First 'remainingValences[v]' of the list of v are the ones not drawn yet.
+    std::vector<int> triangleListOffsets(vertexCount + 1, 0);
+    for (int i = 0; i < indexCount; ++i)
+    {
+        ++triangleListOffsets[pIndices[i] + 1];
+    }
+    for (int v = 0; v < vertexCount; ++v)
+    {
+        triangleListOffsets[v + 1] += triangleListOffsets[v];
+    }
+    std::vector<int> remainingValences(vertexCount, 0);
+    std::vector<int> triangleLists(indexCount);
+    for (int i = 0; i < indexCount; ++i)
+    {
+        const uint32_t Vertex = pIndices[i];
+        triangleLists[triangleListOffsets[Vertex] + remainingValences[Vertex]++] = i / TriangleVertexCount;
+    }
+
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount, 0.0f);
+    for (int v = 0; v < vertexCount; ++v)
+    {
+        vertexScores[v] = GetVertexScore(-1, remainingValences[v]);
+    }
+
+    auto GetTriangleScore = [&](int triangle)
+    {
+        const uint32_t* pTriangle = pIndices + triangle * TriangleVertexCount;
+        return vertexScores[pTriangle[0]] + vertexScores[pTriangle[1]] + vertexScores[pTriangle[2]];
+    };
+
+    std::vector<bool> drawn(TriangleCount, false);
+    int bestTriangle = 0;
+    float bestScore = -1.0f;
+    for (int t = 0; t < TriangleCount; ++t)
+    {
+        const float Score = GetTriangleScore(t);
+        if (Score > bestScore)
+        {
+            bestScore = Score;
+            bestTriangle = t;
+        }
+    }
+
+    std::vector<uint32_t> ordered;
+    ordered.reserve(indexCount);
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> nextCache;
+    cache.reserve(MaxScoredCacheSize + TriangleVertexCount);
+    nextCache.reserve(MaxScoredCacheSize + TriangleVertexCount);
+    int nextUndrawnTriangle = 0;
+    for (int n = 0; n < TriangleCount; ++n)
+    {
+        // Nothing in cache has triangles left; start over from the first triangle not drawn.
+        if (bestTriangle < 0)
+        {
+            while (drawn[nextUndrawnTriangle])
+            {
+                ++nextUndrawnTriangle;
+            }
+            bestTriangle = nextUndrawnTriangle;
+        }
+
+        const uint32_t* pTriangle = pIndices + bestTriangle * TriangleVertexCount;
+        drawn[bestTriangle] = true;
+        nextCache.clear();
+        for (int k = 0; k < TriangleVertexCount; ++k)
+        {
+            const uint32_t Vertex = pTriangle[k];
+            ordered.push_back(Vertex);
+            nextCache.push_back(Vertex);
+
+            // Moves the triangle out of the undrawn part of the list.
+            int* pList = &triangleLists[triangleListOffsets[Vertex]];
+            int* pEnd = pList + remainingValences[Vertex];
+            std::iter_swap(std::find(pList, pEnd, bestTriangle), pEnd - 1);
+            --remainingValences[Vertex];
+        }
+
+        // LRU: vertices of the triangle move to the front.
+        for (uint32_t vertex : cache)
+        {
+            if (vertex != pTriangle[0] && vertex != pTriangle[1] && vertex != pTriangle[2])
+            {
+                nextCache.push_back(vertex);
+            }
+        }
+        for (size_t i = 0; i < nextCache.size(); ++i)
+        {
+            const uint32_t Vertex = nextCache[i];
+            cachePositions[Vertex] = i < MaxScoredCacheSize ? static_cast<int>(i) : -1;
+            vertexScores[Vertex] = GetVertexScore(cachePositions[Vertex], remainingValences[Vertex]);
+        }
+        if (nextCache.size() > MaxScoredCacheSize)
+        {
+            nextCache.resize(MaxScoredCacheSize);
+        }
+        cache.swap(nextCache);
+
+        // Only triangles of cached vertices changed score.
+        bestTriangle = -1;
+        bestScore = -1.0f;
+        for (uint32_t vertex : cache)
+        {
+            const int* pList = &triangleLists[triangleListOffsets[vertex]];
+            for (int i = 0; i < remainingValences[vertex]; ++i)
+            {
+                const float Score = GetTriangleScore(pList[i]);
+                if (Score > bestScore)
+                {
+                    bestScore = Score;
+                    bestTriangle = pList[i];
+                }
+            }
+        }
+    }
+
+    std::copy(ordered.begin(), ordered.end(), pIndices);
+}
+
+void MeshOptimizer::OptimizeOverdraw(uint32_t* pIndices, int indexCount, const float* pPositions)
+{
+    const int TriangleCount = indexCount / TriangleVertexCount;
+    const float CacheAcmr = Measure(pIndices, indexCount).acmr;
+
+    // Clusters start where the cache order restarts: triangles whose vertices all miss.
+    std::vector<int> clusterBegins;
+    std::deque<uint32_t> cache;
+    for (int t = 0; t < TriangleCount; ++t)
+    {
+        int missCount = 0;
+        for (int k = 0; k < TriangleVertexCount; ++k)
+        {
+            const uint32_t Index = pIndices[t * TriangleVertexCount + k];
+            if (std::find(cache.begin(), cache.end(), Index) != cache.end())
+                continue;
+
+            ++missCount;
+            cache.push_back(Index);
+            if (cache.size() > CacheSize)
+            {
+                cache.pop_front();
+            }
+        }
+        if (t == 0 || missCount == TriangleVertexCount)
+        {
+            clusterBegins.push_back(t);
+        }
+    }
+    clusterBegins.push_back(TriangleCount);
+    const int ClusterCount = static_cast<int>(clusterBegins.size()) - 1;
+    if (ClusterCount < 2)
+        return;
+
+    // Area weighted centroids and normals of clusters and of the mesh
+    std::vector<glm::vec3> clusterCentroids(ClusterCount, glm::vec3(0.0f));
+    std::vector<glm::vec3> clusterNormals(ClusterCount, glm::vec3(0.0f));
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (int c = 0; c < ClusterCount; ++c)
+    {
+        float clusterArea = 0.0f;
+        for (int t = clusterBegins[c]; t < clusterBegins[c + 1]; ++t)
+        {
+            const uint32_t* pTriangle = pIndices + t * TriangleVertexCount;
+            const glm::vec3 P0 = GetPosition(pPositions, pTriangle[0]);
+            const glm::vec3 P1 = GetPosition(pPositions, pTriangle[1]);
+            const glm::vec3 P2 = GetPosition(pPositions, pTriangle[2]);
+            const glm::vec3 Normal = glm::cross(P1 - P0, P2 - P0);
+            const float Area = glm::length(Normal) * 0.5f;
+            const glm::vec3 Centroid = (P0 + P1 + P2) / 3.0f;
+            clusterCentroids[c] += Centroid * Area;
+            clusterNormals[c] += Normal;
+            clusterArea += Area;
+        }
+        meshCentroid += clusterCentroids[c];
+        meshArea += clusterArea;
+        if (clusterArea > 0.0f)
+        {
+            clusterCentroids[c] /= clusterArea;
+        }
+    }
+    if (meshArea <= 0.0f)
+        return;
+    meshCentroid /= meshArea;
+
+    // Clusters that face away from the center are on the outside of the mesh and occlude the rest; they go first.
+    std::vector<float> occlusions(ClusterCount, 0.0f);
+    std::vector<int> clusterOrder(ClusterCount);
+    for (int c = 0; c < ClusterCount; ++c)
+    {
+        const float NormalLength = glm::length(clusterNormals[c]);
+        if (NormalLength > 0.0f)
+        {
+            occlusions[c] = glm::dot(clusterCentroids[c] - meshCentroid, clusterNormals[c] / NormalLength);
+        }
+        clusterOrder[c] = c;
+    }
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&occlusions](int a, int b)
+    {
+        return occlusions[a] > occlusions[b];
+    });
+
+    std::vector<uint32_t> ordered;
+    ordered.reserve(indexCount);
+    for (int c : clusterOrder)
+    {
+        ordered.insert(ordered.end(), pIndices + clusterBegins[c] * TriangleVertexCount, pIndices + clusterBegins[c + 1] * TriangleVertexCount);
+    }
+    if (Measure(ordered.data(), indexCount).acmr <= CacheAcmr * OverdrawAcmrThreshold)
+    {
+        std::copy(ordered.begin(), ordered.end(), pIndices);
+    }
+}
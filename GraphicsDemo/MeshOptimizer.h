@@ -0,0 +1,80 @@
+/*
+    MeshOptimizer.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    References :
+        Linear-Speed Vertex Cache Optimisation, Tom Forsyth
+            https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+        Fast Triangle Reordering for Vertex Locality and Reduced Overdraw, Sander, Nehab, Barczak( SIGGRAPH 2007 )
+
+    MeshOptimizer class definition.
+*/
+#ifndef MESH_OPTIMIZER_H_
+#define MESH_OPTIMIZER_H_
+
+//
+// class MeshOptimizer
+//
+// Reorders indexed triangle lists for the GPU:
+//  - Triangles, for the post-transform vertex cache( Forsyth ), then clusters of them, so that triangles facing outward
+//    from the mesh are drawn first and hide the ones behind( Sander et al. ). Cluster order is kept only if it doesn't
+//    cost more than a few percent of cache efficiency.
+//  - Vertices, in order of first use, so that vertex fetch walks buffers forward.
+// Triangle order changes within a range of indices only, so sub mesh( material ) ranges stay valid.
+//
+// Cache efficiency is measured on a FIFO cache of CacheSize vertices:
+//  ACMR - average cache miss ratio, vertices transformed per triangle. 3 at worst, about 0.5 at best for regular meshes.
+//  ATVR - average transform to vertex ratio, vertices transformed per vertex used. 1 at best.
+//
+// usage:
+//  MeshOptimizer::Statistics before = MeshOptimizer::Measure(&indices[begin], count);
+//  MeshOptimizer::OptimizeTriangleOrder(&indices[begin], count, vertexCount, positions.data());
+//  ...every sub mesh
+//  std::vector<uint32_t> newToOld;
+//  MeshOptimizer::OptimizeVertexOrder(indices, vertexCount, newToOld);
+//  MeshOptimizer::RemapVertices(positions, 3, newToOld);
+//
+class MeshOptimizer
+{
+public:
+    enum { CacheSize = 16 };
+
+    struct Statistics
+    {
+        float acmr;
+        float atvr;
+    };
+
+    // Simulates FIFO vertex cache over triangle list 'pIndices' of 'indexCount' indices.
+    static Statistics Measure(const uint32_t* pIndices, int indexCount);
+
+    // Reorders triangles of 'pIndices' for vertex cache and overdraw. Indices refer to 'vertexCount' vertices
+    // whose positions are three floats each in 'pPositions'.
+    static void OptimizeTriangleOrder(uint32_t* pIndices, int indexCount, int vertexCount, const float* pPositions);
+
+    // Renumbers vertices in order of first use in 'indices'. 'newToOld' receives old index of each new vertex;
+    // vertices 'indices' doesn't use are dropped.
+    static void OptimizeVertexOrder(std::vector<uint32_t>& indices, int vertexCount, std::vector<uint32_t>& newToOld);
+
+    // Reorders 'stream' of 'componentCount' elements per vertex by 'newToOld'.
+    template <typename T>
+    static void RemapVertices(std::vector<T>& stream, int componentCount, const std::vector<uint32_t>& newToOld)
+    {
+        std::vector<T> remapped(newToOld.size() * componentCount);
+        for (size_t i = 0; i < newToOld.size(); ++i)
+        {
+            std::copy_n(&stream[static_cast<size_t>(newToOld[i]) * componentCount], componentCount, &remapped[i * componentCount]);
+        }
+        stream.swap(remapped);
+    }
+
+private:
+    // Forsyth ordering of 'pIndices' for vertex cache
+    static void OptimizeVertexCache(uint32_t* pIndices, int indexCount, int vertexCount);
+
+    // Sorts clusters of cache ordered 'pIndices' front to back by how much they face outward from the mesh.
+    static void OptimizeOverdraw(uint32_t* pIndices, int indexCount, const float* pPositions);
+};
+
+#endif
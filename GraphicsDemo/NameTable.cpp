@@ -0,0 +1,95 @@
+/*
+    NameTable.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    References :
+        http://www.isthe.com/chongo/tech/comp/fnv/index.html
+
+    NameTable class implementation.
+*/
+#include "Common.h"
+#include "NameTable.h"
+
+namespace
+{
+    // 32 bit FNV-1a
+    uint32_t HashName(const char* name, size_t length)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < length; ++i)
+        {
+            hash ^= static_cast<uint8_t>(name[i]);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    const std::string EmptyName;
+}
+
+NameTable::NameTable()
+    : m_mutex()
+    , m_strings()
+    , m_idsByHash()
+{
+}
+
+NameId NameTable::Intern(const char* name)
+{
+    const size_t Length = std::strlen(name);
+    const uint32_t Hash = HashName(name, Length);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const NameId Found = FindLocked(name, Length, Hash);
+    if (Found != INVALID_NAME_ID)
+        return Found;
+
+    const NameId Id = static_cast<NameId>(m_strings.size());
+    assert(Id != INVALID_NAME_ID);
+    m_strings.emplace_back(name, Length);
+    m_idsByHash.insert(std::make_pair(Hash, Id));
+    return Id;
+}
+
+NameId NameTable::Intern(const std::string& name)
+{
+    return Intern(name.c_str());
+}
+
+NameId NameTable::Find(const char* name) const
+{
+    const size_t Length = std::strlen(name);
+    const uint32_t Hash = HashName(name, Length);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return FindLocked(name, Length, Hash);
+}
+
+const std::string& NameTable::GetString(NameId id) const
+{
+    if (id == INVALID_NAME_ID)
+        return EmptyName;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    assert(id < m_strings.size());
+    return m_strings[id];
+}
+
+int NameTable::GetCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<int>(m_strings.size());
+}
+
+NameId NameTable::FindLocked(const char* name, size_t length, uint32_t hash) const
+{
+    auto range = m_idsByHash.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        const std::string& Candidate = m_strings[it->second];
+        if (Candidate.size() == length && std::memcmp(Candidate.data(), name, length) == 0)
+            return it->second;
+    }
+    return INVALID_NAME_ID;
+}
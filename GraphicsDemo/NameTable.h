@@ -0,0 +1,64 @@
+/*
+    NameTable.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    References :
+        http://www.isthe.com/chongo/tech/comp/fnv/index.html
+
+    NameTable class definition.
+*/
+#ifndef NAME_TABLE_H_
+#define NAME_TABLE_H_
+
+#include "Singleton.h"
+
+// Identifies a string interned in NameTable. Comparing two ids is comparing the two strings.
+typedef uint32_t NameId;
+
+//
+// class NameTable
+//
+// Global table of interned strings, such as bone names. Each distinct string gets a 32 bit id once,
+// after which code that used to compare or hash names compares ids instead.
+// Ids are only valid during the run that made them; files store the strings.
+// Interned strings are never released, and references returned by GetString() stay valid.
+// Safe to use from multiple threads.
+//
+// usage:
+//  const NameId Id = NameTable::Instance()->Intern("mixamorig:Hips");
+//  ...
+//  std::cout << NameTable::Instance()->GetString(Id);
+//
+class NameTable : public Singleton<NameTable>
+{
+public:
+    // Id of no name. GetString() of it is empty.
+    static const NameId INVALID_NAME_ID = 0xffffffff;
+
+    NameTable();
+
+    // Returns id of 'name', adding it to the table if it's not there.
+    NameId Intern(const char* name);
+
+    NameId Intern(const std::string& name);
+
+    // Returns id of 'name' if interned, INVALID_NAME_ID otherwise. Never adds to the table.
+    NameId Find(const char* name) const;
+
+    const std::string& GetString(NameId id) const;
+
+    int GetCount() const;
+
+private:
+    mutable std::mutex m_mutex;
+    // Indexed by id. Deque so that adding doesn't move strings handed out by GetString().
+    std::deque<std::string> m_strings;
+    // Ids by hash of their strings
+    std::unordered_multimap<uint32_t, NameId> m_idsByHash;
+
+    // Must be called with m_mutex locked
+    NameId FindLocked(const char* name, size_t length, uint32_t hash) const;
+};
+
+#endif
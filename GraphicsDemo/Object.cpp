@@ -15,11 +15,19 @@
 #include "Material.h"
 #include "ShaderProgram.h"
 #include "Serialization.h"
+#include "BakedAnimation.h"
+#include "SkinnedMesh.h"
 
 namespace
 {
-    const int MaximumBoneCount = 128;
-    const char* const JointTransformsUniformName = "uJointTransforms[0]";
+    // Palette rows per bone
+    const int RowsPerBone = 3;
+    // Size of JointPalette uniform block
+    const GLsizeiptr PaletteBufferSize = Skeleton::MAXIMUM_BONE_COUNT * RowsPerBone * sizeof(glm::vec4);
+    // m_uploadedPaletteVersion of identity palette, used until animator has a palette
+    const int64_t BindPosePaletteVersion = -2;
+    // Texture unit baked palettes are bound to. Units below are taken by materials and shadow maps.
+    const int BakedPaletteTextureUnit = 12;
 }
 
 Object::Object()
@@ -28,6 +36,10 @@ Object::Object()
     , m_rotation(glm::identity<glm::quat>())
     , m_mwMatrix(glm::identity<glm::mat4x4>())
     , m_meshes()
+    , m_paletteBuffer(0)
+    , m_uploadedPaletteVersion(-1)
+    , m_paletteRows()
+    , m_skinnedMeshes()
 {
 }
 
@@ -82,11 +94,11 @@ void Object::UpdateTransformMatrix()
     m_mwMatrix = t * r * s;
 }
 
-void Object::Update()
+void Object::Update(float dt)
 {
     if (m_pAnimator)
     {
-        m_pAnimator->Update(*this);
+        m_pAnimator->Update(*this, dt);
     }
 }
 
@@ -127,6 +139,16 @@ std::shared_ptr<Mesh> Object::GetMesh(int index)
 
 void Object::Free()
 {
+    SetCpuSkinningEnabled(false);
+
+    if (m_paletteBuffer)
+    {
+        glDeleteBuffers(1, &m_paletteBuffer);
+        GET_AND_HANDLE_GL_ERROR();
+        m_paletteBuffer = 0;
+        m_uploadedPaletteVersion = -1;
+    }
+
     while (!m_materials.empty())
     {
         m_materials.back()->Free();
@@ -144,19 +166,30 @@ void Object::Free()
     m_pSkeleton.reset();
 }
 
-std::shared_ptr<Skeleton> Object::GetSkeleton()
+std::shared_ptr<const Skeleton> Object::GetSkeleton()
 {
     return m_pSkeleton;
 }
 
-void Object::SetSkeleton(std::shared_ptr<Skeleton> pSkeleton)
+void Object::SetSkeleton(std::shared_ptr<const Skeleton> pSkeleton)
 {
     m_pSkeleton = pSkeleton;
 }
 
+std::shared_ptr<Animator> Object::GetAnimator()
+{
+    return m_pAnimator;
+}
+
 void Object::SetAnimator(std::shared_ptr<Animator> pAnimator)
 {
     m_pAnimator = pAnimator;
+    // Versions are per animator, so the new one's can match what was uploaded or skinned from the old one.
+    m_uploadedPaletteVersion = -1;
+    for (std::shared_ptr<SkinnedMesh>& pSkinnedMesh : m_skinnedMeshes)
+    {
+        pSkinnedMesh->MarkDirty(-1);
+    }
 }
 
 void Object::Serialize(std::ostream& os)
@@ -220,15 +253,16 @@ void Object::Deserialize(std::istream& is)
         AddMesh(pMesh);
     }
 
-    int skeletonCount;
+    int skeletonCount = 0;
     Serialization::Read(is, skeletonCount);
     if (skeletonCount)
     {
-        m_pSkeleton.reset(new Skeleton());
-        m_pSkeleton->Deserialize(is);
+        std::shared_ptr<Skeleton> pSkeleton(new Skeleton());
+        pSkeleton->Deserialize(is);
+        m_pSkeleton = pSkeleton;
     }
 
-    int animatorCount;
+    int animatorCount = 0;
     Serialization::Read(is, animatorCount);
     if (animatorCount)
     {
@@ -249,37 +283,168 @@ void Object::CopyTo(Object& dest)
 
     dest.m_meshes = m_meshes;
     dest.m_materials = m_materials;
-    if (m_pSkeleton)
-    {
-        dest.m_pSkeleton.reset(new Skeleton);
-        m_pSkeleton->CopyTo(*dest.m_pSkeleton);
-    }
+    // Skeleton is read only once loaded, so copies share it like meshes and materials.
+    // Pose of each copy lives in its own Animator.
+    dest.m_pSkeleton = m_pSkeleton;
     if (m_pAnimator)
     {
         dest.m_pAnimator.reset(new Animator);
         m_pAnimator->CopyTo(*dest.m_pAnimator);
     }
+    // Skinned vertices are per object; skinning sources are already read back and shared through meshes.
+    dest.SetCpuSkinningEnabled(IsCpuSkinningEnabled());
 }
 
 void Object::SendAnimationData(ShaderProgram& program)
 {
-    program.SendUniform("uAnimationEnabled", m_pSkeleton ? GL_TRUE : GL_FALSE);
-    if (m_pSkeleton)
+    // Sampler is pointed at its own unit even when unused. Left at unit 0, it would share the unit with the sampler2D
+    // material maps, and every draw would fail with GL_INVALID_OPERATION.
+    program.SendUniform("uBakedPalette", BakedPaletteTextureUnit);
+
+    // Vertices bound by ApplyMesh() are already skinned.
+    const bool AnimationEnabled = m_pSkeleton && !IsCpuSkinningEnabled();
+    program.SendUniform("uAnimationEnabled", AnimationEnabled ? GL_TRUE : GL_FALSE);
+    if (AnimationEnabled)
+    {
+        // Uploaded baked animation; shader reads palette from the texture buffer by frame.
+        const BakedAnimation* pBaked = m_pAnimator ? m_pAnimator->GetBakedAnimation().get() : nullptr;
+        const bool BakedPaletteEnabled = pBaked && pBaked->GetTexture() != 0 && pBaked->GetSkeleton() == m_pSkeleton.get();
+        program.SendUniform("uBakedPaletteEnabled", BakedPaletteEnabled);
+        if (BakedPaletteEnabled)
+        {
+            glActiveTexture(GL_TEXTURE0 + BakedPaletteTextureUnit);
+            GET_AND_HANDLE_GL_ERROR();
+            glBindTexture(GL_TEXTURE_BUFFER, pBaked->GetTexture());
+            GET_AND_HANDLE_GL_ERROR();
+
+            int frame0;
+            int frame1;
+            float t;
+            m_pAnimator->GetBakedFrames(frame0, frame1, t);
+            // Texel offset of the first bone of each frame. Three texels per bone.
+            const int FrameTexelCount = pBaked->GetBoneCount() * 3;
+            program.SendUniform("uBakedFrameOffsets[0]", frame0 * FrameTexelCount);
+            program.SendUniform("uBakedFrameOffsets[1]", frame1 * FrameTexelCount);
+            program.SendUniform("uBakedFrameBlend", t);
+            return;
+        }
+
+        UploadPalette();
+        glBindBufferBase(GL_UNIFORM_BUFFER, JOINT_PALETTE_BINDING, m_paletteBuffer);
+        GET_AND_HANDLE_GL_ERROR();
+    }
+}
+
+void Object::UploadPalette()
+{
+    const int BoneCount = m_pSkeleton->GetBoneCount();
+    assert(BoneCount <= Skeleton::MAXIMUM_BONE_COUNT);
+
+    // Bind pose until animator fills palette for this skeleton
+    const glm::mat4* pPalette = GetSkinningPalette();
+    const int64_t Version = GetSkinningPaletteVersion();
+    if (m_paletteBuffer != 0 && Version == m_uploadedPaletteVersion)
+        return;
+
+    if (m_paletteBuffer == 0)
     {
-        glm::mat4 boneTransforms[MaximumBoneCount];
-        const int BoneCount = m_pSkeleton->GetBoneCount();
+        glGenBuffers(1, &m_paletteBuffer);
+        GET_AND_HANDLE_GL_ERROR();
+    }
 
-        for (int i = 0; i < BoneCount; ++i)
+    // Matrices are affine; bottom row is always ( 0, 0, 0, 1 ) and isn't sent.
+    m_paletteRows.resize(BoneCount * RowsPerBone);
+    for (int i = 0; i < BoneCount; ++i)
+    {
+        const glm::mat4 M = pPalette ? pPalette[i] : glm::identity<glm::mat4>();
+        for (int row = 0; row < RowsPerBone; ++row)
         {
-            Bone& bone = m_pSkeleton->GetBoneByIndex(i);
-            boneTransforms[i] = bone.GetAnimationTrasnform();
+            m_paletteRows[i * RowsPerBone + row] = glm::vec4(M[0][row], M[1][row], M[2][row], M[3][row]);
         }
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, m_paletteBuffer);
+    GET_AND_HANDLE_GL_ERROR();
+    // Whole block is respecified so that driver doesn't wait for draws still reading the old palette.
+    glBufferData(GL_UNIFORM_BUFFER, PaletteBufferSize, nullptr, GL_STREAM_DRAW);
+    GET_AND_HANDLE_GL_ERROR();
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, m_paletteRows.size() * sizeof(glm::vec4), m_paletteRows.data());
+    GET_AND_HANDLE_GL_ERROR();
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    GET_AND_HANDLE_GL_ERROR();
+
+    m_uploadedPaletteVersion = Version;
+}
 
-        for (int i = BoneCount; i < MaximumBoneCount; ++i)
+void Object::SetCpuSkinningEnabled(bool enabled)
+{
+    if (enabled == IsCpuSkinningEnabled())
+        return;
+
+    if (enabled && m_pSkeleton)
+    {
+        for (std::shared_ptr<Mesh>& pMesh : m_meshes)
         {
-            boneTransforms[i] = glm::identity<glm::mat4>();
+            std::shared_ptr<const CpuSkinning::Source> pSource = pMesh->GetSkinningSource();
+            if (!pSource)
+            {
+                std::cout << "Object::SetCpuSkinningEnabled() : mesh without bone weights, skinning stays in shader" << std::endl;
+                m_skinnedMeshes.clear();
+                return;
+            }
+            m_skinnedMeshes.push_back(std::shared_ptr<SkinnedMesh>(new SkinnedMesh(pMesh, pSource)));
         }
+    }
+    else
+    {
+        for (std::shared_ptr<SkinnedMesh>& pSkinnedMesh : m_skinnedMeshes)
+        {
+            pSkinnedMesh->Free();
+        }
+        m_skinnedMeshes.clear();
+    }
 
-        program.SendUniform(JointTransformsUniformName, BoneCount, GL_FALSE, boneTransforms[0]);
+    if (m_pAnimator)
+    {
+        m_pAnimator->SetPaletteRequired(IsCpuSkinningEnabled());
     }
-}
\ No newline at end of file
+}
+
+bool Object::IsCpuSkinningEnabled()
+{
+    return !m_skinnedMeshes.empty();
+}
+
+int Object::GetSkinnedMeshCount()
+{
+    return static_cast<int>(m_skinnedMeshes.size());
+}
+
+SkinnedMesh& Object::GetSkinnedMesh(int index)
+{
+    return *m_skinnedMeshes[index];
+}
+
+const glm::mat4* Object::GetSkinningPalette()
+{
+    if (!m_pSkeleton || !m_pAnimator || m_pAnimator->GetPaletteSize() != m_pSkeleton->GetBoneCount())
+        return nullptr;
+    return m_pAnimator->GetPalette();
+}
+
+int64_t Object::GetSkinningPaletteVersion()
+{
+    return GetSkinningPalette() ? static_cast<int64_t>(m_pAnimator->GetPaletteVersion()) : BindPosePaletteVersion;
+}
+
+void Object::ApplyMesh(int index)
+{
+    if (IsCpuSkinningEnabled())
+    {
+        m_skinnedMeshes[index]->Apply();
+    }
+    else
+    {
+        m_meshes[index]->Apply();
+    }
+}
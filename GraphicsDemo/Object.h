@@ -12,6 +12,7 @@
 #include "Animator.h"
 
 class Mesh;
+class SkinnedMesh;
 class Material;
 class ShaderProgram;
 struct RecordHeader;
@@ -19,6 +20,10 @@ struct RecordHeader;
 class Object
 {
 public:
+    // Uniform buffer binding point palette of the object being drawn is bound to.
+    // Shaders get it as JOINT_PALETTE_BINDING.
+    enum { JOINT_PALETTE_BINDING = 0 };
+
     Object();
 
     void SetPosition(const glm::vec3& pos);
@@ -39,7 +44,7 @@ public:
     // Must be called every frame.
     // Updates animator.
     //
-    void Update();
+    void Update(float dt);
 
     // Gets the model to world transform matrix
     const glm::mat4x4& GetTransformMatrix();
@@ -65,12 +70,15 @@ public:
     // Free object items
     void Free();
 
-    // Gets skeleton associated with this object.
-    std::shared_ptr<Skeleton> GetSkeleton();
+    // Gets skeleton associated with this object. Skeleton may be shared with other objects.
+    std::shared_ptr<const Skeleton> GetSkeleton();
 
     // Sets skeleton. the last set skeleton will be released.
-    void SetSkeleton(std::shared_ptr<Skeleton> pSkeleton);    
+    void SetSkeleton(std::shared_ptr<const Skeleton> pSkeleton);    
     
+    // Gets animator playing animation of this object.
+    std::shared_ptr<Animator> GetAnimator();
+
     // Sets animator. the last set animator will be released.
     void SetAnimator(std::shared_ptr<Animator> pAnimator);
 
@@ -83,9 +91,30 @@ public:
     // Duplicate object
     void CopyTo(Object& dest);
 
-    // Sends animation data to shader program
+    // Sends animation data to shader program. Palette is uploaded to a uniform buffer only when animator changed it,
+    // so passes drawing the object after the first in a frame only bind the buffer.
     void SendAnimationData(ShaderProgram& program);
 
+    // Skins meshes on CPU into per object buffers instead of in shader. Every pass drawing the object then reuses
+    // the skinned vertices. Enabling reads mesh data back from GPU, so it must be called on the thread that owns GL context.
+    void SetCpuSkinningEnabled(bool enabled);
+
+    bool IsCpuSkinningEnabled();
+
+    // Gets number of meshes skinned on CPU. 0 if CPU skinning is disabled.
+    int GetSkinnedMeshCount();
+
+    SkinnedMesh& GetSkinnedMesh(int index);
+
+    // Gets palette CPU skinning uses. nullptr if animator has no palette for the skeleton yet.
+    const glm::mat4* GetSkinningPalette();
+
+    // Gets version of GetSkinningPalette(), which changes whenever the palette does. Negative for bind pose.
+    int64_t GetSkinningPaletteVersion();
+
+    // Binds vertex attributes of 'index'th mesh for drawing. Skinned vertices if CPU skinning is enabled.
+    void ApplyMesh(int index);
+
 private:
     glm::vec3 m_position;
     glm::vec3 m_scale;
@@ -95,13 +124,25 @@ private:
 
     std::vector<std::shared_ptr<Mesh>> m_meshes;
     std::vector<std::shared_ptr<Material>> m_materials;
-    std::shared_ptr<Skeleton> m_pSkeleton;
+    std::shared_ptr<const Skeleton> m_pSkeleton;
     std::shared_ptr<Animator> m_pAnimator;
+    // Uniform buffer holding top three rows of every palette matrix( 3x4, row-major ). 0 until the first upload.
+    GLuint m_paletteBuffer;
+    // Animator palette version m_paletteBuffer holds. Negative for bind pose or nothing uploaded.
+    int64_t m_uploadedPaletteVersion;
+    // Staging for m_paletteBuffer; kept to reuse its storage.
+    std::vector<glm::vec4> m_paletteRows;
+
+    // Parallel to m_meshes while CPU skinning is enabled. Empty otherwise.
+    std::vector<std::shared_ptr<SkinnedMesh>> m_skinnedMeshes;
 
     //
     // Updates Model-World Transform Matrix when position, scale, rotation has been changed.
     //
     void UpdateTransformMatrix();
+
+    // Uploads palette to m_paletteBuffer if it changed since the last upload.
+    void UploadPalette();
 };
 
 #endif
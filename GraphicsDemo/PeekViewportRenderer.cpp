@@ -50,13 +50,11 @@ void PeekViewportRenderer::RenderObject(PerspectiveCamera& camera, ShaderProgram
     for (int i = 0; i < object.GetMeshCount(); ++i)
     {
         std::shared_ptr<Mesh> pMesh = object.GetMesh(i);
-        pMesh->Apply();
+        object.ApplyMesh(i);
 
         for (int j = 0; j < pMesh->GetSubMeshCount(); ++j)
         {
-            Mesh::SubMesh subMesh = pMesh->GetSubMesh(j);
-            glDrawArrays(GL_TRIANGLES, subMesh.begin, subMesh.vertCount);
-            GET_AND_HANDLE_GL_ERROR();
+            pMesh->DrawSubMesh(j);
         }
     }
 }
@@ -0,0 +1,81 @@
+/*
+    Pose.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    Pose class implementation.
+*/
+#include "Common.h"
+#include "Pose.h"
+#include "Serialization.h"
+
+Pose::Pose()
+{
+}
+
+Pose::Pose(int boneCount)
+{
+    Resize(boneCount);
+}
+
+void Pose::Resize(int boneCount)
+{
+    m_translations.resize(boneCount, glm::vec3(0.0f));
+    m_rotations.resize(boneCount, glm::identity<glm::quat>());
+}
+
+int Pose::GetBoneCount() const
+{
+    return static_cast<int>(m_translations.size());
+}
+
+glm::vec3* Pose::GetTranslations()
+{
+    return m_translations.data();
+}
+
+const glm::vec3* Pose::GetTranslations() const
+{
+    return m_translations.data();
+}
+
+glm::quat* Pose::GetRotations()
+{
+    return m_rotations.data();
+}
+
+const glm::quat* Pose::GetRotations() const
+{
+    return m_rotations.data();
+}
+
+void Pose::SetBoneTransform(int boneIndex, const BoneTransform& transform)
+{
+    m_translations[boneIndex] = transform.position;
+    m_rotations[boneIndex] = transform.rotation;
+}
+
+BoneTransform Pose::GetBoneTransform(int boneIndex) const
+{
+    BoneTransform transform;
+    transform.position = m_translations[boneIndex];
+    transform.rotation = m_rotations[boneIndex];
+    return transform;
+}
+
+void Pose::Serialize(std::ostream& os) const
+{
+    int boneCount = GetBoneCount();
+    Serialization::Write(os, boneCount);
+    os.write(reinterpret_cast<const char*>(m_translations.data()), boneCount * sizeof(glm::vec3));
+    os.write(reinterpret_cast<const char*>(m_rotations.data()), boneCount * sizeof(glm::quat));
+}
+
+void Pose::Deserialize(std::istream& is)
+{
+    int boneCount;
+    Serialization::Read(is, boneCount);
+    Resize(boneCount);
+    is.read(reinterpret_cast<char*>(m_translations.data()), boneCount * sizeof(glm::vec3));
+    is.read(reinterpret_cast<char*>(m_rotations.data()), boneCount * sizeof(glm::quat));
+}
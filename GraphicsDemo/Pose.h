@@ -0,0 +1,82 @@
+/*
+    Pose.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    Dependencies :
+        glm - vector, quaternion, matrix representation
+
+    BoneTransform struct definition.
+    Pose class definition.
+*/
+#ifndef POSE_H_
+#define POSE_H_
+
+struct BoneTransform
+{
+    glm::mat4 GetTransformMatrix()
+    {
+        glm::mat4 r = glm::toMat4(rotation);
+        glm::mat4 t = glm::translate(glm::identity<glm::mat4>(), position);
+        return t * r;
+    }
+
+    static BoneTransform Interpolate(BoneTransform& a, BoneTransform& b, float t)
+    {
+        BoneTransform transform;
+        transform.position = glm::lerp(a.position, b.position, t);
+        transform.rotation = glm::slerp(a.rotation, b.rotation, t);
+        return transform;
+    }
+
+    glm::vec3 position;
+    glm::quat rotation;
+};
+
+//
+// class Pose
+//
+// Local transform of every bone of a Skeleton at a single instant.
+// Each channel is stored in its own contiguous array indexed by Skeleton bone index,
+// so a pose is read front to back without looking bones up by name.
+//
+// usage:
+//  Pose pose(pSkeleton->GetBoneCount());
+//  pose.SetBoneTransform(pSkeleton->FindBoneIndex("Hips"), transform);
+//
+class Pose
+{
+public:
+    Pose();
+
+    explicit Pose(int boneCount);
+
+    // Resizes channels to 'boneCount'. New bones are initialized to identity transform.
+    void Resize(int boneCount);
+
+    int GetBoneCount() const;
+
+    glm::vec3* GetTranslations();
+
+    const glm::vec3* GetTranslations() const;
+
+    glm::quat* GetRotations();
+
+    const glm::quat* GetRotations() const;
+
+    void SetBoneTransform(int boneIndex, const BoneTransform& transform);
+
+    BoneTransform GetBoneTransform(int boneIndex) const;
+
+    void Serialize(std::ostream& os) const;
+
+    void Deserialize(std::istream& is);
+
+private:
+    // Local translation per bone
+    std::vector<glm::vec3> m_translations;
+    // Local rotation per bone
+    std::vector<glm::quat> m_rotations;
+};
+
+#endif
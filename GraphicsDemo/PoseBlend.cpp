@@ -0,0 +1,504 @@
+/*
+    PoseBlend.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    PoseBlend class implementation.
+*/
+#include "Common.h"
+#include "PoseBlend.h"
+
+namespace
+{
+    // Same result as BoneTransform::GetTransformMatrix() without multiplying by translation matrix.
+    inline void ComposeMatrix(const glm::vec3& translation, const glm::quat& rotation, glm::mat4& out)
+    {
+        out = glm::toMat4(rotation);
+        out[3] = glm::vec4(translation, 1.0f);
+    }
+
+    inline glm::quat Nlerp(const glm::quat& a, const glm::quat& b, float t)
+    {
+        // Take shorter path
+        const float Sign = glm::dot(a, b) < 0.0f ? -1.0f : 1.0f;
+        return glm::normalize(a * (1.0f - t) + b * (Sign * t));
+    }
+
+#ifdef GD_USE_SSE
+    // Glm stores quaternion as x, y, z, w. SSE path loads 4 of them as rows of 4x4 matrix.
+    static_assert(sizeof(glm::quat) == sizeof(float) * 4, "glm::quat is expected to be 4 packed floats");
+    static_assert(sizeof(glm::vec3) == sizeof(float) * 3, "glm::vec3 is expected to be 3 packed floats");
+    static_assert(sizeof(glm::mat4) == sizeof(float) * 16, "glm::mat4 is expected to be 16 packed floats");
+
+    // Computes slerp weight of 'a' and 'b' per lane, from cosine of angle between two quaternions.
+    // acos and sin are evaluated per lane; falls back to lerp weights when quaternions are nearly equal, same as glm::slerp.
+    inline void CalcSlerpWeights(__m128 cosTheta, float t, __m128& weightA, __m128& weightB)
+    {
+        alignas(16) float cosThetas[4];
+        alignas(16) float weightsA[4];
+        alignas(16) float weightsB[4];
+        _mm_store_ps(cosThetas, cosTheta);
+        for (int i = 0; i < 4; ++i)
+        {
+            if (cosThetas[i] > 1.0f - glm::epsilon<float>())
+            {
+                weightsA[i] = 1.0f - t;
+                weightsB[i] = t;
+            }
+            else
+            {
+                const float Angle = std::acos(cosThetas[i]);
+                const float InvSin = 1.0f / std::sin(Angle);
+                weightsA[i] = std::sin((1.0f - t) * Angle) * InvSin;
+                weightsB[i] = std::sin(t * Angle) * InvSin;
+            }
+        }
+        weightA = _mm_load_ps(weightsA);
+        weightB = _mm_load_ps(weightsB);
+    }
+
+    // Loads rotations of 4 bones transposed, so that q[0..3] hold x, y, z, w of the 4 bones.
+    inline void LoadRotations4(const glm::quat* pRotations, const int* pBones, __m128* q)
+    {
+        q[0] = _mm_loadu_ps(&pRotations[pBones[0]].x);
+        q[1] = _mm_loadu_ps(&pRotations[pBones[1]].x);
+        q[2] = _mm_loadu_ps(&pRotations[pBones[2]].x);
+        q[3] = _mm_loadu_ps(&pRotations[pBones[3]].x);
+        _MM_TRANSPOSE4_PS(q[0], q[1], q[2], q[3]);
+    }
+
+    // Reverse of LoadRotations4() for 4 consecutive bones
+    inline void StoreRotations4(__m128* q, glm::quat* pRotations)
+    {
+        _MM_TRANSPOSE4_PS(q[0], q[1], q[2], q[3]);
+        _mm_storeu_ps(&pRotations[0].x, q[0]);
+        _mm_storeu_ps(&pRotations[1].x, q[1]);
+        _mm_storeu_ps(&pRotations[2].x, q[2]);
+        _mm_storeu_ps(&pRotations[3].x, q[3]);
+    }
+
+    // Returns cosine of angle between 4 pairs of transposed rotations, flipping 'b' where it is negative
+    // so that blending takes shorter path. Returned cosine is that of flipped 'b'.
+    inline __m128 AlignRotations4(const __m128* a, __m128* b)
+    {
+        const __m128 CosTheta = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])),
+            _mm_add_ps(_mm_mul_ps(a[2], b[2]), _mm_mul_ps(a[3], b[3])));
+        const __m128 Sign = _mm_and_ps(CosTheta, _mm_set1_ps(-0.0f));
+        for (int k = 0; k < 4; ++k)
+        {
+            b[k] = _mm_xor_ps(b[k], Sign);
+        }
+        return _mm_xor_ps(CosTheta, Sign);
+    }
+
+    // out = a * weightA + b * weightB per lane, normalized if 'normalize'
+    inline void CombineRotations4(const __m128* a, const __m128* b, __m128 weightA, __m128 weightB, bool normalize, __m128* out)
+    {
+        for (int k = 0; k < 4; ++k)
+        {
+            out[k] = _mm_add_ps(_mm_mul_ps(a[k], weightA), _mm_mul_ps(b[k], weightB));
+        }
+
+        if (normalize)
+        {
+            const __m128 LengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(out[0], out[0]), _mm_mul_ps(out[1], out[1])),
+                _mm_add_ps(_mm_mul_ps(out[2], out[2]), _mm_mul_ps(out[3], out[3])));
+            const __m128 InvLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(LengthSquared));
+            for (int k = 0; k < 4; ++k)
+            {
+                out[k] = _mm_mul_ps(out[k], InvLength);
+            }
+        }
+    }
+
+    // out = p * q per lane, same as glm quaternion product
+    inline void MultiplyRotations4(const __m128* p, const __m128* q, __m128* out)
+    {
+        const __m128 X = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p[3], q[0]), _mm_mul_ps(p[0], q[3])),
+            _mm_sub_ps(_mm_mul_ps(p[1], q[2]), _mm_mul_ps(p[2], q[1])));
+        const __m128 Y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p[3], q[1]), _mm_mul_ps(p[1], q[3])),
+            _mm_sub_ps(_mm_mul_ps(p[2], q[0]), _mm_mul_ps(p[0], q[2])));
+        const __m128 Z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p[3], q[2]), _mm_mul_ps(p[2], q[3])),
+            _mm_sub_ps(_mm_mul_ps(p[0], q[1]), _mm_mul_ps(p[1], q[0])));
+        const __m128 W = _mm_sub_ps(_mm_sub_ps(_mm_mul_ps(p[3], q[3]), _mm_mul_ps(p[0], q[0])),
+            _mm_add_ps(_mm_mul_ps(p[1], q[1]), _mm_mul_ps(p[2], q[2])));
+        out[0] = X;
+        out[1] = Y;
+        out[2] = Z;
+        out[3] = W;
+    }
+
+    // Spreads weight of 4 bones over the 12 floats of their translations: w0 w0 w0 w1 | w1 w1 w2 w2 | w2 w3 w3 w3
+    inline void SpreadWeights4(__m128 weight, __m128* out)
+    {
+        out[0] = _mm_shuffle_ps(weight, weight, _MM_SHUFFLE(1, 0, 0, 0));
+        out[1] = _mm_shuffle_ps(weight, weight, _MM_SHUFFLE(2, 2, 1, 1));
+        out[2] = _mm_shuffle_ps(weight, weight, _MM_SHUFFLE(3, 3, 3, 2));
+    }
+
+    // Writes local transform matrix of 4 bones from transposed rotations 'q' and 12 packed translation floats.
+    inline void StoreMatrices4(const __m128* q, const float* pTranslations, const int* pBones, glm::mat4* pOut)
+    {
+        const __m128 One = _mm_set1_ps(1.0f);
+        const __m128 Zero = _mm_setzero_ps();
+
+        // Rotation matrix of 4 bones, same formula as glm::mat3_cast
+        const __m128 X2 = _mm_add_ps(q[0], q[0]);
+        const __m128 Y2 = _mm_add_ps(q[1], q[1]);
+        const __m128 Z2 = _mm_add_ps(q[2], q[2]);
+        const __m128 XX = _mm_mul_ps(q[0], X2);
+        const __m128 YY = _mm_mul_ps(q[1], Y2);
+        const __m128 ZZ = _mm_mul_ps(q[2], Z2);
+        const __m128 XY = _mm_mul_ps(q[0], Y2);
+        const __m128 XZ = _mm_mul_ps(q[0], Z2);
+        const __m128 YZ = _mm_mul_ps(q[1], Z2);
+        const __m128 WX = _mm_mul_ps(q[3], X2);
+        const __m128 WY = _mm_mul_ps(q[3], Y2);
+        const __m128 WZ = _mm_mul_ps(q[3], Z2);
+
+        __m128 column0[4] = {
+            _mm_sub_ps(One, _mm_add_ps(YY, ZZ)),
+            _mm_add_ps(XY, WZ),
+            _mm_sub_ps(XZ, WY),
+            Zero
+        };
+        __m128 column1[4] = {
+            _mm_sub_ps(XY, WZ),
+            _mm_sub_ps(One, _mm_add_ps(XX, ZZ)),
+            _mm_add_ps(YZ, WX),
+            Zero
+        };
+        __m128 column2[4] = {
+            _mm_add_ps(XZ, WY),
+            _mm_sub_ps(YZ, WX),
+            _mm_sub_ps(One, _mm_add_ps(XX, YY)),
+            Zero
+        };
+
+        // Back to one register per bone
+        _MM_TRANSPOSE4_PS(column0[0], column0[1], column0[2], column0[3]);
+        _MM_TRANSPOSE4_PS(column1[0], column1[1], column1[2], column1[3]);
+        _MM_TRANSPOSE4_PS(column2[0], column2[1], column2[2], column2[3]);
+
+        for (int k = 0; k < 4; ++k)
+        {
+            float* pMatrix = glm::value_ptr(pOut[pBones[k]]);
+            _mm_storeu_ps(pMatrix, column0[k]);
+            _mm_storeu_ps(pMatrix + 4, column1[k]);
+            _mm_storeu_ps(pMatrix + 8, column2[k]);
+            _mm_storeu_ps(pMatrix + 12, _mm_setr_ps(pTranslations[k * 3], pTranslations[k * 3 + 1], pTranslations[k * 3 + 2], 1.0f));
+        }
+    }
+#endif
+}
+
+void PoseBlend::InterpolateToMatrices(const Pose& a, const Pose& b, float t, RotationMode mode, glm::mat4* pOut)
+{
+    assert(b.GetBoneCount() == a.GetBoneCount());
+    Interpolate(a, b, t, mode, nullptr, a.GetBoneCount(), pOut);
+}
+
+void PoseBlend::InterpolateToMatricesScalar(const Pose& a, const Pose& b, float t, RotationMode mode, glm::mat4* pOut)
+{
+    assert(b.GetBoneCount() == a.GetBoneCount());
+    InterpolateRangeScalar(a, b, t, mode, nullptr, 0, a.GetBoneCount(), pOut);
+}
+
+void PoseBlend::InterpolateSelectedToMatrices(const Pose& a, const Pose& b, float t, RotationMode mode,
+    const int* pBoneIndices, int count, glm::mat4* pOut)
+{
+    assert(b.GetBoneCount() == a.GetBoneCount());
+    Interpolate(a, b, t, mode, pBoneIndices, count, pOut);
+}
+
+bool PoseBlend::IsSimdEnabled()
+{
+#ifdef GD_USE_SSE
+    return true;
+#else
+    return false;
+#endif
+}
+
+void PoseBlend::Blend(const Pose& a, const Pose& b, float t, RotationMode mode, Pose& out)
+{
+    assert(b.GetBoneCount() == a.GetBoneCount() && out.GetBoneCount() == a.GetBoneCount());
+    const int BoneCount = a.GetBoneCount();
+    const glm::vec3* pTranslationsA = a.GetTranslations();
+    const glm::vec3* pTranslationsB = b.GetTranslations();
+    const glm::quat* pRotationsA = a.GetRotations();
+    const glm::quat* pRotationsB = b.GetRotations();
+    glm::vec3* pTranslationsOut = out.GetTranslations();
+    glm::quat* pRotationsOut = out.GetRotations();
+
+    int i = 0;
+#ifdef GD_USE_SSE
+    const __m128 T = _mm_set1_ps(t);
+    const __m128 OneMinusT = _mm_set1_ps(1.0f - t);
+    // Every block is loaded before it is stored, so 'out' may be 'a' or 'b'.
+    for (; i + 4 <= BoneCount; i += 4)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            const __m128 Ta = _mm_loadu_ps(&pTranslationsA[i].x + k * 4);
+            const __m128 Tb = _mm_loadu_ps(&pTranslationsB[i].x + k * 4);
+            _mm_storeu_ps(&pTranslationsOut[i].x + k * 4, _mm_add_ps(Ta, _mm_mul_ps(_mm_sub_ps(Tb, Ta), T)));
+        }
+
+        const int Bones[4] = { i, i + 1, i + 2, i + 3 };
+        __m128 rotationsA[4];
+        __m128 rotationsB[4];
+        LoadRotations4(pRotationsA, Bones, rotationsA);
+        LoadRotations4(pRotationsB, Bones, rotationsB);
+        const __m128 CosTheta = AlignRotations4(rotationsA, rotationsB);
+
+        __m128 weightA = OneMinusT;
+        __m128 weightB = T;
+        if (mode == RM_SLERP)
+        {
+            CalcSlerpWeights(CosTheta, t, weightA, weightB);
+        }
+
+        __m128 rotations[4];
+        CombineRotations4(rotationsA, rotationsB, weightA, weightB, mode == RM_NLERP, rotations);
+        StoreRotations4(rotations, pRotationsOut + i);
+    }
+#endif
+
+    for (; i < BoneCount; ++i)
+    {
+        pTranslationsOut[i] = glm::lerp(pTranslationsA[i], pTranslationsB[i], t);
+        pRotationsOut[i] = mode == RM_SLERP
+            ? glm::slerp(pRotationsA[i], pRotationsB[i], t)
+            : Nlerp(pRotationsA[i], pRotationsB[i], t);
+    }
+}
+
+void PoseBlend::BlendMasked(const Pose& a, const Pose& b, const float* pBoneWeights, float weight, Pose& out)
+{
+    assert(b.GetBoneCount() == a.GetBoneCount() && out.GetBoneCount() == a.GetBoneCount());
+    const int BoneCount = a.GetBoneCount();
+    const glm::vec3* pTranslationsA = a.GetTranslations();
+    const glm::vec3* pTranslationsB = b.GetTranslations();
+    const glm::quat* pRotationsA = a.GetRotations();
+    const glm::quat* pRotationsB = b.GetRotations();
+    glm::vec3* pTranslationsOut = out.GetTranslations();
+    glm::quat* pRotationsOut = out.GetRotations();
+
+    int i = 0;
+#ifdef GD_USE_SSE
+    const __m128 Weight = _mm_set1_ps(weight);
+    const __m128 One = _mm_set1_ps(1.0f);
+    for (; i + 4 <= BoneCount; i += 4)
+    {
+        const __m128 T = _mm_mul_ps(_mm_loadu_ps(pBoneWeights + i), Weight);
+
+        __m128 translationWeights[3];
+        SpreadWeights4(T, translationWeights);
+        for (int k = 0; k < 3; ++k)
+        {
+            const __m128 Ta = _mm_loadu_ps(&pTranslationsA[i].x + k * 4);
+            const __m128 Tb = _mm_loadu_ps(&pTranslationsB[i].x + k * 4);
+            _mm_storeu_ps(&pTranslationsOut[i].x + k * 4, _mm_add_ps(Ta, _mm_mul_ps(_mm_sub_ps(Tb, Ta), translationWeights[k])));
+        }
+
+        const int Bones[4] = { i, i + 1, i + 2, i + 3 };
+        __m128 rotationsA[4];
+        __m128 rotationsB[4];
+        LoadRotations4(pRotationsA, Bones, rotationsA);
+        LoadRotations4(pRotationsB, Bones, rotationsB);
+        AlignRotations4(rotationsA, rotationsB);
+
+        __m128 rotations[4];
+        CombineRotations4(rotationsA, rotationsB, _mm_sub_ps(One, T), T, true, rotations);
+        StoreRotations4(rotations, pRotationsOut + i);
+    }
+#endif
+
+    for (; i < BoneCount; ++i)
+    {
+        const float T = pBoneWeights[i] * weight;
+        pTranslationsOut[i] = glm::lerp(pTranslationsA[i], pTranslationsB[i], T);
+        pRotationsOut[i] = Nlerp(pRotationsA[i], pRotationsB[i], T);
+    }
+}
+
+void PoseBlend::BlendAdditive(const Pose& base, const Pose& additive, const Pose& reference, float weight, Pose& out)
+{
+    assert(additive.GetBoneCount() == base.GetBoneCount() && reference.GetBoneCount() == base.GetBoneCount());
+    assert(out.GetBoneCount() == base.GetBoneCount());
+    const int BoneCount = base.GetBoneCount();
+    const glm::vec3* pTranslationsBase = base.GetTranslations();
+    const glm::vec3* pTranslationsAdditive = additive.GetTranslations();
+    const glm::vec3* pTranslationsReference = reference.GetTranslations();
+    const glm::quat* pRotationsBase = base.GetRotations();
+    const glm::quat* pRotationsAdditive = additive.GetRotations();
+    const glm::quat* pRotationsReference = reference.GetRotations();
+    glm::vec3* pTranslationsOut = out.GetTranslations();
+    glm::quat* pRotationsOut = out.GetRotations();
+
+    int i = 0;
+#ifdef GD_USE_SSE
+    const __m128 Weight = _mm_set1_ps(weight);
+    const __m128 OneMinusWeight = _mm_set1_ps(1.0f - weight);
+    const __m128 SignMask = _mm_set1_ps(-0.0f);
+    const __m128 IdentityRotations[4] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_set1_ps(1.0f) };
+    for (; i + 4 <= BoneCount; i += 4)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            const __m128 Base = _mm_loadu_ps(&pTranslationsBase[i].x + k * 4);
+            const __m128 Additive = _mm_loadu_ps(&pTranslationsAdditive[i].x + k * 4);
+            const __m128 Reference = _mm_loadu_ps(&pTranslationsReference[i].x + k * 4);
+            _mm_storeu_ps(&pTranslationsOut[i].x + k * 4, _mm_add_ps(Base, _mm_mul_ps(_mm_sub_ps(Additive, Reference), Weight)));
+        }
+
+        const int Bones[4] = { i, i + 1, i + 2, i + 3 };
+        __m128 base[4];
+        __m128 additive[4];
+        __m128 reference[4];
+        LoadRotations4(pRotationsBase, Bones, base);
+        LoadRotations4(pRotationsAdditive, Bones, additive);
+        LoadRotations4(pRotationsReference, Bones, reference);
+
+        // Conjugate of reference is its inverse
+        for (int k = 0; k < 3; ++k)
+        {
+            reference[k] = _mm_xor_ps(reference[k], SignMask);
+        }
+        __m128 delta[4];
+        MultiplyRotations4(reference, additive, delta);
+        AlignRotations4(IdentityRotations, delta);
+
+        __m128 weighted[4];
+        CombineRotations4(IdentityRotations, delta, OneMinusWeight, Weight, true, weighted);
+        __m128 rotations[4];
+        MultiplyRotations4(base, weighted, rotations);
+        StoreRotations4(rotations, pRotationsOut + i);
+    }
+#endif
+
+    const glm::quat Identity = glm::identity<glm::quat>();
+    for (; i < BoneCount; ++i)
+    {
+        pTranslationsOut[i] = pTranslationsBase[i] + (pTranslationsAdditive[i] - pTranslationsReference[i]) * weight;
+        const glm::quat Delta = glm::conjugate(pRotationsReference[i]) * pRotationsAdditive[i];
+        pRotationsOut[i] = pRotationsBase[i] * Nlerp(Identity, Delta, weight);
+    }
+}
+
+void PoseBlend::ToMatrices(const Pose& pose, glm::mat4* pOut)
+{
+    const int BoneCount = pose.GetBoneCount();
+    const glm::vec3* pTranslations = pose.GetTranslations();
+    const glm::quat* pRotations = pose.GetRotations();
+
+    int i = 0;
+#ifdef GD_USE_SSE
+    for (; i + 4 <= BoneCount; i += 4)
+    {
+        const int Bones[4] = { i, i + 1, i + 2, i + 3 };
+        __m128 rotations[4];
+        LoadRotations4(pRotations, Bones, rotations);
+        StoreMatrices4(rotations, &pTranslations[i].x, Bones, pOut);
+    }
+#endif
+
+    for (; i < BoneCount; ++i)
+    {
+        ComposeMatrix(pTranslations[i], pRotations[i], pOut[i]);
+    }
+}
+
+void PoseBlend::Interpolate(const Pose& a, const Pose& b, float t, RotationMode mode, const int* pBoneIndices, int count, glm::mat4* pOut)
+{
+#ifdef GD_USE_SSE
+
+    const glm::vec3* pTranslationsA = a.GetTranslations();
+    const glm::vec3* pTranslationsB = b.GetTranslations();
+    const glm::quat* pRotationsA = a.GetRotations();
+    const glm::quat* pRotationsB = b.GetRotations();
+
+    const __m128 T = _mm_set1_ps(t);
+    const __m128 One = _mm_set1_ps(1.0f);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        int bones[4];
+        for (int k = 0; k < 4; ++k)
+        {
+            bones[k] = pBoneIndices ? pBoneIndices[i + k] : i + k;
+        }
+
+        // Translation of 4 bones are 12 floats. Lerp is done component-wise, so x, y, z don't need to be separated.
+        alignas(16) float translations[12];
+        if (pBoneIndices == nullptr)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const __m128 Ta = _mm_loadu_ps(&pTranslationsA[i].x + k * 4);
+                const __m128 Tb = _mm_loadu_ps(&pTranslationsB[i].x + k * 4);
+                _mm_store_ps(translations + k * 4, _mm_add_ps(Ta, _mm_mul_ps(_mm_sub_ps(Tb, Ta), T)));
+            }
+        }
+        else
+        {
+            // Selected bones aren't contiguous
+            for (int k = 0; k < 4; ++k)
+            {
+                const glm::vec3 Translation = glm::lerp(pTranslationsA[bones[k]], pTranslationsB[bones[k]], t);
+                translations[k * 3] = Translation.x;
+                translations[k * 3 + 1] = Translation.y;
+                translations[k * 3 + 2] = Translation.z;
+            }
+        }
+
+        // Each register holds one component of 4 bones.
+        __m128 rotationsA[4];
+        __m128 rotationsB[4];
+        LoadRotations4(pRotationsA, bones, rotationsA);
+        LoadRotations4(pRotationsB, bones, rotationsB);
+        const __m128 CosTheta = AlignRotations4(rotationsA, rotationsB);
+
+        __m128 weightA;
+        __m128 weightB;
+        if (mode == RM_SLERP)
+        {
+            CalcSlerpWeights(CosTheta, t, weightA, weightB);
+        }
+        else
+        {
+            weightA = _mm_sub_ps(One, T);
+            weightB = T;
+        }
+
+        __m128 rotations[4];
+        CombineRotations4(rotationsA, rotationsB, weightA, weightB, mode == RM_NLERP, rotations);
+        StoreMatrices4(rotations, translations, bones, pOut);
+    }
+
+    InterpolateRangeScalar(a, b, t, mode, pBoneIndices, i, count, pOut);
+#else
+    InterpolateRangeScalar(a, b, t, mode, pBoneIndices, 0, count, pOut);
+#endif
+}
+
+void PoseBlend::InterpolateRangeScalar(const Pose& a, const Pose& b, float t, RotationMode mode,
+    const int* pBoneIndices, int begin, int end, glm::mat4* pOut)
+{
+    const glm::vec3* pTranslationsA = a.GetTranslations();
+    const glm::vec3* pTranslationsB = b.GetTranslations();
+    const glm::quat* pRotationsA = a.GetRotations();
+    const glm::quat* pRotationsB = b.GetRotations();
+
+    for (int i = begin; i < end; ++i)
+    {
+        const int Bone = pBoneIndices ? pBoneIndices[i] : i;
+        const glm::vec3 Translation = glm::lerp(pTranslationsA[Bone], pTranslationsB[Bone], t);
+        const glm::quat Rotation = mode == RM_SLERP
+            ? glm::slerp(pRotationsA[Bone], pRotationsB[Bone], t)
+            : Nlerp(pRotationsA[Bone], pRotationsB[Bone], t);
+        ComposeMatrix(Translation, Rotation, pOut[Bone]);
+    }
+}
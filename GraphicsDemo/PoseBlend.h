@@ -0,0 +1,81 @@
+/*
+    PoseBlend.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    References :
+        https://software.intel.com/sites/landingpage/IntrinsicsGuide/
+
+    Dependencies :
+        glm - vector, quaternion, matrix representation
+        SSE2 - (optional) 4-wide path. Enabled when Common.h defines GD_USE_SSE.
+
+    PoseBlend class definition.
+*/
+#ifndef POSE_BLEND_H_
+#define POSE_BLEND_H_
+
+#include "Pose.h"
+
+//
+// class PoseBlend
+//
+// Batch kernels that work on whole 'Pose's instead of single bones.
+// Interpolate* kernels go straight from two KeyFrame poses to matrices; Blend* kernels go from poses to pose,
+// so that results of several blends can be layered before ToMatrices().
+// The SSE path processes 4 bones per iteration; remaining bones and non-SSE targets go through the scalar path.
+//
+// usage:
+//  std::vector<glm::mat4> localTransforms(pose.GetBoneCount());
+//  PoseBlend::InterpolateToMatrices(prev, next, t, PoseBlend::RM_NLERP, localTransforms.data());
+//
+class PoseBlend
+{
+public:
+    enum RotationMode
+    {
+        // Spherical linear interpolation. Constant angular velocity, matches glm::slerp.
+        RM_SLERP,
+        // Normalized linear interpolation. Cheaper, angular velocity is slightly uneven for large angles.
+        RM_NLERP,
+    };
+
+    // Interpolates every bone of 'a' and 'b' by 't' and writes bone local transform matrix( Translation * Rotation )
+    // to 'pOut'. 'pOut' must have room for a.GetBoneCount() matrices.
+    static void InterpolateToMatrices(const Pose& a, const Pose& b, float t, RotationMode mode, glm::mat4* pOut);
+
+    // Same as 'InterpolateToMatrices' but never takes the SSE path.
+    static void InterpolateToMatricesScalar(const Pose& a, const Pose& b, float t, RotationMode mode, glm::mat4* pOut);
+
+    // Same as 'InterpolateToMatrices' but only for 'count' bones listed in 'pBoneIndices'.
+    // Matrix of bone i is written to pOut[i]; matrices of bones not listed are left untouched.
+    static void InterpolateSelectedToMatrices(const Pose& a, const Pose& b, float t, RotationMode mode,
+        const int* pBoneIndices, int count, glm::mat4* pOut);
+
+    // Blends every bone of 'a' toward 'b' by 't' into 'out'. 'out' may be 'a' or 'b'.
+    static void Blend(const Pose& a, const Pose& b, float t, RotationMode mode, Pose& out);
+
+    // Blends bone i of 'a' toward 'b' by 'weight' * pBoneWeights[i] into 'out'. 'out' may be 'a' or 'b'.
+    // Rotations are always nlerped, since weight differs per bone.
+    static void BlendMasked(const Pose& a, const Pose& b, const float* pBoneWeights, float weight, Pose& out);
+
+    // Applies difference of 'additive' from 'reference', scaled by 'weight', on top of 'base' into 'out'.
+    // Rotation difference is applied in bone space: out = base * nlerp(identity, inverse(reference) * additive, weight).
+    static void BlendAdditive(const Pose& base, const Pose& additive, const Pose& reference, float weight, Pose& out);
+
+    // Writes bone local transform matrix( Translation * Rotation ) of every bone of 'pose' to 'pOut'.
+    static void ToMatrices(const Pose& pose, glm::mat4* pOut);
+
+    // Returns true if 'InterpolateToMatrices' runs the SSE path on this build.
+    static bool IsSimdEnabled();
+
+private:
+    // Batch kernel shared by 'InterpolateToMatrices' and 'InterpolateSelectedToMatrices'.
+    // 'pBoneIndices' may be nullptr, in which case bones [0, count) are interpolated.
+    static void Interpolate(const Pose& a, const Pose& b, float t, RotationMode mode, const int* pBoneIndices, int count, glm::mat4* pOut);
+
+    static void InterpolateRangeScalar(const Pose& a, const Pose& b, float t, RotationMode mode,
+        const int* pBoneIndices, int begin, int end, glm::mat4* pOut);
+};
+
+#endif
@@ -0,0 +1,154 @@
+/*
+    PoseCache.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    PoseCache class implementation.
+*/
+#include "Common.h"
+#include "PoseCache.h"
+
+namespace
+{
+    // Twice the rate FBX animations are sampled at.
+    const float DefaultTimeStep = 1.0f / 60.0f;
+
+    inline void HashCombine(size_t& seed, size_t value)
+    {
+        seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+}
+
+bool PoseCache::Key::operator==(const Key& rhs) const
+{
+    return pAnimation == rhs.pAnimation
+        && pSkeleton == rhs.pSkeleton
+        && rotationMode == rhs.rotationMode
+        && timeIndex == rhs.timeIndex;
+}
+
+size_t PoseCache::KeyHash::operator()(const Key& key) const
+{
+    size_t seed = std::hash<const void*>()(key.pAnimation);
+    HashCombine(seed, std::hash<const void*>()(key.pSkeleton));
+    HashCombine(seed, std::hash<int>()(key.rotationMode));
+    HashCombine(seed, std::hash<int>()(key.timeIndex));
+    return seed;
+}
+
+PoseCache::PoseCache()
+    : m_timeStep(DefaultTimeStep)
+    , m_frame(0)
+    , m_hitCount(0)
+    , m_missCount(0)
+{
+}
+
+void PoseCache::SetTimeStep(float timeStep)
+{
+    assert(timeStep > 0.0f);
+    Clear();
+    m_timeStep = timeStep;
+}
+
+float PoseCache::GetTimeStep() const
+{
+    return m_timeStep;
+}
+
+PoseCache::Key PoseCache::MakeKey(const Animation& animation, const Skeleton& skeleton, PoseBlend::RotationMode rotationMode, float animationTime) const
+{
+    Key key;
+    key.pAnimation = &animation;
+    key.pSkeleton = &skeleton;
+    key.rotationMode = rotationMode;
+    key.timeIndex = static_cast<int>(std::floor(animationTime / m_timeStep));
+    return key;
+}
+
+float PoseCache::GetSampleTime(const Key& key) const
+{
+    return key.timeIndex * m_timeStep;
+}
+
+bool PoseCache::Acquire(const Key& key, int boneCount, glm::mat4* pOut)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    Entry& entry = m_entries[key];
+    entry.lastUsedFrame = m_frame;
+
+    // New entry. Caller computes it.
+    if (entry.palette.empty())
+    {
+        entry.palette.resize(boneCount);
+        ++m_missCount;
+        return false;
+    }
+
+    m_publishCondition.wait(lock, [&entry]() { return entry.ready; });
+    lock.unlock();
+
+    // Palette doesn't change once ready, and entry stays until NextFrame().
+    assert(static_cast<int>(entry.palette.size()) == boneCount);
+    std::memcpy(pOut, entry.palette.data(), sizeof(glm::mat4) * boneCount);
+    ++m_hitCount;
+    return true;
+}
+
+void PoseCache::Publish(const Key& key, const glm::mat4* pPalette, int boneCount)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry& entry = m_entries[key];
+        assert(!entry.ready && static_cast<int>(entry.palette.size()) == boneCount);
+        std::memcpy(entry.palette.data(), pPalette, sizeof(glm::mat4) * boneCount);
+        entry.ready = true;
+    }
+    m_publishCondition.notify_all();
+}
+
+void PoseCache::NextFrame()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        assert(it->second.ready);
+        if (it->second.lastUsedFrame != m_frame)
+        {
+            it = m_entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    ++m_frame;
+}
+
+int PoseCache::GetEntryCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<int>(m_entries.size());
+}
+
+int PoseCache::GetHitCount() const
+{
+    return m_hitCount;
+}
+
+int PoseCache::GetMissCount() const
+{
+    return m_missCount;
+}
+
+void PoseCache::ResetCounters()
+{
+    m_hitCount = 0;
+    m_missCount = 0;
+}
+
+void PoseCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
@@ -0,0 +1,107 @@
+/*
+    PoseCache.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    Dependencies :
+        glm - matrix representation
+
+    PoseCache class definition.
+*/
+#ifndef POSE_CACHE_H_
+#define POSE_CACHE_H_
+
+#include "Singleton.h"
+#include "PoseBlend.h"
+
+class Animation;
+class Skeleton;
+
+//
+// class PoseCache
+//
+// Palettes shared between Animators that play the same Animation on the same Skeleton at the same time.
+// Playback time is quantized to GetTimeStep(), so crowds playing in lockstep or nearly so share one palette.
+// The first Animator asking for a key computes the palette and publishes it; the others copy it.
+// Animators asking while the palette is being computed wait for it, so each palette is computed once.
+//
+// Skeleton is identified by address. Object::CopyTo() shares Skeleton, so copies of one object share palettes.
+// Entries not asked for during a frame are dropped at the next NextFrame().
+//
+// usage:
+//  animator.SetPoseCacheEnabled(true); // opt-in per animator
+//  ...
+//  PoseCache::Instance()->NextFrame(); // once every frame before updating animators. Scene::Update() does this.
+//
+class PoseCache : public Singleton<PoseCache>
+{
+public:
+    struct Key
+    {
+        const Animation* pAnimation;
+        const Skeleton* pSkeleton;
+        PoseBlend::RotationMode rotationMode;
+        // Playback time in time steps
+        int timeIndex;
+
+        bool operator==(const Key& rhs) const;
+    };
+
+    PoseCache();
+
+    // Sets playback time quantization in seconds. Clears cached palettes.
+    void SetTimeStep(float timeStep);
+
+    float GetTimeStep() const;
+
+    Key MakeKey(const Animation& animation, const Skeleton& skeleton, PoseBlend::RotationMode rotationMode, float animationTime) const;
+
+    // Playback time palette of 'key' is sampled at.
+    float GetSampleTime(const Key& key) const;
+
+    // Copies palette of 'key' to 'pOut' and returns true if it is cached. Waits if another thread is computing it.
+    // Otherwise returns false, and the caller must compute the palette and Publish() it.
+    bool Acquire(const Key& key, int boneCount, glm::mat4* pOut);
+
+    // Stores palette computed for 'key' after Acquire() returned false, and wakes threads waiting for it.
+    void Publish(const Key& key, const glm::mat4* pPalette, int boneCount);
+
+    // Drops palettes that were not acquired since the last call. Must not be called while animators update.
+    void NextFrame();
+
+    int GetEntryCount();
+
+    int GetHitCount() const;
+
+    int GetMissCount() const;
+
+    void ResetCounters();
+
+    // Drops every palette.
+    void Clear();
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry
+    {
+        std::vector<glm::mat4> palette;
+        bool ready;
+        unsigned int lastUsedFrame;
+    };
+
+    std::mutex m_mutex;
+    // Acquire() waits on this for palette being computed by another thread
+    std::condition_variable m_publishCondition;
+    // Entries are never removed while animators update, so references to them stay valid during a frame.
+    std::unordered_map<Key, Entry, KeyHash> m_entries;
+    float m_timeStep;
+    unsigned int m_frame;
+    std::atomic<int> m_hitCount;
+    std::atomic<int> m_missCount;
+};
+
+#endif
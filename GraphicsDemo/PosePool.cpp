@@ -0,0 +1,62 @@
+/*
+    PosePool.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    PosePool class implementation.
+*/
+#include "Common.h"
+#include "PosePool.h"
+
+PosePool::PosePool()
+    : m_poses()
+    , m_count(0)
+    , m_boneCount(0)
+{
+}
+
+void PosePool::Reset(int count, int boneCount)
+{
+    assert(count >= 0 && boneCount >= 0);
+    if (static_cast<int>(m_poses.size()) < count)
+    {
+        m_poses.resize(count);
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        if (m_poses[i].GetBoneCount() != boneCount)
+        {
+            m_poses[i].Resize(boneCount);
+        }
+    }
+    m_count = count;
+    m_boneCount = boneCount;
+}
+
+int PosePool::GetCount() const
+{
+    return m_count;
+}
+
+int PosePool::GetBoneCount() const
+{
+    return m_boneCount;
+}
+
+Pose& PosePool::Get(int index)
+{
+    assert(0 <= index && index < m_count);
+    return m_poses[index];
+}
+
+const Pose& PosePool::Get(int index) const
+{
+    assert(0 <= index && index < m_count);
+    return m_poses[index];
+}
+
+void PosePool::Swap(int a, int b)
+{
+    assert(0 <= a && a < m_count && 0 <= b && b < m_count);
+    std::swap(m_poses[a], m_poses[b]);
+}
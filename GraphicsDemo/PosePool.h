@@ -0,0 +1,51 @@
+/*
+    PosePool.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    PosePool class definition.
+*/
+#ifndef POSE_POOL_H_
+#define POSE_POOL_H_
+
+#include "Pose.h"
+
+//
+// class PosePool
+//
+// Fixed number of 'Pose' buffers addressed by index, all sized to the same bone count.
+// Buffers are allocated by Reset() only; using them afterwards never allocates, so blend tree evaluation
+// can run every frame without touching the heap. Moving a result between buffers is a swap, not a copy.
+//
+// usage:
+//  pool.Reset(registerCount, skeleton.GetBoneCount());
+//  ...
+//  PoseBlend::Blend(pool.Get(0), pool.Get(1), t, PoseBlend::RM_NLERP, pool.Get(0));
+//
+class PosePool
+{
+public:
+    PosePool();
+
+    // Makes the pool hold 'count' poses of 'boneCount' bones. Allocates only if the pool has to grow.
+    void Reset(int count, int boneCount);
+
+    int GetCount() const;
+
+    int GetBoneCount() const;
+
+    Pose& Get(int index);
+
+    const Pose& Get(int index) const;
+
+    // Exchanges contents of pose 'a' and 'b' without copying bones.
+    void Swap(int a, int b);
+
+private:
+    // Only the first m_count are in use. Kept beyond that so shrinking and growing again doesn't allocate.
+    std::vector<Pose> m_poses;
+    int m_count;
+    int m_boneCount;
+};
+
+#endif
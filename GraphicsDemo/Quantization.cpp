@@ -0,0 +1,87 @@
+/*
+    Quantization.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    Quantization helper implementation.
+*/
+#include "Common.h"
+#include "Quantization.h"
+
+namespace
+{
+    // Range of the three smallest components of a unit quaternion is [-SmallestThreeRange, SmallestThreeRange]
+    const float SmallestThreeRange = 0.70710678f;
+    const uint16_t ComponentMask = 0x7fff;
+    const float ComponentMaximum = static_cast<float>(ComponentMask);
+    const float RangeMaximum = 65535.0f;
+}
+
+void QuantizeQuaternion(const glm::quat& q, uint16_t out[3])
+{
+    const float Components[4] = { q.x, q.y, q.z, q.w };
+
+    int largest = 0;
+    for (int i = 1; i < 4; ++i)
+    {
+        if (std::abs(Components[i]) > std::abs(Components[largest]))
+            largest = i;
+    }
+
+    // q and -q are the same rotation. Flip so that the dropped component is positive.
+    const float Sign = Components[largest] < 0.0f ? -1.0f : 1.0f;
+    int k = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        if (i == largest)
+            continue;
+        const float Normalized = glm::clamp((Components[i] * Sign / SmallestThreeRange + 1.0f) * 0.5f, 0.0f, 1.0f);
+        out[k++] = static_cast<uint16_t>(Normalized * ComponentMaximum + 0.5f);
+    }
+
+    out[0] |= static_cast<uint16_t>((largest & 1) << 15);
+    out[1] |= static_cast<uint16_t>((largest >> 1) << 15);
+}
+
+glm::quat DequantizeQuaternion(const uint16_t in[3])
+{
+    const int Largest = (in[0] >> 15) | ((in[1] >> 15) << 1);
+
+    float components[4];
+    float sumOfSquares = 0.0f;
+    int k = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        if (i == Largest)
+            continue;
+        const float Normalized = (in[k++] & ComponentMask) / ComponentMaximum;
+        components[i] = (Normalized * 2.0f - 1.0f) * SmallestThreeRange;
+        sumOfSquares += components[i] * components[i];
+    }
+    components[Largest] = std::sqrt(std::max(1.0f - sumOfSquares, 0.0f));
+
+    return glm::quat(components[3], components[0], components[1], components[2]);
+}
+
+uint16_t QuantizeRange(float value, float minimum, float extent)
+{
+    if (extent <= 0.0f)
+        return 0;
+    const float Normalized = glm::clamp((value - minimum) / extent, 0.0f, 1.0f);
+    return static_cast<uint16_t>(Normalized * RangeMaximum + 0.5f);
+}
+
+float DequantizeRange(uint16_t value, float minimum, float extent)
+{
+    return minimum + extent * (value / RangeMaximum);
+}
+
+float AngleBetween(const glm::quat& a, const glm::quat& b)
+{
+    // acos of dot product can't resolve small angles in float; atan2 of |a - b| and |a + b| can.
+    // Quaternions of rotation angle t apart are t / 2 apart on the unit sphere, so |a - b| = 2sin(t / 4) and |a + b| = 2cos(t / 4).
+    const float Sign = glm::dot(a, b) < 0.0f ? -1.0f : 1.0f;
+    const glm::quat Difference = a - b * Sign;
+    const glm::quat Sum = a + b * Sign;
+    return 4.0f * std::atan2(glm::length(Difference), glm::length(Sum));
+}
@@ -0,0 +1,32 @@
+/*
+    Quantization.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    References :
+        https://gafferongames.com/post/snapshot_compression/
+
+    Dependencies :
+        glm - vector, quaternion representation
+
+    Helpers to store floating point data in fewer bits.
+*/
+#ifndef QUANTIZATION_H_
+#define QUANTIZATION_H_
+
+// Stores unit quaternion in 48 bits with 'smallest three' method.
+// The largest component is dropped and recovered from the other three, which then fit in [-1/sqrt(2), 1/sqrt(2)].
+// Each of the three takes 15 bits; index of the dropped component takes the top bit of out[0] and out[1].
+void QuantizeQuaternion(const glm::quat& q, uint16_t out[3]);
+
+glm::quat DequantizeQuaternion(const uint16_t in[3]);
+
+// Maps 'value' in [minimum, minimum + extent] to [0, 65535].
+uint16_t QuantizeRange(float value, float minimum, float extent);
+
+float DequantizeRange(uint16_t value, float minimum, float extent);
+
+// Angle in radians of rotation that takes 'a' to 'b'. Both must be unit quaternions.
+float AngleBetween(const glm::quat& a, const glm::quat& b);
+
+#endif
@@ -8,8 +8,6 @@
 
 const int MaximumPointLightCount = 5;
 const int MaximumSpotLightCount = 5;
-const int MaximumWeights = 3;
-const int MaximumBoneCount = 128;
 const int MaximumDirectionalLightCount = 5;
 
 in vec2 vUv; // varying uv
@@ -6,15 +6,15 @@
 
 const int MaximumPointLightCount = 5;
 const int MaximumSpotLightCount = 5;
-const int MaximumWeights = 3;
-const int MaximumBoneCount = 128;
+const int MaximumWeights = 4;
+const int MaximumBoneCount = MAXIMUM_BONE_COUNT; // defined by ShaderProgram preamble( Skeleton::MAXIMUM_BONE_COUNT )
 const int MaximumDirectionalLightCount = 5;
 
 layout (location = 0) in vec4 aPosition; 	// attribuet vertex position
 layout (location = 1) in vec2 aUv;			// attribute vertex uv
 layout (location = 2) in vec3 aNormal;		// attribute vertex normal
-layout (location = 3) in ivec3 aBones;		// attribute bone indices that affect the vertex
-layout (location = 4) in vec3 aWeights;		// attribute bone weights how much the bone affects the vertex
+layout (location = 3) in uvec4 aBones;		// attribute bone indices that affect the vertex. unsigned bytes
+layout (location = 4) in vec4 aWeights;		// attribute bone weights how much the bone affects the vertex. normalized unsigned bytes( or shorts ), sum to one
 layout (location = 5) in vec4 aTangent;		// attribuet vertex tangent
 
 struct LightInfo
@@ -48,12 +48,19 @@ uniform int uActiveDirectionalLightCount;
 uniform LightInfo uLights[MaximumPointLightCount]; // light information
 uniform SpotLightInfo uSpot; // spot light information
 uniform DirectionalLightInfo uDirectionalLights[MaximumDirectionalLightCount];
-uniform mat4 uJointTransforms[MaximumBoneCount]; // Bone pose transforms
+layout (std140, binding = JOINT_PALETTE_BINDING) uniform JointPalette
+{
+	vec4 uJointRows[MaximumBoneCount * 3]; // Bone pose transforms. top three rows per bone
+};
 uniform mat4 uMwMatrix; // model-world matrix
 uniform mat4 uMvMatrix; // modle-view matrix
 uniform mat3 uNormalMatrix; // model-view normal matrix
 uniform mat4 uVpMatrix; // view-projection matrix
 uniform bool uAnimationEnabled; // flag if animation is enabled
+uniform bool uBakedPaletteEnabled; // flag if bone pose transforms are read from uBakedPalette instead of JointPalette
+uniform samplerBuffer uBakedPalette; // baked bone pose transforms. three texels( top three rows ) per bone
+uniform int uBakedFrameOffsets[2]; // texel offset of the two baked frames to blend
+uniform float uBakedFrameBlend; // how far to blend from the first baked frame to the second
 uniform bool uNormalMapEnabled; // flag if normal amp is enabled
 
 out vec2 vUv; 			// varying uv
@@ -63,6 +70,35 @@ out vec3 vViewDir; // varying tangent view direction ( for light calculation in
 out vec3 vvNormal; // varying view-space vertex normal
 out vec4 vShadowCoord[MaximumDirectionalLightCount];
 
+// Builds affine matrix from its top three rows.
+mat4 RowsToMatrix(vec4 row0, vec4 row1, vec4 row2)
+{
+	return transpose(mat4(row0, row1, row2, vec4(0.0, 0.0, 0.0, 1.0)));
+}
+
+// Reads bone pose transform blended between the two baked frames.
+mat4 FetchBakedJointTransform(int bone)
+{
+	vec4 rows[3];
+	for( int i = 0; i < 3; ++i )
+	{
+		vec4 row0 = texelFetch(uBakedPalette, uBakedFrameOffsets[0] + bone * 3 + i);
+		vec4 row1 = texelFetch(uBakedPalette, uBakedFrameOffsets[1] + bone * 3 + i);
+		rows[i] = mix(row0, row1, uBakedFrameBlend);
+	}
+	return RowsToMatrix(rows[0], rows[1], rows[2]);
+}
+
+// Reads bone pose transform of the object being drawn.
+mat4 FetchJointTransform(int bone)
+{
+	if( uBakedPaletteEnabled )
+	{
+		return FetchBakedJointTransform(bone);
+	}
+	return RowsToMatrix(uJointRows[bone * 3], uJointRows[bone * 3 + 1], uJointRows[bone * 3 + 2]);
+}
+
 void main(void)
 {
 	////////// Apply Animation //////////
@@ -70,28 +106,31 @@ void main(void)
 	vec4 totalLocalPos = vec4(0.0);
 	// animation pose applied model space vertex normal
 	vec4 totalNormal = vec4(0.0);
+	// animation pose applied model space vertex tangent
+	vec4 totalTangent = vec4(0.0);
 
 	// apply animation. totalLocalPos will be weighted sum of affected bone transform multiplied by bind vertex position.
 	if( uAnimationEnabled )
 	{
+		// transforms are blended first, so that each attribute is transformed once
+		mat4 jointTransform = mat4(0.0);
 		for( int i = 0; i < MaximumWeights; ++i )
 		{
-			mat4 jointTransform = uJointTransforms[aBones[i]];
-			
-			// calculate position
-			vec4 posePosition = jointTransform * aPosition;
-			totalLocalPos += posePosition * aWeights[i];
-			
-			// calculate normal
-			vec4 worldNormal = jointTransform * vec4(aNormal, 0.0);
-			totalNormal += worldNormal * aWeights[i];
+			jointTransform += FetchJointTransform(int(aBones[i])) * aWeights[i];
 		}
+
+		totalLocalPos = jointTransform * aPosition;
+		totalNormal = jointTransform * vec4(aNormal, 0.0);
+		totalTangent = jointTransform * vec4(vec3(aTangent), 0.0);
+		// keep handedness of bitangent
+		totalTangent.w = aTangent.w;
 	}
 	// if animation is not enabled, just use attribute directly
 	else
 	{
 		totalLocalPos = aPosition;
 		totalNormal = vec4(aNormal, 0.0);
+		totalTangent = aTangent;
 	}
 
 	// view-spcae normal normalized
@@ -102,8 +141,8 @@ void main(void)
 
 	if( uNormalMapEnabled )
 	{
-		vec3 viewTangent = normalize(uNormalMatrix * vec3(aTangent));
-		vec3 viewBitangent = normalize(cross(viewNormal, viewTangent) * aTangent.w);
+		vec3 viewTangent = normalize(uNormalMatrix * vec3(totalTangent));
+		vec3 viewBitangent = normalize(cross(viewNormal, viewTangent) * totalTangent.w);
 
 		// View-Tangent normal matrix is tangent space matrix transpose.
 		mat3 vtMatrix = mat3
@@ -12,14 +12,76 @@
 #include "Scene.h"
 #include "Object.h"
 #include "Serialization.h"
+#include "JobSystem.h"
+#include "PoseCache.h"
+#include "AnimationLod.h"
+#include "SkinnedMesh.h"
+
+namespace
+{
+    // Number of objects updated by a single job
+    const int ObjectsPerJob = 8;
+    // Number of vertices skinned on CPU by a single job
+    const int VerticesPerSkinningJob = 4096;
+}
 
 void Scene::Init() {}
 
-void Scene::Update()
+void Scene::Update(float dt)
+{
+    PoseCache::Instance()->NextFrame();
+    AnimationLod::Instance()->Schedule(m_objects, m_updateOrder);
+
+    // Objects don't touch each other in Object::Update(), so they are updated in parallel.
+    // ParallelFor() returns after every object is updated, so rendering sees the same result as serial update.
+    // Ranges are taken in order, so objects AnimationLod put first are updated first.
+    JobSystem::Instance()->ParallelFor(GetSceneObjectCount(), ObjectsPerJob, [this, dt](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            m_objects[m_updateOrder[i]]->Update(dt);
+        }
+    });
+
+    // Palettes are final now. Meshes skinned on CPU are split by vertex range rather than by object,
+    // so a few heavy meshes still spread across workers.
+    BuildSkinningTasks();
+    JobSystem::Instance()->ParallelFor(static_cast<int>(m_skinningTasks.size()), 1, [this](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            const SkinningTask& Task = m_skinningTasks[i];
+            Task.pSkinnedMesh->Skin(Task.pPalette, Task.begin, Task.end);
+        }
+    });
+}
+
+void Scene::BuildSkinningTasks()
 {
-    for (std::shared_ptr<Object> pObject : m_objects)
+    m_skinningTasks.clear();
+    for (const std::shared_ptr<Object>& pObject : m_objects)
     {
-        pObject->Update();
+        const glm::mat4* pPalette = pObject->GetSkinningPalette();
+        const int64_t PaletteVersion = pObject->GetSkinningPaletteVersion();
+        for (int i = 0; i < pObject->GetSkinnedMeshCount(); ++i)
+        {
+            // Skipped, paused and baked animators leave the palette as it is; vertices skinned from it still hold.
+            SkinnedMesh& skinnedMesh = pObject->GetSkinnedMesh(i);
+            if (skinnedMesh.GetPaletteVersion() == PaletteVersion)
+                continue;
+
+            skinnedMesh.MarkDirty(PaletteVersion);
+            const int VertexCount = skinnedMesh.GetVertexCount();
+            for (int begin = 0; begin < VertexCount; begin += VerticesPerSkinningJob)
+            {
+                SkinningTask task;
+                task.pSkinnedMesh = &skinnedMesh;
+                task.pPalette = pPalette;
+                task.begin = begin;
+                task.end = std::min(begin + VerticesPerSkinningJob, VertexCount);
+                m_skinningTasks.push_back(task);
+            }
+        }
     }
 }
 
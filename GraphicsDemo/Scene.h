@@ -13,13 +13,15 @@
 #include "PerspectiveCamera.h"
 
 class Object;
+class SkinnedMesh;
 
 class Scene
 {
 public:
     virtual void Init();
 
-    virtual void Update();
+    // 'dt' is seconds passed since the last frame.
+    virtual void Update(float dt);
 
     virtual void Free();
 
@@ -55,6 +57,22 @@ protected:
     std::vector<PointLight> m_pointLights;
     std::vector<SpotLight> m_spotLights;
     std::vector<PerspectiveCamera> m_cameras;
+    // Order Update() updates m_objects in. Given by AnimationLod.
+    std::vector<int> m_updateOrder;
+
+    // Vertex range of a mesh skinned on CPU by a single job
+    struct SkinningTask
+    {
+        SkinnedMesh* pSkinnedMesh;
+        const glm::mat4* pPalette;
+        int begin;
+        int end;
+    };
+    // Rebuilt every Update(); kept to reuse its storage.
+    std::vector<SkinningTask> m_skinningTasks;
+
+    // Splits meshes of objects skinned on CPU into m_skinningTasks. Meshes already skinned with the current palette are left out.
+    void BuildSkinningTasks();
 };
 
 #endif
@@ -168,14 +168,12 @@ void SceneRenderer::RenderObject(PerspectiveCamera& camera, Object& object)
     for( int k = 0; k < object.GetMeshCount(); ++k )
     {
         std::shared_ptr<Mesh> mesh(object.GetMesh(k));
-        mesh->Apply();
+        object.ApplyMesh(k);
 
         for (int i = 0; i < mesh->GetSubMeshCount(); ++i)
         {
             SendMaterial(i < MaterialCount ? *object.GetMaterial(i) : Material::GetDefaultMaterial());
-            Mesh::SubMesh subMesh = mesh->GetSubMesh(i);
-            glDrawArrays(GL_TRIANGLES, subMesh.begin, subMesh.vertCount);
-            GET_AND_HANDLE_GL_ERROR();
+            mesh->DrawSubMesh(i);
         }
     }
 }
@@ -1,8 +1,7 @@
 #ifndef SERIALIZATION_H_
 #define SERIALIZATION_H_
 
-__declspec(align(32))
-struct RecordHeader
+struct alignas(32) RecordHeader
 {
     enum RecordType : int16_t
     {
@@ -36,7 +35,6 @@ public:
         os.write(reinterpret_cast<const char*>(&t), sizeof(T));
     }
 
-    template<>
     static void Write(std::ostream& os, const std::string& t)
     {
         int size = static_cast<int>(t.size());
@@ -50,7 +48,24 @@ public:
         is.read(reinterpret_cast<char*>(&t), sizeof(T));
     }
 
-    template <>
+    // Writes element count and raw bytes of 'v'. T must be trivially copyable.
+    template <typename T>
+    static void WriteVector(std::ostream& os, const std::vector<T>& v)
+    {
+        int size = static_cast<int>(v.size());
+        Write(os, size);
+        os.write(reinterpret_cast<const char*>(v.data()), size * sizeof(T));
+    }
+
+    template <typename T>
+    static void ReadVector(std::istream& is, std::vector<T>& v)
+    {
+        int size;
+        Read(is, size);
+        v.resize(size);
+        is.read(reinterpret_cast<char*>(v.data()), size * sizeof(T));
+    }
+
     static void Read(std::istream& is, std::string& t)
     {
         int size;
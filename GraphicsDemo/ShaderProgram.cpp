@@ -13,6 +13,13 @@
 #include "ShaderProgram.h"
 #include "Errors.h"
 
+std::string ShaderProgram::s_preamble;
+
+void ShaderProgram::SetPreamble(const std::string& preamble)
+{
+    s_preamble = preamble;
+}
+
 GLint ShaderProgram::GetUniformLocation(const char* name)
 {
     GLint location = glGetUniformLocation(m_program, name);
@@ -73,7 +80,27 @@ GLuint ShaderProgram::CompileShaderFromSource(GLenum type, const char* source)
     GLuint shader = glCreateShader(type);
     GET_AND_HANDLE_GL_ERROR();
 
-    glShaderSource(shader, 1, &source, 0);
+    // '#version' must come before anything else, so preamble goes right after that line.
+    const char* pVersion = s_preamble.empty() ? nullptr : std::strstr(source, "#version");
+    if (pVersion)
+    {
+        const char* pBody = std::strchr(pVersion, '\n');
+        pBody = pBody ? pBody + 1 : pVersion + std::strlen(pVersion);
+        int versionLine = 1;
+        for (const char* p = source; p < pBody; ++p)
+        {
+            versionLine += *p == '\n' ? 1 : 0;
+        }
+        // Keeps line numbers of compile errors pointing at the file.
+        const std::string Preamble = s_preamble + "\n#line " + std::to_string(versionLine) + "\n";
+        const char* Sources[] = { source, Preamble.c_str(), pBody };
+        const GLint Lengths[] = { static_cast<GLint>(pBody - source), -1, -1 };
+        glShaderSource(shader, 3, Sources, Lengths);
+    }
+    else
+    {
+        glShaderSource(shader, 1, &source, 0);
+    }
     GET_AND_HANDLE_GL_ERROR();
 
     glCompileShader(shader);
@@ -15,6 +15,10 @@
 class ShaderProgram
 {
 public:
+    // Sets text inserted right after '#version' line of every shader compiled afterwards.
+    // Used to share constants such as bone count limit between C++ and shaders.
+    static void SetPreamble(const std::string& preamble);
+
     bool Init(const std::string& name, const std::string& vertexShaderFilename, const std::string& fragmentShaderFilename);
 
     bool InitBySource(const char* name, const char* vertexShaderSource, const char* fragmentShaderSource);
@@ -93,6 +97,8 @@ public:
     GLuint Handle() { return m_program; }
 
 private:
+    static std::string s_preamble;
+
     std::string m_name;
 
     GLuint m_program;
@@ -7,6 +7,8 @@
 */
 #include "Common.h"
 #include "ShaderPrograms.h"
+#include "Skeleton.h"
+#include "Object.h"
 
 namespace
 {
@@ -19,6 +21,12 @@ namespace
 
 void ShaderPrograms::Init()
 {
+    // Limits shared with C++ code
+    std::stringstream preamble;
+    preamble << "#define MAXIMUM_BONE_COUNT " << Skeleton::MAXIMUM_BONE_COUNT << "\n"
+        << "#define JOINT_PALETTE_BINDING " << Object::JOINT_PALETTE_BINDING;
+    ShaderProgram::SetPreamble(preamble.str());
+
     s_position.Init("Position"
         , ResolveShaderFilename("basic.vert.glsl")
         , ResolveShaderFilename("position.frag.glsl"));
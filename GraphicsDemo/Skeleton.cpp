@@ -2,57 +2,135 @@
 #include "Skeleton.h"
 #include "Serialization.h"
 
+namespace
+{
+    // Distance from mesh space origin to bone of 'offsetMatrix' in bind pose.
+    // Inverse of offset matrix takes bone space to mesh space; its translation is where the bone is.
+    float GetBindPoseDistance(const glm::mat4& offsetMatrix)
+    {
+        return glm::length(glm::vec3(glm::inverse(offsetMatrix)[3]));
+    }
+}
+
 Skeleton::Skeleton()
+    : m_bindPoseRadius(0.0f)
 {
 }
 
-Bone & Skeleton::GetRootBone()
+const Bone & Skeleton::GetRootBone() const
 {
     return m_bones[0];
 }
 
 void Skeleton::AddBone(const Bone & bone)
 {
+    assert(bone.GetParent() < static_cast<int>(m_bones.size()));
     m_bones.push_back(bone);
+    m_parentIndices.push_back(bone.GetParent());
+    m_offsetMatrices.push_back(bone.GetInvLinkTransform() * bone.GetTransform());
+    m_boneDepths.push_back(bone.GetParent() != DUMMY_PARENT_NODE_INDEX ? m_boneDepths[bone.GetParent()] + 1 : 0);
+    m_boneIndices.insert(std::make_pair(bone.GetNameId(), static_cast<int>(m_bones.size()) - 1));
+    // Adding a bone can only make the radius larger
+    m_bindPoseRadius = std::max(m_bindPoseRadius, GetBindPoseDistance(m_offsetMatrices.back()));
 }
 
-Bone & Skeleton::GetBone(const char * name)
+const Bone & Skeleton::GetBone(const char * name) const
 {
-    return *std::find_if(m_bones.begin(), m_bones.end(), [name](const Bone& bone)
-    {
-        return bone.GetName() == name;
-    });
+    const int Index = FindBoneIndex(name);
+    assert(Index != DUMMY_PARENT_NODE_INDEX);
+    return m_bones[Index];
 }
 
-Bone & Skeleton::GetBoneByIndex(int index)
+const Bone & Skeleton::GetBoneByIndex(int index) const
 {
     return m_bones[index];
 }
 
-int Skeleton::GetBoneCount()
+void Skeleton::SetBoneBindTransforms(int index, const glm::mat4& transform, const glm::mat4& linkTransform)
+{
+    Bone& bone = m_bones[index];
+    bone.SetTransform(transform);
+    bone.SetLinkTransform(linkTransform);
+    const float OldDistance = GetBindPoseDistance(m_offsetMatrices[index]);
+    m_offsetMatrices[index] = bone.GetInvLinkTransform() * bone.GetTransform();
+    const float NewDistance = GetBindPoseDistance(m_offsetMatrices[index]);
+    // Importers set every bone, so the whole hierarchy is walked only when the farthest bone moves closer.
+    if (NewDistance >= m_bindPoseRadius)
+    {
+        m_bindPoseRadius = NewDistance;
+    }
+    else if (OldDistance >= m_bindPoseRadius)
+    {
+        UpdateBindPoseRadius();
+    }
+}
+
+int Skeleton::GetBoneCount() const
 {
     return static_cast<int>(m_bones.size());
 }
 
-int Skeleton::FindBoneIndex(const char * name)
+const int* Skeleton::GetParentIndices() const
+{
+    return m_parentIndices.data();
+}
+
+const glm::mat4* Skeleton::GetOffsetMatrices() const
+{
+    return m_offsetMatrices.data();
+}
+
+const int* Skeleton::GetBoneDepths() const
+{
+    return m_boneDepths.data();
+}
+
+void Skeleton::ComputeGlobalTransforms(const glm::mat4* pLocal, glm::mat4* pGlobal) const
+{
+    // Parents come before children, so transform of parent bone is already in pGlobal.
+    const int BoneCount = GetBoneCount();
+    for (int i = 0; i < BoneCount; ++i)
+    {
+        const int ParentIndex = m_parentIndices[i];
+        pGlobal[i] = ParentIndex != DUMMY_PARENT_NODE_INDEX ? pGlobal[ParentIndex] * pLocal[i] : pLocal[i];
+    }
+}
+
+void Skeleton::ComputePalette(const glm::mat4* pGlobal, glm::mat4* pPalette) const
 {
-    std::vector<Bone>::iterator iter = std::find_if(m_bones.begin(), m_bones.end(), [name](const Bone& bone)
+    const int BoneCount = GetBoneCount();
+    for (int i = 0; i < BoneCount; ++i)
     {
-        return bone.GetName() == name;
-    });
+        pPalette[i] = pGlobal[i] * m_offsetMatrices[i];
+    }
+}
+
+float Skeleton::GetBindPoseRadius() const
+{
+    return m_bindPoseRadius;
+}
 
-    if (iter != m_bones.end())
-        return static_cast<int>(iter - m_bones.begin());
-    else
+int Skeleton::FindBoneIndex(const char * name) const
+{
+    // Name that was never interned can't be a bone name
+    const NameId Id = NameTable::Instance()->Find(name);
+    if (Id == NameTable::INVALID_NAME_ID)
         return DUMMY_PARENT_NODE_INDEX;
+    return FindBoneIndex(Id);
 }
 
-int Skeleton::FindBoneIndex(const std::string & name)
+int Skeleton::FindBoneIndex(NameId nameId) const
+{
+    std::unordered_map<NameId, int>::const_iterator iter = m_boneIndices.find(nameId);
+    return iter != m_boneIndices.end() ? iter->second : DUMMY_PARENT_NODE_INDEX;
+}
+
+int Skeleton::FindBoneIndex(const std::string & name) const
 {
     return FindBoneIndex(name.c_str());
 }
 
-void Skeleton::Serialize(std::ostream& os)
+void Skeleton::Serialize(std::ostream& os) const
 {
     int boneCount = static_cast<int>(m_bones.size());
     Serialization::Write(os, boneCount);
@@ -64,18 +142,43 @@ void Skeleton::Serialize(std::ostream& os)
 
 void Skeleton::Deserialize(std::istream& is)
 {
-    int boneCount;
+    m_bones.clear();
+    m_parentIndices.clear();
+    m_offsetMatrices.clear();
+    m_boneDepths.clear();
+    m_boneIndices.clear();
+    m_bindPoseRadius = 0.0f;
+
+    int boneCount = 0;
     Serialization::Read(is, boneCount);
     m_bones.reserve(boneCount);
+    m_parentIndices.reserve(boneCount);
+    m_offsetMatrices.reserve(boneCount);
+    m_boneDepths.reserve(boneCount);
+    m_boneIndices.reserve(boneCount);
     for (int i = 0; i < boneCount; ++i)
     {
         Bone bone;
         bone.Deserialize(is);
-        m_bones.push_back(bone);
+        AddBone(bone);
     }
 }
 
 void Skeleton::CopyTo(Skeleton& dest)
 {
     dest.m_bones.assign(m_bones.begin(), m_bones.end());
+    dest.m_parentIndices.assign(m_parentIndices.begin(), m_parentIndices.end());
+    dest.m_offsetMatrices.assign(m_offsetMatrices.begin(), m_offsetMatrices.end());
+    dest.m_boneDepths.assign(m_boneDepths.begin(), m_boneDepths.end());
+    dest.m_bindPoseRadius = m_bindPoseRadius;
+    dest.m_boneIndices = m_boneIndices;
+}
+
+void Skeleton::UpdateBindPoseRadius()
+{
+    m_bindPoseRadius = 0.0f;
+    for (const glm::mat4& offsetMatrix : m_offsetMatrices)
+    {
+        m_bindPoseRadius = std::max(m_bindPoseRadius, GetBindPoseDistance(offsetMatrix));
+    }
 }
@@ -14,32 +14,73 @@
 
 #include "Bone.h"
 
+//
+// class Skeleton
+//
+// Bone hierarchy of a model. Besides the list of 'Bone's, Skeleton keeps a compiled form that is read every frame:
+// parent index per bone in topological order( parent always comes before its children ),
+// offset matrix per bone( InvLinkTransform * Transform ) which doesn't change after load,
+// and depth of each bone in the hierarchy.
+// Bones are found by name through a hash index of interned names( NameTable ), so lookups don't compare strings.
+// Bind pose of bones must be changed through Skeleton so that the compiled form stays valid.
+//
+// usage:
+//  skeleton.ComputeGlobalTransforms(local, global);
+//  skeleton.ComputePalette(global, palette);
+//
 class Skeleton
 {
 public:
     enum { DUMMY_PARENT_NODE_INDEX = -1 };
+    // Number of bones a skinned skeleton may have. Shaders get it as MAXIMUM_BONE_COUNT.
+    enum { MAXIMUM_BONE_COUNT = 128 };
 
     Skeleton();
     
     // The root bone is topmost bone that governs entire model.
     // Moving the root bone is like moving entire character by transation without morphing
     // It is common practice to place root bone at pelvis for human figure.
-    Bone& GetRootBone();
+    const Bone& GetRootBone() const;
 
-    // Adds bone. Parent bone must be specified by index( Bone::SetParent )
+    // Adds bone. Parent bone must be specified by index( Bone::SetParent ) and added before.
     void AddBone(const Bone& bone);
 
-    Bone& GetBone(const char* name);
+    const Bone& GetBone(const char* name) const;
 
-    Bone& GetBoneByIndex(int index);
+    const Bone& GetBoneByIndex(int index) const;
 
-    int GetBoneCount();
+    // Sets bind pose of 'index'th bone( Bone::SetTransform, Bone::SetLinkTransform ) and updates its offset matrix.
+    void SetBoneBindTransforms(int index, const glm::mat4& transform, const glm::mat4& linkTransform);
 
-    int FindBoneIndex(const char* name);
+    int GetBoneCount() const;
 
-    int FindBoneIndex(const std::string& name);
+    // Parent bone index per bone. DUMMY_PARENT_NODE_INDEX for root.
+    const int* GetParentIndices() const;
 
-    void Serialize(std::ostream& os);
+    // Matrix that takes a vertex from mesh space to bone space in bind pose, per bone.
+    const glm::mat4* GetOffsetMatrices() const;
+
+    // Number of ancestors per bone. 0 for root.
+    const int* GetBoneDepths() const;
+
+    // Propagates bone space transforms 'pLocal' down the hierarchy into mesh space transforms 'pGlobal'.
+    // Both are indexed by bone index and must hold GetBoneCount() matrices.
+    void ComputeGlobalTransforms(const glm::mat4* pLocal, glm::mat4* pGlobal) const;
+
+    // Multiplies mesh space transforms 'pGlobal' by offset matrices into skinning matrices 'pPalette'.
+    void ComputePalette(const glm::mat4* pGlobal, glm::mat4* pPalette) const;
+
+    // Distance from mesh space origin to the farthest bone in bind pose.
+    float GetBindPoseRadius() const;
+
+    int FindBoneIndex(const char* name) const;
+
+    int FindBoneIndex(const std::string& name) const;
+
+    // Index of bone named 'nameId'. DUMMY_PARENT_NODE_INDEX if there is none.
+    int FindBoneIndex(NameId nameId) const;
+
+    void Serialize(std::ostream& os) const;
 
     void Deserialize(std::istream& is);
 
@@ -47,9 +88,19 @@ public:
 
 private:
     // List of bones represent a Skeleton.
-    // Each bone not only contains the original location of the bone placed by designer ( Bind Pose )
-    // But also the mutated bone transform applied by 'Animator' object.
+    // Each bone contains the original location of the bone placed by designer ( Bind Pose ) and its name.
     std::vector<Bone> m_bones;
+
+    // Compiled form, indexed by bone index. Kept in sync with m_bones.
+    std::vector<int> m_parentIndices;
+    std::vector<glm::mat4> m_offsetMatrices;
+    std::vector<int> m_boneDepths;
+    float m_bindPoseRadius;
+
+    // Bone index by name. First bone wins if names repeat, as the linear search it replaces did.
+    std::unordered_map<NameId, int> m_boneIndices;
+
+    void UpdateBindPoseRadius();
 };
 
 #endif
@@ -0,0 +1,102 @@
+/*
+    SkinnedMesh.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    SkinnedMesh class implementation.
+*/
+#include "Common.h"
+#include "SkinnedMesh.h"
+#include "Mesh.h"
+
+SkinnedMesh::SkinnedMesh(std::shared_ptr<Mesh> pMesh, std::shared_ptr<const CpuSkinning::Source> pSource)
+    : m_pMesh(pMesh)
+    , m_pSource(pSource)
+    , m_output()
+    , m_position(3, GL_FLOAT, 0, 0)
+    , m_normal(3, GL_FLOAT, 0, 0)
+    , m_tangent(4, GL_FLOAT, 0, 0)
+    , m_dirty(true)
+    , m_paletteVersion(-1)
+{
+    assert(m_pMesh && m_pSource);
+    m_output.Resize(*m_pSource);
+    // Bind pose until the first Skin()
+    CpuSkinning::CopyBindPose(*m_pSource, 0, m_pSource->vertexCount, m_output);
+}
+
+std::shared_ptr<Mesh> SkinnedMesh::GetMesh()
+{
+    return m_pMesh;
+}
+
+int SkinnedMesh::GetVertexCount() const
+{
+    return m_pSource->vertexCount;
+}
+
+void SkinnedMesh::Skin(const glm::mat4* pPalette, int begin, int end)
+{
+    if (pPalette)
+    {
+        CpuSkinning::SkinRange(*m_pSource, pPalette, begin, end, m_output);
+    }
+    else
+    {
+        CpuSkinning::CopyBindPose(*m_pSource, begin, end, m_output);
+    }
+}
+
+void SkinnedMesh::MarkDirty(int64_t paletteVersion)
+{
+    m_dirty = true;
+    m_paletteVersion = paletteVersion;
+}
+
+int64_t SkinnedMesh::GetPaletteVersion() const
+{
+    return m_paletteVersion;
+}
+
+const CpuSkinning::Output& SkinnedMesh::GetOutput() const
+{
+    return m_output;
+}
+
+void SkinnedMesh::Apply()
+{
+    if (m_dirty)
+    {
+        // Whole buffer is respecified every frame so that driver doesn't wait for draws still reading the old contents.
+        m_position.Fill(m_output.positions.size() * sizeof(float), m_output.positions.data(), GL_STREAM_DRAW);
+        if (!m_output.normals.empty())
+        {
+            m_normal.Fill(m_output.normals.size() * sizeof(float), m_output.normals.data(), GL_STREAM_DRAW);
+        }
+        if (!m_output.tangents.empty())
+        {
+            m_tangent.Fill(m_output.tangents.size() * sizeof(float), m_output.tangents.data(), GL_STREAM_DRAW);
+        }
+        m_dirty = false;
+    }
+
+    // Binds every stream of the mesh, then replaces the skinned ones.
+    m_pMesh->Apply();
+    m_position.VertexAttribPointer(0, GL_FALSE);
+    if (!m_output.normals.empty())
+    {
+        m_normal.VertexAttribPointer(2, GL_FALSE);
+    }
+    if (!m_output.tangents.empty())
+    {
+        m_tangent.VertexAttribPointer(5, GL_FALSE);
+    }
+}
+
+void SkinnedMesh::Free()
+{
+    m_position.Free();
+    m_normal.Free();
+    m_tangent.Free();
+    m_dirty = true;
+}
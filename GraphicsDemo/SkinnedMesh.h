@@ -0,0 +1,73 @@
+/*
+    SkinnedMesh.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    SkinnedMesh class definition.
+*/
+#ifndef SKINNED_MESH_H_
+#define SKINNED_MESH_H_
+
+#include "AttributeArray.h"
+#include "CpuSkinning.h"
+
+class Mesh;
+
+//
+// class SkinnedMesh
+//
+// Per instance copy of a Mesh's position, normal and tangent streams, skinned on CPU.
+// Skin() may run on any thread and on disjoint vertex ranges at once. Apply() uploads the result to dynamic buffers
+// the first time it is called after skinning, so every pass drawing the instance in a frame reuses one upload.
+// Streams that aren't skinned( uv ) are bound from the shared Mesh.
+//
+// usage:
+//  SkinnedMesh skinnedMesh(pMesh, pMesh->GetSkinningSource());
+//  ...
+//  if (skinnedMesh.GetPaletteVersion() != paletteVersion) // every frame, after animator update
+//  {
+//      skinnedMesh.Skin(pPalette, 0, skinnedMesh.GetVertexCount());
+//      skinnedMesh.MarkDirty(paletteVersion);
+//  }
+//  ...
+//  skinnedMesh.Apply(); // instead of pMesh->Apply(), in every pass
+//
+class SkinnedMesh
+{
+public:
+    SkinnedMesh(std::shared_ptr<Mesh> pMesh, std::shared_ptr<const CpuSkinning::Source> pSource);
+
+    std::shared_ptr<Mesh> GetMesh();
+
+    int GetVertexCount() const;
+
+    // Skins vertices [begin, end) with 'pPalette'. Copies bind pose if 'pPalette' is nullptr.
+    void Skin(const glm::mat4* pPalette, int begin, int end);
+
+    // Makes the next Apply() upload skinned streams. Call once a frame when ranges are skinned, with version of the palette
+    // they are skinned with.
+    void MarkDirty(int64_t paletteVersion);
+
+    // Palette version given to the last MarkDirty(). -1 before the first.
+    int64_t GetPaletteVersion() const;
+
+    const CpuSkinning::Output& GetOutput() const;
+
+    // Binds skinned streams and the rest of mesh attributes. Must be called on the thread that owns GL context.
+    void Apply();
+
+    void Free();
+
+private:
+    std::shared_ptr<Mesh> m_pMesh;
+    std::shared_ptr<const CpuSkinning::Source> m_pSource;
+    CpuSkinning::Output m_output;
+    AttributeArray m_position;
+    AttributeArray m_normal;
+    AttributeArray m_tangent;
+    // Output changed since the last upload
+    bool m_dirty;
+    int64_t m_paletteVersion;
+};
+
+#endif
@@ -17,6 +17,9 @@ public:
 
     void AddComponent(SystemComponent* pComponent);
 
+    // Ends Run() after the current frame.
+    void SetQuitFlag();
+
     template< typename T>
     void GetComponent(T*& pOut)
     {
@@ -38,8 +41,6 @@ private:
 
     static LRESULT CALLBACK WndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 
-    void SetQuitFlag();
-
     void Render();
 
     bool Init();
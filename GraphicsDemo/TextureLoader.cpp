@@ -0,0 +1,185 @@
+/*
+    TextureLoader.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    TextureLoader class implementation.
+*/
+#include "Common.h"
+#include "TextureLoader.h"
+#include "JobSystem.h"
+#include "Errors.h"
+#include "stb_image.h"
+
+namespace
+{
+    typedef std::chrono::high_resolution_clock Clock;
+
+    float MillisecondsSince(Clock::time_point start)
+    {
+        const std::chrono::duration<float, std::milli> Elapsed = Clock::now() - start;
+        return Elapsed.count();
+    }
+
+    void FlipRows(unsigned char* pPixels, size_t rowSize, int rowCount)
+    {
+        std::vector<unsigned char> row(rowSize);
+        for (int top = 0, bottom = rowCount - 1; top < bottom; ++top, --bottom)
+        {
+            unsigned char* pTop = pPixels + top * rowSize;
+            unsigned char* pBottom = pPixels + bottom * rowSize;
+            std::memcpy(row.data(), pTop, rowSize);
+            std::memcpy(pTop, pBottom, rowSize);
+            std::memcpy(pBottom, row.data(), rowSize);
+        }
+    }
+}
+
+void TextureLoader::PixelsDeleter::operator()(unsigned char* pPixels) const
+{
+    stbi_image_free(pPixels);
+}
+
+int TextureLoader::Add(const std::vector<std::string>& candidateFilenames, bool flipVertically)
+{
+    assert(!candidateFilenames.empty());
+    Request request;
+    request.candidateFilenames = candidateFilenames;
+    request.flipVertically = flipVertically;
+    m_requests.push_back(request);
+    return static_cast<int>(m_requests.size()) - 1;
+}
+
+void TextureLoader::Load(const UploadFunction& upload)
+{
+    const Clock::time_point Start = Clock::now();
+    const std::thread::id LoadingThread = std::this_thread::get_id();
+    const int RequestCount = static_cast<int>(m_requests.size());
+    float decodeMilliseconds = 0.0f;
+    float uploadMilliseconds = 0.0f;
+
+    stbi_set_flip_vertically_on_load(false);
+
+    // One image per range, so a worker that finishes a small image takes the next one instead of waiting.
+    JobSystem::Instance()->ParallelFor(RequestCount, 1, [&](int begin, int end)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            Image image;
+            Decode(m_requests[i], image);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_decodedImages.push_back(std::make_pair(i, std::move(image)));
+        }
+
+        if (std::this_thread::get_id() == LoadingThread)
+        {
+            UploadDecodedImages(upload, decodeMilliseconds, uploadMilliseconds);
+        }
+    });
+    UploadDecodedImages(upload, decodeMilliseconds, uploadMilliseconds);
+
+    // Decode time is summed over all threads, so it exceeds the total when decoding ran in parallel.
+    std::cout << "Textures : " << RequestCount << " in " << MillisecondsSince(Start) << " ms, decode " << decodeMilliseconds
+        << " ms over " << JobSystem::Instance()->GetWorkerCount() + 1 << " threads, upload " << uploadMilliseconds << " ms" << std::endl;
+
+    m_requests.clear();
+}
+
+GLuint TextureLoader::CreateTexture2D(const Image& image)
+{
+    if (!image.pixels)
+        return 0;
+
+    GLenum format;
+    // RGB
+    if (image.channelCount == 3)
+    {
+        format = GL_RGB;
+    }
+    // RGBA
+    else if (image.channelCount == 4)
+    {
+        format = GL_RGBA;
+    }
+    else
+    {
+        // GRAY -> channel count == 1
+        // GRAY ALPHA -> channel count == 2
+        std::cout << "Not supported" << std::endl;
+        return 0;
+    }
+
+    GLuint textureObject;
+    glGenTextures(1, &textureObject);
+    GET_AND_HANDLE_GL_ERROR();
+    glBindTexture(GL_TEXTURE_2D, textureObject);
+    GET_AND_HANDLE_GL_ERROR();
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    GET_AND_HANDLE_GL_ERROR();
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    GET_AND_HANDLE_GL_ERROR();
+    glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels.get());
+    GET_AND_HANDLE_GL_ERROR();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    GET_AND_HANDLE_GL_ERROR();
+
+    return textureObject;
+}
+
+void TextureLoader::Decode(const Request& request, Image& image)
+{
+    const Clock::time_point Start = Clock::now();
+    image.width = 0;
+    image.height = 0;
+    image.channelCount = 0;
+
+    for (const std::string& filename : request.candidateFilenames)
+    {
+        stbi_uc* pData = stbi_load(filename.c_str(), &image.width, &image.height, &image.channelCount, 0);
+        if (!pData)
+            continue;
+
+        image.filename = filename;
+        image.pixels.reset(pData);
+        if (request.flipVertically)
+        {
+            // OpenGL Texture pixel data must start from bottom-left whereas actual file data usually has data starting from top-left
+            FlipRows(pData, static_cast<size_t>(image.width) * image.channelCount, image.height);
+        }
+        break;
+    }
+
+    image.decodeMilliseconds = MillisecondsSince(Start);
+}
+
+void TextureLoader::UploadDecodedImages(const UploadFunction& upload, float& decodeMilliseconds, float& uploadMilliseconds)
+{
+    for (;;)
+    {
+        std::pair<int, Image> decoded;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_decodedImages.empty())
+                break;
+            decoded = std::move(m_decodedImages.front());
+            m_decodedImages.pop_front();
+        }
+
+        const Image& image = decoded.second;
+        const Clock::time_point Start = Clock::now();
+        upload(decoded.first, image);
+        const float Milliseconds = MillisecondsSince(Start);
+        decodeMilliseconds += image.decodeMilliseconds;
+        uploadMilliseconds += Milliseconds;
+
+        if (!image.pixels)
+        {
+            std::cout << " Texture '" << m_requests[decoded.first].candidateFilenames.front() << "' : not decoded, tried "
+                << image.decodeMilliseconds << " ms" << std::endl;
+            continue;
+        }
+        std::cout << " Texture '" << image.filename << "' " << image.width << "x" << image.height << "x" << image.channelCount
+            << " : decode " << image.decodeMilliseconds << " ms, upload " << Milliseconds << " ms" << std::endl;
+    }
+}
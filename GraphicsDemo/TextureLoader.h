@@ -0,0 +1,89 @@
+/*
+    TextureLoader.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    Dependencies:
+        stb_image.h - for texture file decoding
+
+    TextureLoader class definition.
+*/
+#ifndef TEXTURE_LOADER_H_
+#define TEXTURE_LOADER_H_
+
+//
+// class TextureLoader
+//
+// Decodes batches of image files on JobSystem workers into staging buffers and hands each finished image
+// to the thread that called Load()( which owns GL context ) through a queue, so textures are uploaded while
+// the rest of the batch is still being decoded. The loading thread decodes too, and uploads what is queued
+// between its own images.
+// Decode and upload time of every image is logged.
+//
+// stb_image's vertical flip setting is global, so images are always decoded unflipped and flipped in the buffer stb_image
+// returned, which the Image keeps until it is uploaded.
+//
+// usage:
+//  TextureLoader loader;
+//  loader.Add({ "Diffuse.png" }, true);
+//  loader.Add({ "Normal.png", "./Textures/Normal.png" }, true);
+//  loader.Load([&](int request, const TextureLoader::Image& image)
+//  {
+//      textures[request] = TextureLoader::CreateTexture2D(image);
+//  });
+//
+class TextureLoader
+{
+public:
+    // Frees pixels with stbi_image_free().
+    struct PixelsDeleter
+    {
+        void operator()(unsigned char* pPixels) const;
+    };
+
+    struct Image
+    {
+        // Candidate that was decoded. Empty if none could be.
+        std::string filename;
+        int width;
+        int height;
+        int channelCount;
+        // Rows of 'width * channelCount' bytes, bottom row first if flipped. Null if not decoded.
+        std::unique_ptr<unsigned char[], PixelsDeleter> pixels;
+        float decodeMilliseconds;
+    };
+
+    // Called on the loading thread for every request, in order decoding finishes. Failed images have no pixels.
+    typedef std::function<void(int request, const Image& image)> UploadFunction;
+
+    // Adds an image to the next Load(). 'candidateFilenames' are tried in order until one decodes.
+    // Returns index of the request, which is passed to UploadFunction.
+    int Add(const std::vector<std::string>& candidateFilenames, bool flipVertically);
+
+    // Decodes images added since last Load() and calls 'upload' for each of them. Returns once all are uploaded.
+    // Must not be called from inside a JobSystem job.
+    void Load(const UploadFunction& upload);
+
+    // Transfers 'image' into a new GL_TEXTURE_2D of linear filtering. 0 if the image has no pixels or unsupported channels.
+    static GLuint CreateTexture2D(const Image& image);
+
+private:
+    struct Request
+    {
+        std::vector<std::string> candidateFilenames;
+        bool flipVertically;
+    };
+
+    std::vector<Request> m_requests;
+
+    // Decoded images waiting for upload
+    std::mutex m_mutex;
+    std::deque<std::pair<int, Image>> m_decodedImages;
+
+    static void Decode(const Request& request, Image& image);
+
+    // Uploads images queued so far, adding their decode and upload time to 'decodeMilliseconds' and 'uploadMilliseconds'.
+    void UploadDecodedImages(const UploadFunction& upload, float& decodeMilliseconds, float& uploadMilliseconds);
+};
+
+#endif
@@ -0,0 +1,110 @@
+/*
+    VertexWelder.cpp
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    References :
+        http://www.isthe.com/chongo/tech/comp/fnv/index.html
+
+    VertexWelder class implementation.
+*/
+#include "Common.h"
+#include "VertexWelder.h"
+
+namespace
+{
+    // 64 bit FNV-1a
+    void HashBytes(uint64_t& hash, const void* pData, size_t size)
+    {
+        const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= pBytes[i];
+            hash *= 1099511628211ull;
+        }
+    }
+}
+
+VertexWelder::VertexWelder(int componentCount, float epsilon)
+    : m_componentCount(componentCount)
+    , m_epsilon(epsilon)
+    , m_components()
+    , m_keys()
+    , m_indicesByHash()
+{
+    assert(componentCount > 0);
+}
+
+void VertexWelder::Reserve(int vertexCount)
+{
+    m_components.reserve(static_cast<size_t>(vertexCount) * m_componentCount);
+    m_keys.reserve(vertexCount);
+    if (m_epsilon >= 0.0f)
+    {
+        m_indicesByHash.reserve(vertexCount);
+    }
+}
+
+uint32_t VertexWelder::Add(const float* pComponents, int key)
+{
+    uint64_t hash = 0;
+    if (m_epsilon >= 0.0f)
+    {
+        hash = Hash(pComponents, key);
+        const auto Range = m_indicesByHash.equal_range(hash);
+        for (auto it = Range.first; it != Range.second; ++it)
+        {
+            if (IsEqual(it->second, pComponents, key))
+                return it->second;
+        }
+    }
+
+    const uint32_t Index = static_cast<uint32_t>(m_keys.size());
+    m_components.insert(m_components.end(), pComponents, pComponents + m_componentCount);
+    m_keys.push_back(key);
+    if (m_epsilon >= 0.0f)
+    {
+        m_indicesByHash.emplace(hash, Index);
+    }
+    return Index;
+}
+
+int VertexWelder::GetVertexCount() const
+{
+    return static_cast<int>(m_keys.size());
+}
+
+uint64_t VertexWelder::Hash(const float* pComponents, int key) const
+{
+    uint64_t hash = 14695981039346656037ull;
+    HashBytes(hash, &key, sizeof(key));
+    for (int i = 0; i < m_componentCount; ++i)
+    {
+        // Snapped to a cell of epsilon; exact values hash by bits, with -0 and 0 alike.
+        const float Component = pComponents[i] == 0.0f ? 0.0f : pComponents[i];
+        if (m_epsilon > 0.0f)
+        {
+            const int64_t Cell = static_cast<int64_t>(std::floor(Component / m_epsilon + 0.5f));
+            HashBytes(hash, &Cell, sizeof(Cell));
+        }
+        else
+        {
+            HashBytes(hash, &Component, sizeof(Component));
+        }
+    }
+    return hash;
+}
+
+bool VertexWelder::IsEqual(uint32_t index, const float* pComponents, int key) const
+{
+    if (m_keys[index] != key)
+        return false;
+
+    const float* pVertex = &m_components[static_cast<size_t>(index) * m_componentCount];
+    for (int i = 0; i < m_componentCount; ++i)
+    {
+        if (std::abs(pVertex[i] - pComponents[i]) > m_epsilon)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,57 @@
+/*
+    VertexWelder.h
+
+    Author : Lee Kyunggeun(kyunggeun1992@gmail.com)
+
+    References :
+        http://www.isthe.com/chongo/tech/comp/fnv/index.html
+
+    VertexWelder class definition.
+*/
+#ifndef VERTEX_WELDER_H_
+#define VERTEX_WELDER_H_
+
+//
+// class VertexWelder
+//
+// Turns a stream of vertices( triangle corners ) into unique vertices plus indices.
+// A vertex is a fixed number of float components( position, normal, uv, ... ) and an integer key for what floats don't
+// capture, such as the control point that decides bone influences. Vertices weld if their keys are equal and every component
+// is within epsilon. Vertices are found by hash of components snapped to epsilon, so two vertices within epsilon that
+// snap to different cells stay apart; that only costs a duplicate vertex.
+//
+// usage:
+//  VertexWelder welder(8, 1e-5f);
+//  for each corner
+//      const int VertexCount = welder.GetVertexCount();
+//      indices.push_back(welder.Add(components, controlPointIndex));
+//      if (indices.back() == VertexCount)
+//          append components to vertex streams
+//
+class VertexWelder
+{
+public:
+    // Negative 'epsilon' turns welding off; every vertex added is new.
+    VertexWelder(int componentCount, float epsilon);
+
+    void Reserve(int vertexCount);
+
+    // Returns index of the vertex 'pComponents' welds to, adding it as a new vertex if there is none.
+    uint32_t Add(const float* pComponents, int key);
+
+    int GetVertexCount() const;
+
+private:
+    int m_componentCount;
+    float m_epsilon;
+    std::vector<float> m_components;
+    std::vector<int> m_keys;
+    // Vertex indices by hash of their snapped components and key
+    std::unordered_multimap<uint64_t, uint32_t> m_indicesByHash;
+
+    uint64_t Hash(const float* pComponents, int key) const;
+
+    bool IsEqual(uint32_t index, const float* pComponents, int key) const;
+};
+
+#endif
@@ -12,10 +12,13 @@
      - (Release mode) Redirect stdout, stderr to the file "log.txt".
                       log file will be generated next to exe file
      - Initialize 'System' class and its SystemComponents.
+     - With "-cook [-force] <fbx file>..." arguments, cooks the given files( AssetCooker ) and exits instead.
+       Exit code is the number of files that failed to cook.
 */
 #include "Common.h"
 #include "System.h"
 #include "GraphicsDemo.h"
+#include "AssetCooker.h"
 
 void AllocateDebugConsole();
 void BindCrtHandlesToStdHandles(bool, bool, bool);
@@ -42,6 +45,42 @@ namespace
         std::cout.rdbuf(os.rdbuf());
         std::cerr.rdbuf(os.rdbuf());
     }
+
+    // Splits command line on spaces. Double quoted arguments may contain spaces.
+    std::vector<std::string> SplitArguments(const char* args)
+    {
+        std::vector<std::string> arguments;
+        std::string argument;
+        bool quoted = false;
+        bool started = false;
+        for (const char* p = args; *p; ++p)
+        {
+            if (*p == '"')
+            {
+                quoted = !quoted;
+                started = true;
+            }
+            else if (*p == ' ' && !quoted)
+            {
+                if (started)
+                {
+                    arguments.push_back(argument);
+                }
+                argument.clear();
+                started = false;
+            }
+            else
+            {
+                argument += *p;
+                started = true;
+            }
+        }
+        if (started)
+        {
+            arguments.push_back(argument);
+        }
+        return arguments;
+    }
 }
 
 
@@ -67,6 +106,22 @@ INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE hPrev, LPSTR args, int nCmdShow)
 
     System* system = System::Instance();
 
+    std::vector<std::string> arguments = SplitArguments(args);
+    if (!arguments.empty() && arguments[0] == "-cook")
+    {
+        arguments.erase(arguments.begin());
+        const bool Force = !arguments.empty() && arguments[0] == "-force";
+        if (Force)
+        {
+            arguments.erase(arguments.begin());
+        }
+
+        int failureCount = 0;
+        system->AddComponent(new AssetCooker(arguments, Force, failureCount));
+        system->Run();
+        return failureCount;
+    }
+
     system->AddComponent(new GraphicsDemo());
 
     system->Run();
@@ -1,2 +1,4 @@
 #define STB_IMAGE_IMPLEMENTATION
+// Failure reason is a global without synchronization, and TextureLoader decodes on several threads at once.
+#define STBI_NO_FAILURE_STRINGS
 #include "stb_image.h"